@@ -18,8 +18,8 @@ int MrManager::init(EngineSetup const & setup) {
     camera->init(windowSize);
     editor.init();
 
-    workers = memMan.createArray<Worker *>(64);
-    workerGroups = memMan.createArray<WorkerGroup>(16);
+    jobs.init(setup.workerThreadCount, setup.jobCapacity);
+    io.init(setup.ioThreadCount, setup.ioCapacity);
 
     #if DEV_INTERFACE
     setDevState(DEV_STATE_INTERFACE);
@@ -94,10 +94,11 @@ int MrManager::init(EngineSetup const & setup) {
 
 void MrManager::shutdown() {
     if (setup.preShutdown) setup.preShutdown();
+    jobs.shutdown();
+    // after jobs, which may be waiting on reads
+    io.shutdown();
     rendSys.shutdown();
     camera->shutdown();
-    memMan.request({.ptr=workers, .size=0});
-    memMan.request({.ptr=workerGroups, .size=0});
     if (setup.postShutdown) setup.postShutdown();
 }
 
@@ -111,6 +112,7 @@ void MrManager::beginFrame(double nowInSeconds) {
     dt = thisTime - prevTime;
     bgfx::dbgTextPrintf(0, 0, 0x0f, "DT:  %5.1fms", dt * 1000.0);
     bgfx::dbgTextPrintf(0, 1, 0x0e, "FPS: %5.1fms", 1.0 / dt);
+    bgfx::dbgTextPrintf(0, 2, 0x0f, "Draw: %5u, culled %5u, materials %4u", rendSys.stats.submitted, rendSys.stats.culled, rendSys.stats.materialChanges);
 }
 
 void MrManager::endFrame() {
@@ -147,92 +149,45 @@ void MrManager::updateSize(size2 windowSize) {
 // -------------------------------------------------------------------------- //
 // WORKERS
 // -------------------------------------------------------------------------- //
-    Worker * MrManager::createWorker(Worker::Fn const & task, void * group) {
-        Worker * w = memMan.create<Worker>();
-        w->init(task, group);
-        workers->append(w);
-
-        if (group) {
-            size_t size = workerGroups->size();
-            size_t i = 0;
-            for (; i < size; ++i) {
-                if (workerGroups->data()[i].id == group) break;
-            }
-            // not found, create
-            if (i == size) {
-                workerGroups->append({group, 1, nullptr});
-            }
-            // found, increment
-            else {
-                ++workerGroups->data()[i].count;
-            }
-        }
-
-        return w;
+    JobHandle MrManager::createWorker(JobSystem::Fn const & task, JobCounter * group) {
+        return jobs.run(task, group);
     }
 
-    void MrManager::setWorkerGroupOnComplete(void * group, Worker::Fn const & onComplete) {
-        size_t size = workerGroups->size();
-        size_t i = 0;
-        for (; i < size; ++i) {
-            if (workerGroups->data()[i].id == group) break;
-        }
-        // not found, create
-        if (i == size) {
-            workerGroups->append({group, 0, onComplete});
-        }
-        // found, replace
-        else {
-            workerGroups->data()[i].onComplete = onComplete;
-        }
+    JobCounter * MrManager::createWorkerGroup() {
+        return jobs.createGroup();
     }
 
-    uint16_t MrManager::numberOfWorkersInGroup(void * group) const {
-        if (workerGroups->size() == 0) {
-            return 0;
-        }
-        WorkerGroup const * wg = workerGroups->find([group](WorkerGroup const & a){
-            return (a.id == group);
-        });
-        if (wg == nullptr) {
-            return 0;
-        }
-        return wg->count;
+    void MrManager::setWorkerGroupOnComplete(JobCounter * group, JobSystem::Fn const & onComplete) {
+        jobs.closeGroup(group, onComplete);
     }
 
     void MrManager::joinWorkers() {
-        size_t size = workers->size();
-        for (size_t i = 0; i < size; ++i) {
-            Worker * w = workers->data()[i];
-            if (w->isComplete()) {
-                w->join();
-
-                if (w->group()) {
-                    size_t size = workerGroups->size();
-                    size_t i = 0;
-                    for (; i < size; ++i) {
-                        if (workerGroups->data()[i].id == w->group()) break;
-                    }
-                    // found, decrement
-                    if (i != size) {
-                        WorkerGroup * wg = workerGroups->data() + i;
-                        --wg->count;
-                        if (wg->count == 0) {
-                            if (wg->onComplete) {
-                                wg->onComplete();
-                            }
-                            workerGroups->remove(i);
-                        }
-                    }
-                }
-
-                w->shutdown();
-                memMan.request({.ptr=w, .size=0});
-                workers->remove(i);
-                --i;
-                --size;
-            }
+        jobs.runCompletedGroups();
+    }
+
+    void MrManager::parallelFor(uint32_t begin, uint32_t end, uint32_t grain, JobSystem::RangeFn const & fn) {
+        jobs.parallelFor(begin, end, grain, fn);
+    }
+
+    void MrManager::runTaskGraph(TaskGraph & graph) {
+        graph.run(jobs);
+    }
+
+    void MrManager::loadGobjs(char const * const * gltfPaths, uint16_t nPaths, GobjBatchFn const & onComplete) {
+        Gobj ** gobjs = (nPaths) ? (Gobj **)memMan.request({.size = sizeof(Gobj *) * nPaths}) : nullptr;
+        if (nPaths && gobjs == nullptr) {
+            fprintf(stderr, "Error creating Gobj batch of %u\n", nPaths);
+            return;
         }
+
+        JobCounter * group = createWorkerGroup();
+        createWorker([this, gltfPaths, nPaths, gobjs]{
+            memMan.createGobjs(gltfPaths, nPaths, gobjs, jobs);
+        }, group);
+        setWorkerGroupOnComplete(group, [this, nPaths, gobjs, onComplete]{
+            onComplete(gobjs, nPaths);
+            if (gobjs) memMan.request({.ptr = gobjs});
+        });
     }
 
 // -------------------------------------------------------------------------- //
@@ -265,6 +220,7 @@ char * MrManager::frameFormatStr(char const * format, ...) {
     va_start(args, format);
     char * str = frameStack->vformatStr(format, args);
     va_end(args);
+    assert(str && "Could not format temp string.");
     return str;
 }
 
@@ -8,7 +8,9 @@
 #include "render/Camera.h"
 #include "render/CameraControl.h"
 #include "render/RenderSystem.h"
-#include "worker/Worker.h"
+#include "worker/FileIO.h"
+#include "worker/JobSystem.h"
+#include "worker/TaskGraph.h"
 
 #if DEV_INTERFACE
 #include "dev/Editor.h"
@@ -43,8 +45,8 @@ public:
     FrameStack * frameStack = nullptr; // TODO: consider moving this into MemMan
     RenderSystem rendSys;
 
-    Array<Worker *> * workers = nullptr;
-    Array<WorkerGroup> * workerGroups = nullptr;
+    JobSystem jobs;
+    FileIO io;
 
     bool mouseIsDown = false;
     glm::vec2 mousePos;
@@ -84,16 +86,29 @@ public:
 // -------------------------------------------------------------------------- //
 // WORKERS
 // -------------------------------------------------------------------------- //
-    Worker * createWorker(Worker::Fn const & task, void * group = nullptr);
-    void setWorkerGroupOnComplete(void * group, Worker::Fn const & onComplete);
+    // run task on a pool thread. group (optional) from createWorkerGroup.
+    JobHandle createWorker(JobSystem::Fn const & task, JobCounter * group = nullptr);
+    JobCounter * createWorkerGroup();
+    // call once all workers are added to group. onComplete runs on main thread
+    // after the last one finishes, even if group was empty.
+    void setWorkerGroupOnComplete(JobCounter * group, JobSystem::Fn const & onComplete);
     void joinWorkers();
-    uint16_t numberOfWorkersInGroup(void * group) const;
+    // split [begin, end) into chunks of grain across workers. blocks.
+    void parallelFor(uint32_t begin, uint32_t end, uint32_t grain, JobSystem::RangeFn const & fn);
+    // run all tasks in dependency order across workers. blocks.
+    void runTaskGraph(TaskGraph & graph);
+    // load gltfPaths as one batch across workers (MemMan::createGobjs).
+    // onComplete runs on main thread once all are done, with gobjs[i] nullptr
+    // if gltfPaths[i] failed. gltfPaths must stay valid until then.
+    using GobjBatchFn = std::function<void(Gobj ** gobjs, uint16_t nGobjs)>;
+    void loadGobjs(char const * const * gltfPaths, uint16_t nPaths, GobjBatchFn const & onComplete);
 
 // -------------------------------------------------------------------------- //
 // FRAME STACK UTILS
 // -------------------------------------------------------------------------- //
     char * frameStr(size_t size);
     char * frameByteSizeStr(size_t byteSize);
+    // nullptr if the frame stack is full (asserts in DEBUG)
     char * frameFormatStr(char const * format, ...);
 
 // -------------------------------------------------------------------------- //
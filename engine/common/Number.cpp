@@ -0,0 +1,210 @@
+#include "Number.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include "number_pow5_data.h"
+
+// -------------------------------------------------------------------------- //
+// FALLBACKS
+// -------------------------------------------------------------------------- //
+
+// the strto* functions stop at the first non-number char, so str doesn't
+// need terminating. valid if they stopped exactly at length.
+
+static bool strtoUint(char const * str, uint32_t length, uint64_t * value) {
+    char * end = nullptr;
+    errno = 0;
+    *value = strtoull(str, &end, 10);
+    return (errno == 0 && str + length == end);
+}
+
+static bool strtoInt(char const * str, uint32_t length, int64_t * value) {
+    char * end = nullptr;
+    errno = 0;
+    *value = strtoll(str, &end, 10);
+    return (errno == 0 && str + length == end);
+}
+
+static bool strtoDouble(char const * str, uint32_t length, double * value) {
+    char * end = nullptr;
+    errno = 0;
+    *value = strtod(str, &end);
+    // ERANGE on underflow too, but subnormal/zero result is still the nearest
+    return ((errno == 0 || !isinf(*value)) && str + length == end);
+}
+
+// -------------------------------------------------------------------------- //
+// INTEGERS
+// -------------------------------------------------------------------------- //
+
+// up to 19 digits can't overflow uint64_t
+static constexpr uint32_t MaxFastDigits = 19;
+
+bool Number::parseUint(char const * str, uint32_t length, uint64_t * value) {
+    if (length == 0) {
+        *value = 0;
+        return false;
+    }
+    if (length > MaxFastDigits) {
+        return strtoUint(str, length, value);
+    }
+    uint64_t v = 0;
+    for (uint32_t i = 0; i < length; ++i) {
+        uint32_t digit = (uint32_t)(str[i] - '0');
+        if (digit > 9) {
+            // sign, decimal point, exponent. rare for something cast to uint.
+            return strtoUint(str, length, value);
+        }
+        v = v * 10 + digit;
+    }
+    *value = v;
+    return true;
+}
+
+bool Number::parseInt(char const * str, uint32_t length, int64_t * value) {
+    if (length == 0) {
+        *value = 0;
+        return false;
+    }
+    bool negative = (str[0] == '-');
+    uint64_t magnitude;
+    if (!parseUint(str + negative, length - negative, &magnitude) ||
+        length - negative == 0 ||
+        magnitude > (uint64_t)INT64_MAX + negative
+    ) {
+        return strtoInt(str, length, value);
+    }
+    *value = (negative) ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    return true;
+}
+
+// -------------------------------------------------------------------------- //
+// FLOATING POINT
+// -------------------------------------------------------------------------- //
+
+// exactly representable powers of 10
+static constexpr double ExactPow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/*
+Eisel-Lemire. w * 10^q to nearest double, from a 128-bit approximation of
+w * 5^q. Exact, or returns false if it can't tell (then use strtod). Doesn't
+handle subnormals or overflow, also left to strtod.
+See Lemire, "Number Parsing at a Gigabyte per Second" (2021).
+*/
+static bool eiselLemire(uint64_t w, int q, double * value) {
+    if (q < Pow5Min || q > Pow5Max) {
+        return false;
+    }
+
+    // normalize w so its top bit is set
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+
+    // high 128 bits of w * 5^q. only need the lower half of the table entry if
+    // bits below the 55 that matter are all set, and might carry.
+    uint32_t index = 2 * (uint32_t)(q - Pow5Min);
+    unsigned __int128 product = (unsigned __int128)w * Pow5_128[index];
+    uint64_t hi = (uint64_t)(product >> 64);
+    uint64_t lo = (uint64_t)product;
+    if ((hi & 0x1FF) == 0x1FF) {
+        uint64_t secondHi = (uint64_t)(((unsigned __int128)w * Pow5_128[index + 1]) >> 64);
+        lo += secondHi;
+        if (secondHi > lo) {
+            ++hi;
+        }
+        if (lo == UINT64_MAX && (q < -27 || q > 55)) {
+            return false;
+        }
+    }
+
+    // 54 bits of mantissa (one extra for rounding)
+    int upperBit = (int)(hi >> 63);
+    int shift = upperBit + 9;
+    uint64_t mantissa = hi >> shift;
+    // floor(q * log2(10)) + 63, plus bias
+    int power2 = (((217706 * q) >> 16) + 63) + upperBit - lz + 1023;
+    if (power2 <= 0) {
+        return false;
+    }
+
+    // exactly halfway, round to even
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+        (mantissa << shift) == hi
+    ) {
+        mantissa &= ~(uint64_t)1;
+    }
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if (mantissa >= ((uint64_t)2 << 52)) {
+        mantissa = (uint64_t)1 << 52;
+        ++power2;
+    }
+    mantissa &= ~((uint64_t)1 << 52);
+    if (power2 >= 0x7FF) {
+        return false;
+    }
+
+    uint64_t bits = mantissa | ((uint64_t)power2 << 52);
+    memcpy(value, &bits, sizeof(double));
+    return true;
+}
+
+bool Number::parseDouble(char const * str, uint32_t length, double * value) {
+    char const * p = str;
+    char const * end = str + length;
+
+    bool negative = (p < end && *p == '-');
+    p += negative;
+
+    // all digits into one integer mantissa, tracking the decimal exponent
+    uint64_t mantissa = 0;
+    int exp10 = 0;
+    uint32_t nDigits = 0;
+    uint32_t nSignificant = 0;
+    for (; p < end && (uint32_t)(*p - '0') <= 9; ++p, ++nDigits) {
+        mantissa = mantissa * 10 + (uint32_t)(*p - '0');
+        nSignificant += (mantissa != 0);
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        for (; p < end && (uint32_t)(*p - '0') <= 9; ++p, ++nDigits) {
+            mantissa = mantissa * 10 + (uint32_t)(*p - '0');
+            nSignificant += (mantissa != 0);
+            --exp10;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExp = (p < end && *p == '-');
+        p += (p < end && (*p == '-' || *p == '+'));
+        int e = 0;
+        for (; p < end && (uint32_t)(*p - '0') <= 9; ++p) {
+            if (e < 10000) e = e * 10 + (*p - '0');
+        }
+        exp10 += (negativeExp) ? -e : e;
+    }
+
+    // not a plain number, or too many digits to hold exactly
+    if (p != end || nDigits == 0 || nSignificant > MaxFastDigits) {
+        return strtoDouble(str, length, value);
+    }
+
+    double d;
+    if (mantissa == 0) {
+        d = 0.0;
+    }
+    // Clinger: mantissa and power of 10 both exact, so one rounding
+    else if (mantissa <= ((uint64_t)1 << 53) && exp10 >= -22 && exp10 <= 22) {
+        d = (double)mantissa;
+        d = (exp10 < 0) ? d / ExactPow10[-exp10] : d * ExactPow10[exp10];
+    }
+    else if (!eiselLemire(mantissa, exp10, &d)) {
+        return strtoDouble(str, length, value);
+    }
+
+    *value = (negative) ? -d : d;
+    return true;
+}
@@ -1,7 +1,6 @@
 #pragma once
-#include <errno.h>
-#include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <limits.h>
 #include "debug_defines.h"
 
@@ -11,90 +10,88 @@
 
 // String-based number.
 
-// Accepts string assumed to be numerical, tries to convert the  number as to
-// uint64_t, int64, and double then notes which conversions succeeded.
-// The values can then be accessed through type-conversion operators (with
-// optional validation, currently if DEBUG macro is true).
+// Accepts string assumed to be numerical. Nothing is converted until the
+// Number is cast through one of the type-conversion operators, then only the
+// conversion for that type runs. Integers are read with a plain digit loop,
+// floating point with a fast exact parser (Clinger's fast path, then
+// Eisel-Lemire). Anything those can't handle falls back to strtoull/strtoll/
+// strtod. Conversions are validated (currently if DEBUG macro is true).
 
 // Written for JSON string-to-number parsing, specifically rapidjson's
-// RawNumber function.
+// RawNumber function. The string doesn't need to be null-terminated if length
+// is given, as long as it isn't followed by more digits.
 
 class Number {
 public:
-    Number(char const * str, uint32_t length = UINT32_MAX) {
-        // special case, all invalid
-        if (length == 0) {
-            return;
-        }
-
-        set(str, length, TYPE_UINT);
-        set(str, length, TYPE_INT);
-        set(str, length, TYPE_DOUBLE);
+    Number(char const * str, uint32_t length = UINT32_MAX) :
+        _str(str),
+        _length((length == UINT32_MAX) ? (uint32_t)strlen(str) : length)
+    {
     }
 
-    operator uint64_t()      const { validate(TYPE_UINT); return _uint; }
-    operator uint32_t()      const { validate(TYPE_UINT, 0, UINT32_MAX); return (uint32_t)_uint; }
-    operator unsigned long() const { validate(TYPE_UINT, 0, ULONG_MAX); return (unsigned long)_uint; }
-    operator bool()          const { validate(TYPE_UINT); return (bool)_uint; }
-    operator int64_t()       const { validate(TYPE_INT); return _int; }
-    operator long()          const { validate(TYPE_INT, LONG_MIN, LONG_MAX); return (long)_int; }
-    operator int()           const { validate(TYPE_INT, INT_MIN, INT_MAX); return (int)_int; }
-    operator double()        const { validate(TYPE_DOUBLE); return _double; }
-    operator float()         const { validate(TYPE_DOUBLE); return (float)_double; }
+    operator uint64_t()      const { return toUint(0); }
+    operator uint32_t()      const { return (uint32_t)toUint(UINT32_MAX); }
+    operator unsigned long() const { return (unsigned long)toUint(ULONG_MAX); }
+    operator bool()          const { return (bool)toUint(0); }
+    operator int64_t()       const { return toInt(0, 0); }
+    operator long()          const { return (long)toInt(LONG_MIN, LONG_MAX); }
+    operator int()           const { return (int)toInt(INT_MIN, INT_MAX); }
+    operator double()        const { return toDouble(); }
+    operator float()         const { return (float)toDouble(); }
 
-private:
-    enum Type {
-        TYPE_NONE      = 0,
-        TYPE_UINT      = 1 << 0,
-        TYPE_INT       = 1 << 1,
-        TYPE_DOUBLE    = 1 << 2
-    };
+    // each returns false if str (all length chars of it) isn't a valid number
+    // of that type. value is still set to best effort.
+    static bool parseUint(char const * str, uint32_t length, uint64_t * value);
+    static bool parseInt(char const * str, uint32_t length, int64_t * value);
+    static bool parseDouble(char const * str, uint32_t length, double * value);
 
-    uint64_t _uint = 0;
-    int64_t _int = 0;
-    double _double = 0;
-    Type _valid = TYPE_NONE;
+private:
+    char const * _str = nullptr;
+    uint32_t _length = 0;
 
-    void set(char const * str, uint32_t length, Type type) {
-        if (type == TYPE_NONE) {
-            return;
+    // max/min of 0 skips range check
+    uint64_t toUint(uint64_t max) const {
+        uint64_t value = 0;
+        [[maybe_unused]] bool valid = parseUint(_str, _length, &value);
+        #if DEBUG
+        if (!valid) {
+            fprintf(stderr, "Converting to invalid type. (\"%.*s\" as uint)\n", _length, _str);
         }
-
-        char * end = NULL;
-        errno = 0;
-        switch (type) {
-        case TYPE_UINT:     { _uint     = strtoull(str, &end, 10);  break; }
-        case TYPE_INT:      { _int      = strtoll(str, &end, 10);   break; }
-        case TYPE_DOUBLE:   { _double   = strtod(str, &end);        break; }
-        default: {}
+        else if (max && value > max) {
+            fprintf(stderr, "Uint out of range.\n");
         }
-
-        if (errno == 0 && ((length < UINT32_MAX && str + length == end) || (*end == '\0'))) {
-            _valid = (Type)(_valid | type);
+        else if (_length && _str[0] == '-') {
+            fprintf(stderr, "Negative value (%.*s) cast as uint.\n", _length, _str);
         }
+        #endif // DEBUG
+        return value;
     }
 
-    #if DEBUG
-    void validate(Type type, int64_t min = 0, uint64_t max = 0) const {
-        if ((_valid & type) == 0) {
-            fprintf(stderr, "Converting to invalid type. (_valid:%d, type:%d)\n", _valid, type);
+    int64_t toInt(int64_t min, int64_t max) const {
+        int64_t value = 0;
+        [[maybe_unused]] bool valid = parseInt(_str, _length, &value);
+        #if DEBUG
+        if (!valid) {
+            fprintf(stderr, "Converting to invalid type. (\"%.*s\" as int)\n", _length, _str);
         }
-        switch (type) {
-        case TYPE_UINT: {
-            if (max && _uint > max) fprintf(stderr, "Uint out of range.\n");
-            else if ((_valid & TYPE_INT) && _int < 0) fprintf(stderr, "Negative value (%lld) cast as uint.\n", _int);
-            break;
+        else if (min && value < min) {
+            fprintf(stderr, "Int out of min range.\n");
         }
-        case TYPE_INT: {
-            if (min && _int < min) fprintf(stderr, "Int out of min range.\n");
-            else if (max && _int > (int64_t)max) fprintf(stderr, "Int out of max range.\n");
-            break;
+        else if (max && value > max) {
+            fprintf(stderr, "Int out of max range.\n");
         }
-        case TYPE_DOUBLE: {}
-        default: {}
+        #endif // DEBUG
+        return value;
+    }
+
+    double toDouble() const {
+        double value = 0.0;
+        [[maybe_unused]] bool valid = parseDouble(_str, _length, &value);
+        #if DEBUG
+        if (!valid) {
+            fprintf(stderr, "Converting to invalid type. (\"%.*s\" as double)\n", _length, _str);
         }
+        #endif // DEBUG
+        return value;
     }
-    #else
-    void validate(Type, int64_t = 0, uint64_t = 0) const {}
-    #endif // DEBUG
 };
@@ -0,0 +1,198 @@
+#include "base64.h"
+#include <string.h>
+#include "modp_b64.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BASE64_X86 1
+#else
+#define BASE64_X86 0
+#endif
+
+// -------------------------------------------------------------------------- //
+// SIMD
+// -------------------------------------------------------------------------- //
+
+/*
+Vectorized decode from Muła & Lemire, "Faster Base64 Encoding and Decoding
+using AVX2 Instructions" (2018). Each char's nibbles look up a bit pattern;
+any overlap means the char is outside the alphabet. Valid chars get a per-range
+offset (looked up by high nibble) added to get their 6-bit value, then
+multiply-adds pack 4 values into 3 bytes.
+
+Each function decodes whole blocks from the start of src and returns how many
+chars it used. It stops early at any char it can't handle ('=', invalid), and
+the rest is left to the scalar decoder. Stores are full width, so they write
+past the block's output. Blocks stop while there is enough input left that
+the overrun is still inside the decoded output.
+*/
+
+#if BASE64_X86
+
+__attribute__((target("ssse3")))
+static size_t decodeBlocksSSSE3(byte_t * dst, char const * src, size_t length) {
+    __m128i const lutLo = _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    __m128i const lutHi = _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    __m128i const lutRoll = _mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i const mask2F = _mm_set1_epi8(0x2F);
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const pack = _mm_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    // 16 chars -> 12 bytes, 16 stored. 8 more chars decode to at least 4.
+    size_t i = 0;
+    for (; i + 16 + 8 <= length; i += 16, dst += 12) {
+        __m128i in = _mm_loadu_si128((__m128i const *)(src + i));
+        __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask2F);
+        __m128i loNibbles = _mm_and_si128(in, mask2F);
+        __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+        __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), zero)) != 0xFFFF) {
+            break;
+        }
+        __m128i eq2F = _mm_cmpeq_epi8(in, mask2F);
+        __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+        __m128i values = _mm_add_epi8(in, roll);
+        __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i out = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        out = _mm_shuffle_epi8(out, pack);
+        _mm_storeu_si128((__m128i *)dst, out);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t decodeBlocksAVX2(byte_t * dst, char const * src, size_t length) {
+    __m256i const lutLo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    __m256i const lutHi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    __m256i const lutRoll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i const mask2F = _mm256_set1_epi8(0x2F);
+    __m256i const pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    __m256i const lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+    // 32 chars -> 24 bytes, 32 stored. 16 more chars decode to at least 10.
+    size_t i = 0;
+    for (; i + 32 + 16 <= length; i += 32, dst += 24) {
+        __m256i in = _mm256_loadu_si256((__m256i const *)(src + i));
+        __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask2F);
+        __m256i loNibbles = _mm256_and_si256(in, mask2F);
+        __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+        __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        if (!_mm256_testz_si256(lo, hi)) {
+            break;
+        }
+        __m256i eq2F = _mm256_cmpeq_epi8(in, mask2F);
+        __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+        __m256i values = _mm256_add_epi8(in, roll);
+        __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i out = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        out = _mm256_shuffle_epi8(out, pack);
+        out = _mm256_permutevar8x32_epi32(out, lanes);
+        _mm256_storeu_si256((__m256i *)dst, out);
+    }
+    return i;
+}
+
+#endif // BASE64_X86
+
+// -------------------------------------------------------------------------- //
+// INTERFACE
+// -------------------------------------------------------------------------- //
+
+size_t base64DecodedSize(char const * src, size_t length) {
+    if (length < 4) {
+        return 0;
+    }
+    size_t size = length / 4 * 3;
+    if (src[length-1] == '=') --size;
+    if (src[length-2] == '=') --size;
+    return size;
+}
+
+size_t base64Decode(byte_t * dst, char const * src, size_t length) {
+    static Base64Impl const impl = base64BestImpl();
+    return base64Decode(impl, dst, src, length);
+}
+
+size_t base64Decode(Base64Impl impl, byte_t * dst, char const * src, size_t length) {
+    size_t used = 0;
+    #if BASE64_X86
+    switch (impl) {
+    case BASE64_AVX2:  { used = decodeBlocksAVX2 (dst, src, length); break; }
+    case BASE64_SSSE3: { used = decodeBlocksSSSE3(dst, src, length); break; }
+    default: {}
+    }
+    #endif // BASE64_X86
+
+    // blocks are whole quads, so the rest is still padded base64
+    size_t written = used / 4 * 3;
+    if (used == length) {
+        return written;
+    }
+    size_t rest = modp_b64_decode((char *)dst + written, src + used, length - used);
+    if (rest == MODP_B64_ERROR) {
+        return Base64Error;
+    }
+    return written + rest;
+}
+
+char const * base64DataURI(char const * str, size_t * length) {
+    if (*length < 5 || strncmp(str, "data:", 5) != 0) {
+        return nullptr;
+    }
+    char const * comma = (char const *)memchr(str, ',', *length);
+    if (comma == nullptr ||
+        comma - str < 12 ||
+        strncmp(comma - 7, ";base64", 7) != 0
+    ) {
+        return nullptr;
+    }
+    *length -= (comma + 1 - str);
+    return comma + 1;
+}
+
+bool base64Supports(Base64Impl impl) {
+    switch (impl) {
+    case BASE64_SCALAR: return true;
+    #if BASE64_X86
+    case BASE64_SSSE3:  return __builtin_cpu_supports("ssse3");
+    case BASE64_AVX2:   return __builtin_cpu_supports("avx2");
+    #endif // BASE64_X86
+    default:            return false;
+    }
+}
+
+Base64Impl base64BestImpl() {
+    if (base64Supports(BASE64_AVX2))  return BASE64_AVX2;
+    if (base64Supports(BASE64_SSSE3)) return BASE64_SSSE3;
+    return BASE64_SCALAR;
+}
+
+char const * base64ImplStr(Base64Impl impl) {
+    switch (impl) {
+    case BASE64_SCALAR: return "scalar";
+    case BASE64_SSSE3:  return "SSSE3";
+    case BASE64_AVX2:   return "AVX2";
+    default:            return "unknown";
+    }
+}
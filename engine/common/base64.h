@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+#include "debug_defines.h"
+#include "types.h"
+
+/*
+
+Base64 decoding (standard alphabet, padded).
+
+Most of the input is decoded 16 or 32 chars at a time with SIMD, when the CPU
+has it (AVX2, then SSSE3, checked once at runtime). The last few chars, and
+everything on other CPUs, go through modp_b64. dst only needs
+base64DecodedSize() bytes, so data can be decoded straight into its final
+place.
+
+*/
+
+enum Base64Impl {
+    BASE64_SCALAR,
+    BASE64_SSSE3,
+    BASE64_AVX2,
+};
+
+static constexpr size_t Base64Error = (size_t)-1;
+
+// exact number of bytes src decodes to. doesn't validate.
+size_t base64DecodedSize(char const * src, size_t length);
+// returns bytes written, or Base64Error if src isn't valid base64
+size_t base64Decode(byte_t * dst, char const * src, size_t length);
+size_t base64Decode(Base64Impl impl, byte_t * dst, char const * src, size_t length);
+
+// for string "data:[<mediatype>];base64,<data>", returns start of data and
+// sets length to its length. nullptr if not a base64 data URI.
+char const * base64DataURI(char const * str, size_t * length);
+
+bool base64Supports(Base64Impl impl);
+Base64Impl base64BestImpl();
+char const * base64ImplStr(Base64Impl impl);
+
+#if DEV_INTERFACE
+void base64Editor();
+#endif // DEV_INTERFACE
@@ -0,0 +1,101 @@
+#include "base64.h"
+#include <chrono>
+#include "modp_b64.h"
+#include "imgui_bgfx_glfw/imgui_bgfx_glfw.h"
+#include "../MrManager.h"
+
+#if DEV_INTERFACE
+
+using namespace ImGui;
+
+/*
+Decode throughput of each implementation the CPU supports against plain
+modp_b64, over a few MB of random data. GB/s is of base64 input.
+*/
+void base64Editor() {
+    if (!CollapsingHeader("Base64")) {
+        return;
+    }
+
+    Text("Using: %s", base64ImplStr(base64BestImpl()));
+
+    static constexpr size_t DataSize = 4 * 1024 * 1024;
+    static constexpr int Iterations = 5;
+    static constexpr int NImpls = BASE64_AVX2 + 1;
+    // best GB/s, [NImpls] is modp_b64
+    static double gbps[NImpls + 1] = {};
+    static bool didRun = false;
+    static bool failed = false;
+
+    TextUnformatted("Decode Benchmark:");
+    SameLine();
+    if (Button("Run##Base64Benchmark")) {
+        size_t encodedSize = modp_b64_encode_len(DataSize);
+        byte_t * raw = (byte_t *)mm.memMan.request({.size = DataSize});
+        char * encoded = (char *)mm.memMan.request({.size = encodedSize});
+        byte_t * decoded = (byte_t *)mm.memMan.request({.size = DataSize});
+        failed = (raw == nullptr || encoded == nullptr || decoded == nullptr);
+
+        if (!failed) {
+            for (size_t i = 0; i < DataSize; ++i) {
+                raw[i] = (byte_t)((i * 2654435761u) >> 13);
+            }
+            size_t length = modp_b64_encode(encoded, (char const *)raw, DataSize);
+
+            auto bestGBps = [length](auto const & fn) {
+                double best = 0.0;
+                for (int i = 0; i < Iterations; ++i) {
+                    auto start = std::chrono::steady_clock::now();
+                    fn();
+                    std::chrono::duration<double> s = std::chrono::steady_clock::now() - start;
+                    double rate = (double)length / s.count() / 1e9;
+                    if (rate > best) best = rate;
+                }
+                return best;
+            };
+
+            for (int impl = 0; impl < NImpls; ++impl) {
+                if (!base64Supports((Base64Impl)impl)) {
+                    gbps[impl] = 0.0;
+                    continue;
+                }
+                gbps[impl] = bestGBps([&]{
+                    base64Decode((Base64Impl)impl, decoded, encoded, length);
+                });
+                if (memcmp(decoded, raw, DataSize) != 0) {
+                    fprintf(stderr, "Base64 %s decode mismatch.\n", base64ImplStr((Base64Impl)impl));
+                }
+            }
+            gbps[NImpls] = bestGBps([&]{
+                modp_b64_decode((char *)decoded, encoded, length);
+            });
+        }
+
+        if (raw)     mm.memMan.request({.ptr = raw});
+        if (encoded) mm.memMan.request({.ptr = encoded});
+        if (decoded) mm.memMan.request({.ptr = decoded});
+        didRun = true;
+    }
+
+    if (failed) {
+        TextUnformatted("Not enough memory for benchmark buffers.");
+    }
+    else if (didRun) {
+        Text("%-8s %6.2f GB/s", "modp_b64", gbps[NImpls]);
+        for (int impl = 0; impl < NImpls; ++impl) {
+            if (gbps[impl] == 0.0) {
+                Text("%-8s unsupported", base64ImplStr((Base64Impl)impl));
+                continue;
+            }
+            Text("%-8s %6.2f GB/s (%.1fx)",
+                base64ImplStr((Base64Impl)impl),
+                gbps[impl],
+                gbps[impl] / gbps[NImpls]
+            );
+        }
+    }
+
+    Dummy(ImVec2(0.0f, 20.0f));
+}
+
+#endif // DEV_INTERFACE
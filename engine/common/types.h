@@ -72,10 +72,12 @@ enum MemBlockType {
     MEM_BLOCK_ARRAY,
     MEM_BLOCK_CHARKEYS,
     MEM_BLOCK_FILE,
+    MEM_BLOCK_FRAMERING,
     MEM_BLOCK_FRAMESTACK,
     MEM_BLOCK_FREELIST,
     MEM_BLOCK_GOBJ,
     MEM_BLOCK_POOL,
+    MEM_BLOCK_THREADARENA,
 
     // requested by BGFX. (no special treatment atm)
     MEM_BLOCK_BGFX,
@@ -107,4 +109,8 @@ struct MemManFSASetup {
         uint16_t nSubBlocks[Max] = {0};
     };
     size_t align = 0;
+    // target byte size of sub-blocks in each growth slab. when a group is
+    // full, another slab for it is created in a new MemMan block. only groups
+    // with nSubBlocks > 0 grow. 0 disables growth.
+    size_t slabSize = 0;
 };
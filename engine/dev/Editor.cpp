@@ -9,6 +9,7 @@
 #include "../MrManager.h"
 #include "../memory/CharKeys.h"
 #include "../memory/mem_utils.h"
+#include "../common/base64.h"
 #include "../common/string_utils.h"
 
 // ImGuiTreeNodeFlags_DefaultOpen
@@ -36,6 +37,7 @@ void Editor::tick() {
 
     if (mm.setup.prependInsideEditor) mm.setup.prependInsideEditor();
     guiRendering();
+    guiRenderStats();
     guiLighting();
     guiCamera();
     guiHelpers();
@@ -44,6 +46,9 @@ void Editor::tick() {
     guiFog();
     guiColors();
     guiMem();
+    guiJobs();
+    guiFileIO();
+    guiBase64();
     #if DEBUG
     guiDebugger();
     #endif // DEBUG
@@ -93,6 +98,7 @@ void Editor::guiRendering() {
             SameLine();
             ColorEdit4("##aabbColor", mm.rendSys.settings.user.aabbColor, ImGuiColorEditFlags_DisplayHex);
         }
+        Checkbox("Frustum Cull", &mm.rendSys.settings.user.frustumCull);
         
         if (user != mm.rendSys.settings.user) {
             mm.rendSys.settings.reinit();
@@ -106,6 +112,10 @@ void Editor::guiRendering() {
     }    
 }
 
+void Editor::guiRenderStats() {
+    mm.rendSys.editor();
+}
+
 void Editor::guiLighting() {
     if (CollapsingHeader("Lighting")) {
 
@@ -518,6 +528,18 @@ void Editor::guiMem() {
     mm.memMan.editor();
 }
 
+void Editor::guiJobs() {
+    mm.jobs.editor();
+}
+
+void Editor::guiFileIO() {
+    mm.io.editor();
+}
+
+void Editor::guiBase64() {
+    base64Editor();
+}
+
 #if DEBUG
 void Editor::guiDebugger() {
     if (CollapsingHeader("Debugger")) {
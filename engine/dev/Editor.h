@@ -23,6 +23,11 @@ public:
     void * winPtr = nullptr;
 };
 
+/*
+Dev sidebar. The engine has no test or benchmark targets, so benchmarks and
+stress tests are buttons in the panel of the system they cover (Memory, Jobs,
+Render Stats, Base64, ...), and run in the live engine.
+*/
 class Editor {
 public:
 
@@ -32,6 +37,7 @@ public:
 
     // main sidebar window
     void guiRendering();
+    void guiRenderStats();
     void guiLighting();
     void guiCamera();
     void guiHelpers();
@@ -42,6 +48,9 @@ public:
     void guiFog();
     void guiColors();
     void guiMem();
+    void guiJobs();
+    void guiFileIO();
+    void guiBase64();
 
     #if DEBUG
     void guiDebugger();
@@ -62,9 +62,47 @@ struct EngineSetup {
     // size in bytes for frame-stack
     size_t memManFrameStackSize = 1024*1024*10;
 
-    // number of concurrent auto-released allocations
+    // size in bytes each thread claims at once from the frame-stack, so
+    // threads can allocate from it without contending. 0 disables pens.
+    size_t memManFrameStackPenSize = 1024*64;
+
+    // size in bytes for multi-frame ring, split evenly across its buckets.
+    // allocations with a short lifetime bump into it and are released when
+    // their bucket's frame ends.
+    size_t memManFrameRingSize = 1024*1024*32;
+
+    // number of concurrent auto-released allocations. used for lifetimes the
+    // frame ring can't hold.
     size_t memManAutoReleaseBufferSize = 32;
 
+    // size in bytes of each worker thread's arena for small allocations.
+    // 0 disables arenas; workers then allocate through the main lock.
+    size_t memManThreadArenaSize = 1024*1024*2;
+
+    // .glb files of at least this many bytes are memory-mapped instead of
+    // read, and the Gobj's buffer points into the mapped BIN chunk instead of
+    // a copy. 0 never maps.
+    size_t memManMapGLBMinSize = 1024*1024*16;
+
+    // directory for baked Gobjs. GLTFs loaded through MemMan are written here
+    // as relocatable binary images, then loaded from those with a single read
+    // until the source file changes. created if missing. nullptr disables.
+    char const * memManGobjCacheDir = nullptr;
+
+    // number of job system worker threads. 0 uses hardware concurrency, minus
+    // one for the main thread.
+    size_t workerThreadCount = 0;
+
+    // max jobs queued or running at once. more run inline on the calling thread.
+    size_t jobCapacity = 1024;
+
+    // number of blocking file I/O threads, used where io_uring isn't.
+    size_t ioThreadCount = 2;
+
+    // max file reads queued or in flight at once. more are read inline on the
+    // calling thread.
+    size_t ioCapacity = 256;
+
     // fixed-size allocator setup
     MemManFSASetup memManFSA{
         .n2byteSubBlocks = 32,
@@ -77,6 +115,7 @@ struct EngineSetup {
         .n256byteSubBlocks = 64,
         .n512byteSubBlocks = 8,
         .align = 64,
+        .slabSize = 1024*4,
     };
 
     bool transparentFramebuffer = false;
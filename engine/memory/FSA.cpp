@@ -10,7 +10,7 @@ uint16_t FSA::subBlockCountForGroup(uint16_t groupIndex) const {
 
 byte_t const * FSA::freeListPtrForGroup(uint16_t groupIndex) const {
     assert(groupIndex < Max && "Index out of range.");
-    return _freeList[groupIndex];
+    return (byte_t const *)_freeList[groupIndex];
 }
 
 bool FSA::isFree(uint16_t groupIndex, uint16_t subBlockIndex) const {
@@ -18,16 +18,17 @@ bool FSA::isFree(uint16_t groupIndex, uint16_t subBlockIndex) const {
     assert(groupIndex < Max && "Group index out of range.");
     assert(subBlockIndex < _nSubBlocks[groupIndex] && "Sub-block index out of range.");
 
-    byte_t * freeList = _freeList[groupIndex];
+    uint64_t * freeList = _freeList[groupIndex];
 
     #if DEBUG
-    assert(data() <= freeList && freeList < data() + _dataSize &&
+    assert(data() <= (byte_t *)freeList && (byte_t *)freeList < data() + _dataSize &&
         "Free-list not in expected range. Did FSA move memory location since init? "
         "Be sure to call updateMap() if that happens.");
     #endif // DEBUG
 
     // LSB is first sub-index to check, MSB is last
-    bool bitValue = (freeList[subBlockIndex/8] >> (subBlockIndex % 8)) & 1;
+    uint64_t word = __atomic_load_n(&freeList[subBlockIndex >> 6], __ATOMIC_RELAXED);
+    bool bitValue = (word >> (subBlockIndex & 63)) & 1;
     return (bitValue == false);
 }
 
@@ -37,37 +38,26 @@ bool FSA::indicesForPtr(void * ptr, uint16_t * foundGroupIndex, uint16_t * found
         return false;
     }
 
+    // page table lookup. free lists and page table itself map to no group.
     byte_t * bptr = (byte_t *)ptr;
-    uint16_t groupIndex = 0;
-    uint16_t byteSize = 0;
-    uint16_t subBlockIndex = 0;
-    for (; groupIndex < Max; ++groupIndex) {
-        // this group doesn't exist
-        if (_groupBase[groupIndex] == nullptr) {
-            continue;
-        }
-
-        // we have gone past the bptr. it must not be valid!
-        if (bptr < _groupBase[groupIndex]) {
-            return false;
-        }
+    size_t page = (size_t)(bptr - data()) >> _pageShift;
+    if (page >= _nPages) {
+        return false;
+    }
+    uint8_t groupIndex = _pageTable[page];
+    if (groupIndex == NoGroup) {
+        return false;
+    }
 
-        // subBlockIndex will be calculated, but too big if we haven't gotten
-        // to the real group yet.
-        // for example if our pointer is the 4-byte block, the index will
-        // always be out of range when considering the 2-byte block.
-        byteSize = 2 << groupIndex;
-        subBlockIndex = (bptr - _groupBase[groupIndex]) / byteSize;
-
-        // we have a match!
-        if (subBlockIndex < _nSubBlocks[groupIndex]) {
-            if (foundGroupIndex) *foundGroupIndex = groupIndex;
-            if (foundSubBlockIndex) *foundSubBlockIndex = subBlockIndex;
-            return true;
-        }
+    // last page of a group may be alignment padding past its last sub-block
+    size_t subBlockIndex = (size_t)(bptr - _groupBase[groupIndex]) >> (groupIndex + 1);
+    if (subBlockIndex >= _nSubBlocks[groupIndex]) {
+        return false;
     }
 
-    return false;
+    if (foundGroupIndex) *foundGroupIndex = groupIndex;
+    if (foundSubBlockIndex) *foundSubBlockIndex = (uint16_t)subBlockIndex;
+    return true;
 }
 
 byte_t const * FSA::data() const {
@@ -79,30 +69,36 @@ bool FSA::containsPtr(void * ptr) const {
 }
 
 uint16_t FSA::sizeForPtr(void * ptr) const {
-    byte_t * bptr = (byte_t *)ptr;
-    uint16_t groupIndex = 0;
-    uint16_t byteSize = 0;
-    for (; groupIndex < Max; ++groupIndex) {
-        // this group doesn't exist
-        if (_groupBase[groupIndex] == nullptr) {
-            continue;
-        }
+    uint16_t groupIndex;
+    if (indicesForPtr(ptr, &groupIndex, nullptr) == false) {
+        return 0;
+    }
+    return SubBlockByteSize(groupIndex);
+}
 
-        // we have gone past the bptr. it must not be valid!
-        if (bptr < _groupBase[groupIndex]) { return 0; }
+bool FSA::isSlab() const {
+    return (_primary != nullptr);
+}
 
-        // see indicesForPtr for breakdown of this logic
-        byteSize = 2 << groupIndex;
-        if ((bptr - _groupBase[groupIndex]) / byteSize < _nSubBlocks[groupIndex]) {
-            return byteSize;
-        }
-    }
-    return 0;
+uint32_t FSA::liveCountForGroup(uint16_t groupIndex) const {
+    assert(groupIndex < Max && "Index out of range.");
+    return __atomic_load_n(&_nLiveTotal[groupIndex], __ATOMIC_RELAXED);
+}
+
+uint32_t FSA::highWaterForGroup(uint16_t groupIndex) const {
+    assert(groupIndex < Max && "Index out of range.");
+    return __atomic_load_n(&_highWater[groupIndex], __ATOMIC_RELAXED);
+}
+
+uint16_t FSA::slabCountForGroup(uint16_t groupIndex) const {
+    assert(groupIndex < Max && "Index out of range.");
+    return _nSlabs[groupIndex];
 }
 
 FSA::FSA(Setup const & setup) {
-    _align = setup.align;
+    _align = GroupAlign(setup.align);
     _dataSize = DataSize(setup);
+    _slabSize = setup.slabSize;
 
     // set sub-block counts for all groups
     for (uint16_t i = 0; i < Max; ++i) {
@@ -123,13 +119,29 @@ void FSA::updateMap() {
             _groupBase[i] = nullptr;
             continue;
         }
-        _freeList[i] = nextPtr;
+        _freeList[i] = (uint64_t *)nextPtr;
         uint16_t freeListByteSize = FreeListByteSize(_nSubBlocks[i], _align);
         _groupBase[i] = nextPtr + freeListByteSize;
         nextPtr +=
             freeListByteSize +
             alignSize(SubBlockByteSize(i) * _nSubBlocks[i], _align);
     }
+
+    // page table follows last group
+    _pageShift = (uint8_t)__builtin_ctzll(_align);
+    _nPages = (size_t)(nextPtr - data()) >> _pageShift;
+    _pageTable = (uint8_t *)nextPtr;
+    memset(_pageTable, NoGroup, _nPages);
+    for (size_t i = 0; i < Max; ++i) {
+        if (_nSubBlocks[i] == 0) {
+            continue;
+        }
+        size_t firstPage = (size_t)(_groupBase[i] - data()) >> _pageShift;
+        size_t nPages = alignSize(SubBlockByteSize(i) * _nSubBlocks[i], _align) >> _pageShift;
+        memset(_pageTable + firstPage, (int)i, nPages);
+    }
+    nextPtr += PageTableByteSize(nextPtr - data(), _align);
+
     assert(_dataSize == nextPtr - data() && "Unexpected data size.");
 }
 
@@ -143,95 +155,48 @@ void * FSA::alloc(size_t size) {
     if (size < MinBytes) return nullptr;
 
     // find index of appropriate group (smallest sub-block size that fits size)
-    uint8_t groupIndex = 0;
-    uint16_t test = 2;
-    while(size > test && groupIndex < Max) {
-        test <<= 1;
-        groupIndex += 1;
-    }
-
-    // size was too big
-    if (groupIndex >= Max) return nullptr;
-
-    // actual byte size of free-list without trailing padding
-    // this also ensures nSubBlocks for this group is multiple of 8.
-    uint16_t freeListByteSize = FreeListByteSize(_nSubBlocks[groupIndex], 0);
-
-    // loop through free-list bytes
-    for (uint16_t freeListByte = 0; freeListByte < freeListByteSize; ++freeListByte) {
-        // ensures there is a free bit to find in this byte
-        if (_freeList[groupIndex][freeListByte] == 0xff) {
-            continue;
-        }
-
-        // LSB it first sub-index to check, MSB is last
-        uint8_t bitIndex = 0;
-        uint8_t byte = _freeList[groupIndex][freeListByte];
-        while (byte & 1) {
-            byte >>= 1;
-            bitIndex += 1;
-
-            // TODO: take this check out, even in DEBUG mode.
-            // only here to ward against coding errors.
-            #if DEBUG
-            assert(bitIndex < 8 && "Debug double-check we found a free bit. "
-                "(Earlier test against 0xff should have solved");
-            #endif // DEBUG
+    uint8_t groupIndex = IndexForByteSize(size);
+    uint64_t * freeList = _freeList[groupIndex];
+    if (freeList == nullptr) return nullptr;
+
+    // loop through free-list words. trailing bits past _nSubBlocks are set
+    // claimed at init, so they are never found.
+    uint16_t nWords = FreeListWordCount(_nSubBlocks[groupIndex]);
+    for (uint16_t wordIndex = 0; wordIndex < nWords; ++wordIndex) {
+        uint64_t word = __atomic_load_n(&freeList[wordIndex], __ATOMIC_RELAXED);
+
+        // keep trying free bits in this word until we win one. another thread
+        // may claim the same bit between our load and fetch-or.
+        while (word != UINT64_MAX) {
+            // LSB is first sub-index to check, MSB is last
+            uint16_t subBlockIndex = wordIndex * 64 + __builtin_ctzll(~word);
+
+            assert(subBlockIndex < _nSubBlocks[groupIndex] && "Sub-block index out of range.");
+
+            if (setClaimed(freeList, subBlockIndex)) {
+                trackAlloc(groupIndex);
+                void * ptr = (void *)subBlockPtr(groupIndex, subBlockIndex);
+                assert((byte_t *)ptr > data() && (byte_t *)ptr + size <= data() + _dataSize && "FSA ptr out of range.");
+                return ptr;
+            }
+            word = __atomic_load_n(&freeList[wordIndex], __ATOMIC_RELAXED);
         }
-
-        uint16_t subBlockIndex = freeListByte * 8 + bitIndex;
-
-        assert(subBlockIndex < _nSubBlocks[groupIndex] && "Sub-block index out of range.");
-
-        void * ptr = (void *)subBlockPtr(groupIndex, subBlockIndex);
-        assert((byte_t *)ptr > data() && (byte_t *)ptr + size <= data() + _dataSize && "FSA ptr out of range.");
-        setClaimed(_freeList[groupIndex], subBlockIndex);
-        return ptr;
     }
     return nullptr;
 }
 
 bool FSA::destroy(void * ptr) {
-    // bail if pointer outside our FSA data block
-    if (ptr <= data() || ptr >= data() + _dataSize) {
+    uint16_t groupIndex;
+    uint16_t subBlockIndex;
+    if (indicesForPtr(ptr, &groupIndex, &subBlockIndex) == false) {
         return false;
     }
 
-    byte_t * bptr = (byte_t *)ptr;
-    uint16_t groupIndex = 0;
-    uint16_t byteSize = 0;
-    uint16_t subBlockIndex = 0;
-    for (; groupIndex < Max; ++groupIndex) {
-        // this group doesn't exist
-        if (_groupBase[groupIndex] == nullptr) {
-            continue;
-        }
-
-        // we have gone past the bptr. it must not be valid!
-        if (bptr < _groupBase[groupIndex]) {
-            return false;
-        }
-
-        // subBlockIndex will be calculated, but too big if we haven't gotten
-        // to the real group yet.
-        // for example if our pointer is the 4-byte block, the index will
-        // always be out of range when considering the 2-byte block.
-        byteSize = 2 << groupIndex;
-        subBlockIndex = (bptr - _groupBase[groupIndex]) / byteSize;
-
-        // we have a match!
-        if (subBlockIndex < _nSubBlocks[groupIndex]) {
-            // printl("FSA (SubBlockByteSize(%d): %d, nSubBlocks %d, subBlockIndex: %d)",
-            //     groupIndex, SubBlockByteSize(groupIndex), _nSubBlocks[groupIndex], subBlockIndex);
-            // printl("clearing FSA bytes %p-%p, ", bptr, bptr + byteSize);
-            // printmem(bptr, byteSize);
-            setFree(_freeList[groupIndex], subBlockIndex);
-            memset(bptr, 0x00, byteSize);
-            return true;
-        }
-    }
-
-    return false;
+    // clear before release, so the next claimer sees zeroed memory
+    memset(ptr, 0x00, SubBlockByteSize(groupIndex));
+    setFree(_freeList[groupIndex], subBlockIndex);
+    trackFree(groupIndex);
+    return true;
 }
 
 byte_t * FSA::subBlockPtr(uint16_t groupIndex, uint16_t subBlockIndex) {
@@ -243,12 +208,21 @@ byte_t * FSA::subBlockPtr(uint16_t groupIndex, uint16_t subBlockIndex) {
         (2 << groupIndex) * subBlockIndex;  // sub-block byte-size * sub-block index
 }
 
-void FSA::setClaimed(byte_t * freeList, uint16_t subBlockIndex) {
-    freeList[subBlockIndex/8] |= (uint8_t)1 << (subBlockIndex % 8);
+bool FSA::setClaimed(uint64_t * freeList, uint16_t subBlockIndex) {
+    uint64_t mask = (uint64_t)1 << (subBlockIndex & 63);
+    uint64_t prev = __atomic_fetch_or(&freeList[subBlockIndex >> 6], mask, __ATOMIC_ACQUIRE);
+    return (prev & mask) == 0;
 }
 
-void FSA::setFree(byte_t * freeList, uint16_t subBlockIndex) {
-    freeList[subBlockIndex/8] &= ((uint8_t)1 << (subBlockIndex % 8)) ^ 0xff;
+void FSA::setFree(uint64_t * freeList, uint16_t subBlockIndex) {
+    uint64_t mask = (uint64_t)1 << (subBlockIndex & 63);
+    #if DEBUG
+    uint64_t prev =
+    #endif // DEBUG
+    __atomic_fetch_and(&freeList[subBlockIndex >> 6], ~mask, __ATOMIC_RELEASE);
+    #if DEBUG
+    assert((prev & mask) && "Sub-block already free.");
+    #endif // DEBUG
 }
 
 void FSA::setAllFree() {
@@ -265,18 +239,41 @@ void FSA::setAllFreeInGroup(uint16_t groupIndex) {
     // bail early if no sub-blocks in this group
     if (_nSubBlocks[groupIndex] == 0) return;
 
-    byte_t * freeList = _freeList[groupIndex];
+    uint64_t * freeList = _freeList[groupIndex];
 
     #if DEBUG
-    assert(data() <= freeList && freeList < data() + _dataSize &&
+    assert(data() <= (byte_t *)freeList && (byte_t *)freeList < data() + _dataSize &&
         "Free-list not in expected range. Did FSA move memory location since init? "
         "Be sure to call updateMap() if that happens.");
     #endif // DEBUG
 
-    uint16_t byteSize = FreeListByteSize(_nSubBlocks[groupIndex], _align);
-    // printl("_nSubBlocks[%d]=%d, free-list byte size: %d, writing to: %p",
-    //     groupIndex, _nSubBlocks[groupIndex], byteSize, freeList);
-    memset(freeList, 0x00, byteSize);
+    uint16_t nSubBlocks = _nSubBlocks[groupIndex];
+    uint16_t nWords = FreeListWordCount(nSubBlocks);
+    // printl("_nSubBlocks[%d]=%d, free-list word count: %d, writing to: %p",
+    //     groupIndex, _nSubBlocks[groupIndex], nWords, freeList);
+    for (uint16_t i = 0; i < nWords; ++i) {
+        __atomic_store_n(&freeList[i], 0, __ATOMIC_RELAXED);
+    }
+    // mark bits past the last sub-block as claimed so alloc never finds them
+    if (nSubBlocks & 63) {
+        __atomic_store_n(&freeList[nWords - 1], UINT64_MAX << (nSubBlocks & 63), __ATOMIC_RELEASE);
+    }
+}
+
+void FSA::trackAlloc(uint8_t groupIndex) {
+    __atomic_add_fetch(&_nLive[groupIndex], 1, __ATOMIC_RELAXED);
+    FSA * primary = (_primary) ? _primary : this;
+    uint32_t total = __atomic_add_fetch(&primary->_nLiveTotal[groupIndex], 1, __ATOMIC_RELAXED);
+    uint32_t highWater = __atomic_load_n(&primary->_highWater[groupIndex], __ATOMIC_RELAXED);
+    while (total > highWater &&
+        !__atomic_compare_exchange_n(&primary->_highWater[groupIndex], &highWater, total,
+            true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+void FSA::trackFree(uint8_t groupIndex) {
+    __atomic_sub_fetch(&_nLive[groupIndex], 1, __ATOMIC_RELAXED);
+    FSA * primary = (_primary) ? _primary : this;
+    __atomic_sub_fetch(&primary->_nLiveTotal[groupIndex], 1, __ATOMIC_RELAXED);
 }
 
 void FSA::printInfo() {
@@ -294,6 +291,7 @@ void FSA::printInfo() {
         printl("FreeListByteSize %zu", FreeListByteSize(_nSubBlocks[i], _align));
         printl("SubBlocksByteSize %zu", alignSize(SubBlockByteSize(i) * _nSubBlocks[i], _align));
     }
+    printl("_pageTable = %p (%zu pages)", _pageTable, _nPages);
     printl("dataSize = %zu", _dataSize);
 }
 
@@ -16,17 +16,39 @@ Uses some basic POT tricks to quickly find previous allocs and free slots.
 Designed to exist in a MemMan block, setup privately, and utilized to avoid
 creating new blocks.
 
+Free lists are arrays of 64-bit words, scanned with count-trailing-zeros.
+Sub-blocks are claimed and released with atomic fetch-or/fetch-and, so alloc()
+and destroy() are safe to call from any thread without a lock. The group map
+(_freeList, _groupBase, _nSubBlocks) is only written at init.
+
+Groups can grow. When a group is full, MemMan creates a "slab": another FSA
+with only that group, in its own MemMan block, chained off the primary FSA's
+_slabs. Slabs are released as soon as they empty. Slab chains are only
+touched with MemMan's main mutex locked; the lock-free path only ever uses the
+primary FSA. The primary FSA also keeps live and high-water counts per group
+(slabs included), to help size Setup from real runs.
+
 FSA data structure (within a MemMan block):
             data() start
             v
             | 2-byte group of sub-blocks (if present) || 4-byte group etc    ...
 |__________||______________|__|__|__|__|__|__|__|__|__||______________|____|_...
 FSA         Free list      Sub-blocks                  Free list      Sub-blk...
-(class      (bit-array)
+(class      (64-bit words)
 storage)    ^                                          ^
             alignment point                            align pt
                            ^                                          ^
                            alignment point                            align pt
+
+    ...  last group ||____________|
+                      Page table
+                      ^
+                      align pt
+
+Every group boundary is an alignment point, so each align-sized "page" of the
+groups' data belongs to exactly one free list or one group's sub-blocks. The
+page table holds a group index per page (NoGroup for free lists), making
+pointer to group lookup a shift and one read.
 */
 
 class FSA {
@@ -38,18 +60,44 @@ public:
     static constexpr size_t MaxBytes = 1 << Max;
 
     static constexpr size_t DataSize(Setup const & setup) {
+        size_t groupsSize = GroupsDataSize(setup);
+        return groupsSize + PageTableByteSize(groupsSize, GroupAlign(setup.align));
+    }
+
+    // data size of all free lists and sub-blocks, without page table
+    static constexpr size_t GroupsDataSize(Setup const & setup) {
         size_t size = 0;
         for (size_t i = 0; i < Max; ++i) {
             if (setup.nSubBlocks[i] == 0) {
                 continue;
             }
             size +=
-                FreeListByteSize(setup.nSubBlocks[i], setup.align) +
-                alignSize(SubBlockByteSize(i) * setup.nSubBlocks[i], setup.align);
+                FreeListByteSize(setup.nSubBlocks[i], GroupAlign(setup.align)) +
+                alignSize(SubBlockByteSize(i) * setup.nSubBlocks[i], GroupAlign(setup.align));
         }
         return size;
     }
 
+    // sub-block count of a growth slab for group
+    static constexpr uint16_t SlabSubBlockCount(size_t slabSize, uint8_t groupIndex) {
+        size_t count = slabSize / SubBlockByteSize(groupIndex);
+        if (count < 1) return 1;
+        if (count > UINT16_MAX) return UINT16_MAX;
+        return (uint16_t)count;
+    }
+
+    static constexpr size_t PageTableByteSize(size_t groupsDataSize, size_t groupAlign) {
+        // groupAlign is a power of two
+        return (groupsDataSize / groupAlign + groupAlign - 1) & ~(groupAlign - 1);
+    }
+
+    // free-list words are accessed atomically, so groups are always at least
+    // word aligned
+    static constexpr size_t GroupAlign(size_t align) {
+        assert((align & (align - 1)) == 0 && "FSA align must be a power of two.");
+        return (align < sizeof(uint64_t)) ? sizeof(uint64_t) : align;
+    }
+
 // INIT
 private:
     friend class MemMan;
@@ -65,6 +113,11 @@ public:
     byte_t const * data() const;
     bool containsPtr(void * ptr) const;
     uint16_t sizeForPtr(void * ptr) const;
+    bool isSlab() const;
+    // stats, slabs included. only meaningful on primary FSA.
+    uint32_t liveCountForGroup(uint16_t groupIndex) const;
+    uint32_t highWaterForGroup(uint16_t groupIndex) const;
+    uint16_t slabCountForGroup(uint16_t groupIndex) const;
 
 // INTERNALS
 private:
@@ -75,10 +128,14 @@ private:
     // release sub-block at ptr
     bool destroy(void * ptr);
     byte_t * subBlockPtr(uint16_t groupIndex, uint16_t subBlockIndex);
-    void setClaimed(byte_t * freeList, uint16_t subBlockIndex);
-    void setFree(byte_t * freeList, uint16_t subBlockIndex);
+    // returns false if another thread claimed it first
+    bool setClaimed(uint64_t * freeList, uint16_t subBlockIndex);
+    void setFree(uint64_t * freeList, uint16_t subBlockIndex);
     void setAllFree();
     void setAllFreeInGroup(uint16_t groupIndex);
+    // update live counts, here and on primary
+    void trackAlloc(uint8_t groupIndex);
+    void trackFree(uint8_t groupIndex);
     void printInfo();
 
     #if DEBUG
@@ -90,8 +147,12 @@ private:
     // pointers to subblock groups. _freeList[0] is pointer to 2-byte freelist, etc.
     // _groupBase[0] is pointer to first sub-block in 2-byte group, etc.
     // nullptr means group of that byte size does not exist.
-    byte_t * _freeList[Max] = {nullptr};
+    uint64_t * _freeList[Max] = {nullptr};
     byte_t * _groupBase[Max] = {nullptr};
+    // group index for each page of groups' data. see top.
+    uint8_t * _pageTable = nullptr;
+    size_t _nPages = 0;
+    uint8_t _pageShift = 0; // log2(_align)
     // subblock counts. _nSubBlocks[0] is number of 2-byte subblocks, etc.
     uint16_t _nSubBlocks[Max] = {0};
     // total data size in bytes (does not include sizeof(FSA))
@@ -99,32 +160,49 @@ private:
     // alignment
     size_t _align = 0;
 
+    // growth. see Setup::slabSize. chains only touched with MemMan locked.
+    size_t _slabSize = 0;
+    FSA * _primary = nullptr;       // slab only. FSA this slab grows
+    FSA * _nextSlab = nullptr;      // slab only. next slab in group chain
+    FSA * _slabs[Max] = {nullptr};  // primary only. first slab of each group
+    uint16_t _nSlabs[Max] = {0};    // primary only
+
+    // stats. _nLive is claimed sub-blocks in this FSA. _nLiveTotal and
+    // _highWater are primary only, and include slabs. updated atomically.
+    uint32_t _nLive[Max] = {0};
+    uint32_t _nLiveTotal[Max] = {0};
+    uint32_t _highWater[Max] = {0};
+
 // STATIC INTERNALS
 private:
+    static constexpr uint8_t NoGroup = 0xff;
+
     static uint16_t constexpr SubBlockByteSize(uint8_t groupIndex) {
         assert(groupIndex < Max && "Index out of range.");
         return (uint16_t)2 << groupIndex;
     }
 
+    static uint16_t constexpr FreeListWordCount(uint16_t nSubBlocks) {
+        return (uint16_t)((nSubBlocks + 63) >> 6);
+    }
+
     static uint16_t constexpr FreeListByteSize(uint16_t nSubBlocks, size_t align = 0) {
-        assert(nSubBlocks == (nSubBlocks & 0xfff8) &&
-            "Number of FSA subblocks must be a multiple of 8.");
         if (nSubBlocks == 0) return 0;
-        return alignSize(((nSubBlocks - 1) >> 3) + 1, align);
+        return alignSize(FreeListWordCount(nSubBlocks) * sizeof(uint64_t), align);
     }
 
+    // smallest group that fits byteSize. floor(log2(byteSize - 1)), 0 for 1-2.
     static uint8_t constexpr IndexForByteSize(uint16_t byteSize) {
         assert(byteSize >= MinBytes && byteSize <= MaxBytes && "Invalid byte size.");
-        byteSize -= 1;
-        int index = 0;
-        while (byteSize >>= 1) ++index;
-        return index;
+        if (byteSize <= 2) return 0;
+        return 31 - __builtin_clz((uint32_t)byteSize - 1);
     }
 
 // DEV INTERFACE
 private:
     #if DEV_INTERFACE
     void editorEditBlock();
+    void editorBenchmark();
     #endif // DEV_INTERFACE
 };
 
@@ -1,10 +1,39 @@
 #include "FSA.h"
+#include <chrono>
+#include <thread>
 #include "../common/imgui_bgfx_glfw/imgui_bgfx_glfw.h"
 #include "../MrManager.h"
 
 using namespace ImGui;
 
 void FSA::editorEditBlock() {
+    if (isSlab()) {
+        TextUnformatted("Growth slab");
+    }
+    else {
+        editorBenchmark();
+
+        // stats, to help size EngineSetup::memManFSA
+        if (BeginTable("Stats", 5)) {
+            TableSetupColumn("Group");
+            TableSetupColumn("Sub-blocks");
+            TableSetupColumn("Live");
+            TableSetupColumn("High-water");
+            TableSetupColumn("Slabs");
+            TableHeadersRow();
+            for (uint16_t fsaGroup = 0; fsaGroup < FSA::Max; ++fsaGroup) {
+                if (subBlockCountForGroup(fsaGroup) == 0) continue;
+                TableNextRow();
+                TableNextColumn(); Text("%d-byte", 1 << (fsaGroup + 1));
+                TableNextColumn(); Text("%d", subBlockCountForGroup(fsaGroup));
+                TableNextColumn(); Text("%u", liveCountForGroup(fsaGroup));
+                TableNextColumn(); Text("%u", highWaterForGroup(fsaGroup));
+                TableNextColumn(); Text("%d", slabCountForGroup(fsaGroup));
+            }
+            EndTable();
+        }
+    }
+
     for (uint16_t fsaGroup = 0; fsaGroup < FSA::Max; ++fsaGroup) {
         uint16_t nSubBlocks = subBlockCountForGroup(fsaGroup);
         if (nSubBlocks == 0) continue;
@@ -40,3 +69,72 @@ void FSA::editorEditBlock() {
         PopID();
     }
 }
+
+/*
+Alloc/free pairs per second for each group, single- and multi-threaded. Runs
+against the live FSA, so sub-blocks already claimed by the app are skipped
+over like they would be in real use.
+Also times an in-place realloc through MemMan, which is mostly the pointer to
+group lookup.
+*/
+void FSA::editorBenchmark() {
+    static constexpr int NThreadCounts = 2;
+    static constexpr int ThreadCounts[NThreadCounts] = {1, 4};
+    static constexpr int Iterations = 100000;
+    // pairs per second, per group, per thread count
+    static double results[Max][NThreadCounts] = {};
+    // nanoseconds per in-place realloc, per group
+    static double reallocNs[Max] = {};
+    static bool didRun = false;
+
+    TextUnformatted("FSA Benchmark:");
+    SameLine();
+    if (Button("Run##FSABenchmark")) {
+        for (uint16_t groupIndex = 0; groupIndex < Max; ++groupIndex) {
+            if (_nSubBlocks[groupIndex] == 0) continue;
+            size_t size = SubBlockByteSize(groupIndex);
+            for (int t = 0; t < NThreadCounts; ++t) {
+                int nThreads = ThreadCounts[t];
+                std::thread threads[ThreadCounts[NThreadCounts-1]];
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < nThreads; ++i) {
+                    threads[i] = std::thread{[this, size]{
+                        for (int j = 0; j < Iterations; ++j) {
+                            if (void * ptr = alloc(size)) {
+                                destroy(ptr);
+                            }
+                        }
+                    }};
+                }
+                for (int i = 0; i < nThreads; ++i) {
+                    threads[i].join();
+                }
+                std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+                results[groupIndex][t] = (double)(nThreads * Iterations) / seconds.count();
+            }
+
+            void * ptr = alloc(size);
+            if (ptr == nullptr) continue;
+            auto start = std::chrono::steady_clock::now();
+            for (int j = 0; j < Iterations; ++j) {
+                ptr = mm.memMan.request({.size = size, .ptr = ptr});
+            }
+            std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+            reallocNs[groupIndex] = ns.count() / Iterations;
+            destroy(ptr);
+        }
+        didRun = true;
+    }
+
+    if (didRun) {
+        for (uint16_t groupIndex = 0; groupIndex < Max; ++groupIndex) {
+            if (_nSubBlocks[groupIndex] == 0) continue;
+            Text("%4d-byte: %d thread %11.0f pairs/s, %d threads %11.0f pairs/s, realloc %5.1f ns",
+                SubBlockByteSize(groupIndex),
+                ThreadCounts[0], results[groupIndex][0],
+                ThreadCounts[1], results[groupIndex][1],
+                reallocNs[groupIndex]
+            );
+        }
+    }
+}
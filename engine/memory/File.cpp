@@ -1,7 +1,12 @@
 #include "File.h"
+#include <assert.h>
 #include <stdarg.h>
 #include <errno.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "mem_utils.h"
 
 File::Path::Path() {
@@ -33,12 +38,18 @@ bool File::Path::isSet() const {
 size_t File::size() const { return _size; }
 size_t File::head() const { return _head; }
 size_t File::fileSize() const { return _size - 1; }
-byte_t * File::data() const { return (byte_t *)this + alignSize(sizeof(File), _align); }
+byte_t * File::data() const { return (_mapped) ? _mapped : (byte_t *)this + alignSize(sizeof(File), _align); }
 byte_t * File::dataHead() const { return data() + _head; }
 bool File::loaded() const { return _loaded; }
 File::Path const & File::path() const { return _path; }
+bool File::mapped() const { return _mapped; }
 
 bool File::load(FILE * externalFP) {
+    if (_mapped) {
+        fprintf(stderr, "File \"%s\" is mapped, not loading.\n", _path.full);
+        return false;
+    }
+
     FILE * fp;
 
     // if file was already open, user might have passed in a file pointer
@@ -82,3 +93,47 @@ bool File::load(FILE * externalFP) {
     _loaded = true;
     return true;
 }
+
+bool File::map() {
+    assert(_mapped == nullptr && "File already mapped.");
+
+    errno = 0;
+    int fd = open(_path.full, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Error opening file \"%s\" for mapping: %d\n", _path.full, errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        fprintf(stderr, "Error getting size of file \"%s\" for mapping: %d\n", _path.full, errno);
+        close(fd);
+        return false;
+    }
+
+    // private: writes (eg. tokenizing JSON in place) go to copied pages,
+    // never the file
+    void * mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // mapping holds its own reference to the file
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        fprintf(stderr, "Error mapping file \"%s\": %d\n", _path.full, errno);
+        return false;
+    }
+    posix_madvise(mapped, (size_t)st.st_size, POSIX_MADV_WILLNEED);
+
+    _mapped = (byte_t *)mapped;
+    // keep size() as file size + 1, like a loaded file
+    _size = (size_t)st.st_size + 1;
+    _loaded = true;
+    return true;
+}
+
+void File::unmap() {
+    if (_mapped == nullptr) {
+        return;
+    }
+    munmap(_mapped, fileSize());
+    _mapped = nullptr;
+    _loaded = false;
+}
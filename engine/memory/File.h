@@ -7,6 +7,11 @@
 Designed to be used within pre-allocated memory.
 Expects `_size` bytes of pre-allocated (safe) memory directly after its own instance.
 
+Alternatively the file can be memory-mapped (map()), then data() points at the
+mapping and no memory is needed after the instance. The mapping is private
+copy-on-write, so contents can be written to without changing the file, and
+only written pages are copied.
+
 Read only for now
 
 */
@@ -14,6 +19,7 @@ Read only for now
 class File {
 private:
     friend class MemMan;
+    friend class FileIO;
     File(size_t size, char const * path, size_t align = 0) :
         _size(size),
         _path(path),
@@ -36,6 +42,7 @@ public:
     };
 
     // data size is one bigger than actual file size. 0x00 byte written at end.
+    // (not when mapped)
     size_t size() const;
     size_t head() const;
     size_t fileSize() const;
@@ -46,7 +53,13 @@ public:
 
     bool load(FILE * externalFP = nullptr);
 
+    // map instead of load. mapping lasts until unmap(), or the block is released.
+    bool map();
+    void unmap();
+    bool mapped() const;
+
 private:
+    byte_t * _mapped = nullptr;
     size_t _size = 0;
     size_t _head = 0;
     size_t _align = 0; // ensure data() (aka actual file contents) are aligned to this
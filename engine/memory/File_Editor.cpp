@@ -12,12 +12,18 @@ void File::editorCreate() {
     Checkbox("Load in high memory", &loadHigh);
     SameLine();
 
+    static bool mapFile = false;
+    Checkbox("Map", &mapFile);
+    SameLine();
+
     if (Button("Choose File")) {
         nfdchar_t * outPath = NULL;
         nfdresult_t result = NFD_OpenDialog(NULL, "/Users/Shared/Dev/test_assets", &outPath);
 
         if (result == NFD_OKAY) {
-            File * file = mm.memMan.createFileHandle(outPath, false, {.high=loadHigh});
+            File * file = (mapFile) ?
+                mm.memMan.createFileMapping(outPath) :
+                mm.memMan.createFileHandle(outPath, false, {.high=loadHigh});
             free(outPath);
             if (file) {
                 mm.memMan.addTestAlloc(file, "File: %s", file->_path.filename);
@@ -33,6 +39,10 @@ void File::editorCreate() {
 
 void File::editorEditBlock() {
     TextUnformatted(_path.full);
+    if (_mapped) {
+        Text("%zu bytes mapped at %p", fileSize(), _mapped);
+        return;
+    }
     Text("%zu bytes in memory (filesize + null byte)", _size);
     char const * buttonStr = (_loaded) ? "Reload###load" : "Load###load";
     if (Button(buttonStr)) {
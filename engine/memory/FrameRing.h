@@ -0,0 +1,104 @@
+#pragma once
+#include <string.h>
+#include "../common/debug_defines.h"
+#include "../common/types.h"
+#include "mem_utils.h"
+
+/*
+
+Multi-frame FrameStack.
+
+Designed to be used within pre-allocated memory, like inside a MemMan block.
+Expects `_size` bytes of pre-allocated (safe) memory directly after its own instance.
+
+Split into BucketCount equal buckets, each a bump allocator like FrameStack.
+An allocation with lifetime N (0 = until end of current frame) bumps the head
+of bucket (frame + N) % BucketCount. At the end of every frame, the bucket of
+that frame has outlived all its allocations and is reset in one go. No
+per-allocation tracking, so free is a no-op and lifetimes up to MaxLifetime
+are supported.
+
+Not thread-safe. MemMan only uses it with its main mutex locked.
+
+FrameRing data structure (within a MemMan block):
+            data() start
+            v
+|__________||________________|________________|________________|________________|
+FrameRing    bucket 0         bucket 1         bucket 2         bucket 3
+(class       ^                ^
+storage)     _heads[0] from   _heads[1] from
+             here             here
+*/
+
+class FrameRing {
+// TYPES AND STATICS
+public:
+    static constexpr size_t BucketCount = 4;
+    static constexpr int MaxLifetime = BucketCount - 1;
+
+// INIT
+private:
+    friend class MemMan;
+    FrameRing(size_t size) :
+        _size(size),
+        _bucketSize(size / BucketCount)
+    {
+    }
+
+// PUBLIC INTERFACE
+public:
+    size_t size() const { return _size; }
+    size_t bucketSize() const { return _bucketSize; }
+    size_t bucketHead(size_t bucket) const { return _heads[bucket]; }
+    size_t frame() const { return _frame; }
+    byte_t * data() const { return (byte_t *)this + sizeof(FrameRing); }
+    byte_t * bucketData(size_t bucket) const { return data() + bucket * _bucketSize; }
+
+    bool containsPtr(void * ptr) const {
+        return (ptr >= data() && ptr < data() + _bucketSize * BucketCount);
+    }
+
+    // bytes from ptr to head of its bucket. at least the size of the
+    // allocation at ptr, which isn't tracked.
+    size_t bytesToHead(void * ptr) const {
+        size_t offset = (byte_t *)ptr - data();
+        size_t bucket = offset / _bucketSize;
+        return _heads[bucket] - (offset - bucket * _bucketSize);
+    }
+
+// INTERNALS
+private:
+    // returns nullptr if lifetime not supported or bucket is full
+    void * alloc(size_t size, size_t align, int lifetime) {
+        if (lifetime < 0 || lifetime > MaxLifetime) return nullptr;
+        size_t bucket = (_frame + lifetime) % BucketCount;
+        byte_t * base = bucketData(bucket);
+        size_t start = _heads[bucket] + alignPadding((size_t)(base + _heads[bucket]), align);
+        if (start + size > _bucketSize) return nullptr;
+        _heads[bucket] = start + size;
+        return base + start;
+    }
+
+    // release all allocations that were set to expire this frame
+    void endFrame() {
+        size_t bucket = _frame % BucketCount;
+        #if DEBUG
+        memset(bucketData(bucket), 0, _heads[bucket]);
+        #endif // DEBUG
+        _heads[bucket] = 0;
+        ++_frame;
+    }
+
+// STORAGE
+private:
+    size_t _size = 0;
+    size_t _bucketSize = 0;
+    size_t _heads[BucketCount] = {0};
+    size_t _frame = 0;
+
+// DEV INTERFACE
+private:
+    #if DEV_INTERFACE
+    void editorEditBlock();
+    #endif // DEV_INTERFACE
+};
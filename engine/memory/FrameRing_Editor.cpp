@@ -0,0 +1,25 @@
+#include "FrameRing.h"
+#include "../common/imgui_bgfx_glfw/imgui_bgfx_glfw.h"
+#include "../MrManager.h"
+
+#if DEV_INTERFACE
+
+using namespace ImGui;
+
+void FrameRing::editorEditBlock() {
+    Text("FrameRing, %zu buckets of %s, frame %zu",
+        BucketCount,
+        mm.frameByteSizeStr(bucketSize()),
+        frame()
+    );
+    for (size_t bucket = 0; bucket < BucketCount; ++bucket) {
+        Text("bucket %zu (expires in %zu frames): %s",
+            bucket,
+            (bucket + BucketCount - frame() % BucketCount) % BucketCount,
+            mm.frameByteSizeStr(bucketHead(bucket))
+        );
+        ProgressBar((float)bucketHead(bucket) / (float)bucketSize());
+    }
+}
+
+#endif // DEV_INTERFACE
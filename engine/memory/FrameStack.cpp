@@ -0,0 +1,217 @@
+#include "FrameStack.h"
+#include <string.h>
+#if DEBUG
+#include <stdlib.h>
+#include <thread>
+#include "../dev/print.h"
+#endif // DEBUG
+
+thread_local FrameStack::Pen FrameStack::_pen;
+
+byte_t * FrameStack::dataHead() const {
+    // claiming nothing, but makes sure calling thread has a pen
+    return const_cast<FrameStack *>(this)->reserve(0);
+}
+
+void FrameStack::terminatePen() {
+    char * end = (char *)reserve(1);
+    if (end) {
+        *end = '\0';
+    }
+}
+
+char * FrameStack::vformatStr(char const * fmt, va_list args) {
+    return vformat(fmt, args, true);
+}
+
+char * FrameStack::vformatPen(char const * fmt, va_list args) {
+    return vformat(fmt, args, false);
+}
+
+void FrameStack::reset() {
+    _head.store(0, std::memory_order_relaxed);
+    _generation.fetch_add(1, std::memory_order_release);
+}
+
+byte_t * FrameStack::reserve(size_t size) {
+    Pen * pen = threadPen();
+
+    // big allocations skip the pen, so pens aren't used up by them
+    if (pen == nullptr || size > _penSize / 4) {
+        return reserveShared(size);
+    }
+
+    // carve a new pen. last byte of each pen is kept back, so a pen string in
+    // progress can always be terminated when it runs out of room.
+    if (pen->head == nullptr || (size_t)(pen->end - pen->head) < size) {
+        byte_t * newPen = reserveShared(_penSize);
+        if (newPen == nullptr) {
+            return reserveShared(size);
+        }
+        if (pen->head) {
+            *pen->end = '\0';
+        }
+        pen->head = newPen;
+        pen->end = newPen + _penSize - 1;
+    }
+
+    byte_t * ret = pen->head;
+    pen->head += size;
+    return ret;
+}
+
+byte_t * FrameStack::reserveShared(size_t size) {
+    size_t start = _head.fetch_add(size, std::memory_order_relaxed);
+    if (start + size > _size) {
+        // give it back if nothing else was claimed since. nothing was written
+        // either way.
+        size_t expected = start + size;
+        _head.compare_exchange_strong(expected, start, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return data() + start;
+}
+
+char * FrameStack::vformat(char const * fmt, va_list args, bool terminated) {
+    // format into a local buffer first to learn the length, so space can be
+    // claimed before writing. most strings fit, and only format once.
+    char buf[256];
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    int written = vsnprintf(buf, sizeof(buf), fmt, args);
+
+    assert(written >= 0 && "Problem with formatStr");
+    if (written < 0) {
+        va_end(argsCopy);
+        return nullptr;
+    }
+
+    // always claim the null-byte, as vsnprintf writes it
+    size_t claimSize = (size_t)written + 1;
+    char * str = (char *)reserve(claimSize);
+    if (str == nullptr) {
+        va_end(argsCopy);
+        fprintf(stderr, "FrameStack full, could not format %zu bytes.\n", claimSize);
+        return nullptr;
+    }
+    if ((size_t)written < sizeof(buf)) {
+        memcpy(str, buf, claimSize);
+    }
+    else {
+        vsnprintf(str, claimSize, fmt, argsCopy);
+    }
+    va_end(argsCopy);
+
+    // pen: give back the null-byte, so next call continues the string. only
+    // possible if nothing was claimed after us.
+    if (!terminated) {
+        byte_t * end = (byte_t *)str + claimSize;
+        Pen * pen = threadPen();
+        if (pen && pen->head == end) {
+            --pen->head;
+        }
+        else {
+            size_t expected = end - data();
+            _head.compare_exchange_strong(expected, expected - 1, std::memory_order_relaxed);
+        }
+    }
+
+    return str;
+}
+
+FrameStack::Pen * FrameStack::threadPen() {
+    if (_penSize == 0) {
+        return nullptr;
+    }
+    uint32_t generation = _generation.load(std::memory_order_acquire);
+    if (_pen.owner != this || _pen.generation != generation) {
+        _pen = {};
+        _pen.owner = this;
+        _pen.generation = generation;
+    }
+    return &_pen;
+}
+
+#if DEBUG
+bool FrameStack::test(int nThreads, int iterations) {
+    class Region {
+    public:
+        byte_t * ptr;
+        size_t size;
+        byte_t fill; // 0 for formatted string
+        int thread;
+        int iteration;
+    };
+
+    reset();
+
+    size_t nRegions = (size_t)nThreads * iterations;
+    Region * regions = (Region *)calloc(nRegions, sizeof(Region));
+    std::thread * threads = new std::thread[nThreads];
+    for (int t = 0; t < nThreads; ++t) {
+        threads[t] = std::thread{[this, t, iterations, regions]{
+            for (int i = 0; i < iterations; ++i) {
+                Region & r = regions[(size_t)t * iterations + i];
+                r.thread = t;
+                r.iteration = i;
+                if (i % 3 == 0) {
+                    char * str = formatStr("%d:%d", t, i);
+                    if (str == nullptr) continue;
+                    r.ptr = (byte_t *)str;
+                    r.size = strlen(str) + 1;
+                }
+                else {
+                    r.size = 1 + (i * 31 + t * 7) % 200;
+                    r.fill = (byte_t)(t % 255 + 1);
+                    r.ptr = alloc(r.size);
+                    if (r.ptr == nullptr) continue;
+                    memset(r.ptr, r.fill, r.size);
+                }
+            }
+        }};
+    }
+    for (int t = 0; t < nThreads; ++t) {
+        threads[t].join();
+    }
+    delete [] threads;
+
+    // every region still holds what its thread wrote
+    bool success = true;
+    size_t nChecked = 0;
+    char expect[32];
+    for (size_t i = 0; i < nRegions && success; ++i) {
+        Region & r = regions[i];
+        if (r.ptr == nullptr) continue;
+        if (r.ptr < data() || r.ptr + r.size > data() + _size) {
+            fprintf(stderr, "FrameStack test: region out of range.\n");
+            success = false;
+        }
+        else if (r.fill) {
+            for (size_t b = 0; b < r.size; ++b) {
+                if (r.ptr[b] != r.fill) {
+                    fprintf(stderr, "FrameStack test: region overwritten (thread %d, iteration %d).\n",
+                        r.thread, r.iteration);
+                    success = false;
+                    break;
+                }
+            }
+        }
+        else {
+            snprintf(expect, sizeof(expect), "%d:%d", r.thread, r.iteration);
+            if (strcmp(expect, (char *)r.ptr) != 0) {
+                fprintf(stderr, "FrameStack test: string overwritten (thread %d, iteration %d).\n",
+                    r.thread, r.iteration);
+                success = false;
+            }
+        }
+        ++nChecked;
+    }
+
+    printl("FrameStack test %s: %d threads, %zu regions checked, pen size %zu",
+        success ? "passed" : "FAILED", nThreads, nChecked, _penSize);
+
+    free(regions);
+    reset();
+    return success;
+}
+#endif // DEBUG
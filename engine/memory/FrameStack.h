@@ -2,11 +2,23 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <assert.h>
+#include <atomic>
+#include "../common/debug_defines.h"
+#include "../common/types.h"
 
 /*
 Designed to be used within pre-allocated memory, like inside a MemMan block.
 Not exactly a stack. Because it accepts any type, it can't really "pop", just reset.
 Expects `_size` bytes of pre-allocated (safe) memory directly after its own instance.
+
+Safe to allocate from any thread. _head is advanced with an atomic fetch-add.
+
+Optionally (setThreadPenSize) each thread carves a "pen" of _penSize bytes
+off the shared head and allocates from that without any atomics, only going
+back to the shared head when it runs out. dataHead() and formatPen() then
+work per thread, so a multi-call formatPen string stays contiguous even while
+other threads write. A pen string that outgrows its pen is truncated at the
+end of it. reset() invalidates all pens.
 */
 
 class FrameStack {
@@ -21,17 +33,23 @@ private:
 public:
     size_t size() const { return _size; }
     size_t totalSize() const { return sizeof(FrameStack) + _size; }
-    size_t head() const { return _head; }
+    // shared head. includes the whole of any carved pens.
+    size_t head() const {
+        size_t head = _head.load(std::memory_order_relaxed);
+        return (head > _size) ? _size : head;
+    }
     byte_t * data() const { return (byte_t *)this + sizeof(FrameStack); }
-    byte_t * dataHead() const { return data() + _head; }
-    size_t bytesLeft() const { return _size - _head; }
+    // next byte to be allocated by calling thread
+    byte_t * dataHead() const;
+    size_t bytesLeft() const { return _size - head(); }
+
+    // 0 (default) disables pens
+    void setThreadPenSize(size_t penSize) { _penSize = penSize; }
+    size_t threadPenSize() const { return _penSize; }
 
     template <typename T>
     T * alloc(size_t count = 1) {
-        if (_head + sizeof(T) * count > _size) return nullptr;
-        T * ret = (T *)dataHead();
-        _head += sizeof(T) * count;
-        return ret;
+        return (T *)reserve(sizeof(T) * count);
     }
 
     byte_t * alloc(size_t size) {
@@ -53,6 +71,7 @@ public:
     // formatPen(...);
     // formatPen(...);
     // terminatePen(); // str now contains all 3 format calls
+    // Without thread pens, only one thread should be using this at a time.
     char * formatPen(char const * fmt, ...) {
         va_list args;
         va_start(args, fmt);
@@ -62,36 +81,13 @@ public:
     }
 
     // Call after multiple formatPen() calls
-    void terminatePen() {
-        data()[_head] = '\0';
-        ++_head;
-    }
+    void terminatePen();
 
     // do actual work for formatStr
-    char * vformatStr(char const * fmt, va_list args) {
-        char * str = (char *)dataHead();
-        size_t maxChars = _size - _head;
-        int written = vsnprintf(str, maxChars, fmt, args);
-
-        assert(written >= 0 && "Problem with formatStr");
-
-        // vsnprintf writes '\0' to buffer but doesn't count it in return value
-        if (written > 0) _head += written + 1;
-        // vsnprintf won't have written past size, but returns number of chars it WOULD have written, so
-        // head may be past end bound. (but no memory was written there (i think))
-        if (_head > _size) _head = _size;
-        return str;
-    }
+    char * vformatStr(char const * fmt, va_list args);
 
     // do actual work for formatPen
-    char * vformatPen(char const * fmt, va_list args) {
-        size_t prevHead = _head;
-        char * str = vformatStr(fmt, args);
-        if (_head - prevHead > 0) {
-            --_head;
-        }
-        return str;
-    }
+    char * vformatPen(char const * fmt, va_list args);
 
     // write string of known length to buffer
     char * copyStr(char const * str, size_t length) {
@@ -101,9 +97,38 @@ public:
         return formatStr("%s", str);
     }
 
-    void reset() { _head = 0; }
+    void reset();
+
+    #if DEBUG
+    // hammer from nThreads threads at once, checking no regions overlap.
+    // resets the stack. returns false on failure.
+    bool test(int nThreads = 8, int iterations = 5000);
+    #endif // DEBUG
 
 private:
+    // claim size bytes from calling thread's pen, or shared head. returns
+    // nullptr if full.
+    byte_t * reserve(size_t size);
+    // claim size bytes from shared head
+    byte_t * reserveShared(size_t size);
+    // format into claimed memory. terminated: claim the null-byte too.
+    char * vformat(char const * fmt, va_list args, bool terminated);
+
+    class Pen {
+    public:
+        FrameStack const * owner = nullptr;
+        uint32_t generation = 0;
+        byte_t * head = nullptr;
+        byte_t * end = nullptr;
+    };
+    // calling thread's pen, re-carved if stale. nullptr if pens disabled.
+    Pen * threadPen();
+
     size_t _size = 0;
-    size_t _head = 0;
+    std::atomic<size_t> _head{0};
+    size_t _penSize = 0;
+    // bumped on reset, so threads can tell their pen is stale
+    std::atomic<uint32_t> _generation{0};
+    // assumes one pen-enabled FrameStack per thread at a time
+    static thread_local Pen _pen;
 };
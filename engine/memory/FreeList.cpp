@@ -26,20 +26,14 @@ bool FreeList::claim(size_t * foundIndex) {
     if (isFull()) {
         return false;
     }
-    size_t byteIndex = _firstFree / 8;
-    size_t bitIndex =  _firstFree % 8;
-    byte_t mask = (byte_t)1 << bitIndex;
-    data()[byteIndex] |= mask;
+    dataChunks()[_firstFree / 64] |= (uint64_t)1 << (_firstFree % 64);
     _firstFree = findFirstFree(_firstFree + 1);
     return true;
 }
 
 void FreeList::release(size_t index) {
     assert(index < _size && "Out of range.");
-    size_t byteIndex = index / 8;
-    size_t bitIndex =  index % 8;
-    byte_t mask = ((byte_t)1 << bitIndex) ^ 0xff;
-    data()[byteIndex] &= mask;
+    dataChunks()[index / 64] &= ~((uint64_t)1 << (index % 64));
     if (_firstFree > index) {
         _firstFree = index;
     }
@@ -78,34 +72,22 @@ size_t FreeList::size() const { return _size; }
 size_t FreeList::findFirstFree(size_t start) {
     size_t nChunks = _nSlots / 64;
     size_t chunkIndex = start / 64;
-    size_t byteIndex = 0;
-    size_t bitIndex = 0;
 
     for (; chunkIndex < nChunks; ++chunkIndex) {
         uint64_t chunk = dataChunks()[chunkIndex];
 
+        // ignore slots before start in first chunk
+        if (chunkIndex == start / 64) {
+            chunk |= ((uint64_t)1 << (start % 64)) - 1;
+        }
+
         // chunk full (no free slots); move to next chunk
         if (chunk == UINT64_MAX) {
             continue;
         }
 
-        // find non-full byte in chunk
-        byteIndex = 0;
-        while ((chunk & 0xff) == 0xff) {
-            chunk >>= 8;
-            ++byteIndex;
-        }
-
-        // find free bit in byte
-        byte_t byte = chunk & 0xff;
-        bitIndex = 0;
-        while (byte & 1) {
-            byte >>= 1;
-            ++bitIndex;
-        }
-
-        // the real index, which might be beyond size
-        size_t index = (chunkIndex * 64) + (byteIndex * 8) + bitIndex;
+        // LSB is first slot, so lowest clear bit is first free
+        size_t index = (chunkIndex * 64) + __builtin_ctzll(~chunk);
         // never return greater than size
         return (index > _size) ? _size : index;
     }
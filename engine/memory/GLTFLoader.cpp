@@ -2,23 +2,165 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/error/en.h>
+#include <sys/stat.h>
 #include "mem_utils.h"
-#include "../common/file_utils.h"
 #include "../common/Number.h"
-#include "../common/modp_b64.h"
+#include "../common/base64.h"
 #include "../common/string_utils.h"
 #include "../MrManager.h"
 
-// The handler functions corerce strings to uintXX_t types for fast comparison,
-// which makes endianness matter. Since the loader expects a set specification,
-// only the minimal amount of characters are checked.
-#include "../common/endian.h"
-#ifndef IS_LITTLE_ENDIAN
-    #error "GLTFLoader only supports little endian architechtures."
-#endif
-
 #define PRINT_BREADCRUMBS 0
 
+// -------------------------------------------------------------------------- //
+// KEYS
+// -------------------------------------------------------------------------- //
+
+// indexed by GLTFLoader::Key
+static constexpr char const * KeyStrs[] = {
+    "",
+    "accessors",
+    "alphaCutoff",
+    "alphaMode",
+    "animations",
+    "aspectRatio",
+    "asset",
+    "attributes",
+    "baseColorFactor",
+    "baseColorTexture",
+    "buffer",
+    "bufferView",
+    "bufferViews",
+    "buffers",
+    "byteLength",
+    "byteOffset",
+    "byteStride",
+    "camera",
+    "cameras",
+    "channels",
+    "children",
+    "componentType",
+    "copyright",
+    "count",
+    "doubleSided",
+    "emissiveFactor",
+    "emissiveTexture",
+    "generator",
+    "images",
+    "index",
+    "indices",
+    "input",
+    "interpolation",
+    "inverseBindMatrices",
+    "joints",
+    "magFilter",
+    "material",
+    "materials",
+    "matrix",
+    "max",
+    "mesh",
+    "meshes",
+    "metallicFactor",
+    "metallicRoughnessTexture",
+    "mimeType",
+    "min",
+    "minFilter",
+    "minVersion",
+    "mode",
+    "name",
+    "node",
+    "nodes",
+    "normalTexture",
+    "normalized",
+    "occlusionTexture",
+    "orthographic",
+    "output",
+    "path",
+    "pbrMetallicRoughness",
+    "perspective",
+    "primitives",
+    "rotation",
+    "roughnessFactor",
+    "sampler",
+    "samplers",
+    "scale",
+    "scene",
+    "scenes",
+    "skeleton",
+    "skin",
+    "skins",
+    "source",
+    "strength",
+    "target",
+    "targets",
+    "texCoord",
+    "textures",
+    "translation",
+    "type",
+    "uri",
+    "version",
+    "weights",
+    "wrapS",
+    "wrapT",
+    "xmag",
+    "yfov",
+    "ymag",
+    "zfar",
+    "znear",
+};
+static_assert(sizeof(KeyStrs) / sizeof(KeyStrs[0]) == GLTFLoader::NKeys,
+    "KeyStrs must match GLTFLoader::Key.");
+
+static constexpr uint32_t constStrLen(char const * str) {
+    uint32_t length = 0;
+    while (str[length]) ++length;
+    return length;
+}
+
+// FNV-1a, seeded. top bits taken as slot.
+static constexpr uint32_t KeySlotBits = 10;
+static constexpr uint32_t keyHash(char const * str, uint32_t length, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (uint32_t i = 0; i < length; ++i) {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619u;
+    }
+    return hash >> (32 - KeySlotBits);
+}
+
+// slot -> key. built at compile time by trying seeds until every key lands in
+// its own slot.
+struct KeyTable {
+    uint32_t seed = UINT32_MAX;
+    uint8_t slots[1 << KeySlotBits] = {};
+    uint8_t lengths[GLTFLoader::NKeys] = {};
+};
+
+static constexpr KeyTable makeKeyTable() {
+    KeyTable table{};
+    for (uint32_t key = 1; key < GLTFLoader::NKeys; ++key) {
+        table.lengths[key] = (uint8_t)constStrLen(KeyStrs[key]);
+    }
+    for (uint32_t seed = 0; seed < 1024; ++seed) {
+        for (uint32_t slot = 0; slot < (1 << KeySlotBits); ++slot) {
+            table.slots[slot] = GLTFLoader::KEY_NONE;
+        }
+        bool collided = false;
+        for (uint32_t key = 1; key < GLTFLoader::NKeys && !collided; ++key) {
+            uint32_t slot = keyHash(KeyStrs[key], table.lengths[key], seed);
+            collided = (table.slots[slot] != GLTFLoader::KEY_NONE);
+            table.slots[slot] = (uint8_t)key;
+        }
+        if (!collided) {
+            table.seed = seed;
+            return table;
+        }
+    }
+    return table;
+}
+
+static constexpr KeyTable Keys = makeKeyTable();
+static_assert(Keys.seed != UINT32_MAX, "No perfect hash seed found for GLTF keys.");
+
 // -------------------------------------------------------------------------- //
 // COUNTER
 // -------------------------------------------------------------------------- //
@@ -29,42 +171,80 @@ bool GLTFLoader::Counter::Int(int i) { return true; }
 bool GLTFLoader::Counter::Int64(int64_t i) { return true; }
 bool GLTFLoader::Counter::Uint64(uint64_t i) { return true; }
 bool GLTFLoader::Counter::Double(double d) { return true; }
-bool GLTFLoader::Counter::RawNumber(char const * str, uint32_t length, bool copy) { return true; }
+
+// only when replaying tape. text parse of counter gets Uint instead.
+bool GLTFLoader::Counter::RawNumber(char const * str, uint32_t length, bool copy) {
+    if (l->crumb(-1).matches(TYPE_ARR, KEY_BUFFERS) &&
+        l->_keyId == KEY_BYTE_LENGTH
+    ) {
+        return Uint(Number{str, length});
+    }
+    return true;
+}
 
 bool GLTFLoader::Counter::Uint(unsigned i) {
-    if (l->crumb(-1).matches(TYPE_ARR, "buffers") &&
-        strEqu(l->_key, "byteLength")
+    if (l->crumb(-1).matches(TYPE_ARR, KEY_BUFFERS) &&
+        l->_keyId == KEY_BYTE_LENGTH &&
+        !(l->_isBinary && l->_binInPlace && l->crumb().index == 0)
     ) {
         l->_counts.rawDataLen += i;
     }
     return true;
 }
 
-bool GLTFLoader::Counter::String(char const * str, uint32_t length, bool copy) {
-    // name strings (except scene, which requires name, so has char array)
-    if (strEqu(l->_key, "name") &&
-        l->crumb(-1).matches(TYPE_ARR,
-            "accessors|animations|buffers|bufferViews|cameras|images|materials|"
-            "meshes|nodes|samplers|skins|textures")
+// arrays of objects with name strings (except scene, which requires name, so
+// has char array)
+static bool hasNamedElements(GLTFLoader::Key key) {
+    switch (key) {
+    case GLTFLoader::KEY_ACCESSORS:
+    case GLTFLoader::KEY_ANIMATIONS:
+    case GLTFLoader::KEY_BUFFERS:
+    case GLTFLoader::KEY_BUFFER_VIEWS:
+    case GLTFLoader::KEY_CAMERAS:
+    case GLTFLoader::KEY_IMAGES:
+    case GLTFLoader::KEY_MATERIALS:
+    case GLTFLoader::KEY_MESHES:
+    case GLTFLoader::KEY_NODES:
+    case GLTFLoader::KEY_SAMPLERS:
+    case GLTFLoader::KEY_SKINS:
+    case GLTFLoader::KEY_TEXTURES:
+        return true;
+    default:
+        return false;
+    }
+}
 
+bool GLTFLoader::Counter::String(char const * str, uint32_t length, bool copy) {
+    // name strings
+    if (l->_keyId == KEY_NAME &&
+        l->crumb(-1).matches(TYPE_ARR) &&
+        hasNamedElements(l->crumb(-1).keyId)
     ) {
         l->_counts.allStrLen += length + 1;
     }
 
     // asset strings
     else if (
-        l->crumb().matches(TYPE_OBJ, "asset") &&
-        strWithin(l->_key, "copyright|generator|version|minVersion", '|')
+        l->crumb().matches(TYPE_OBJ, KEY_ASSET) &&
+        (l->_keyId == KEY_COPYRIGHT || l->_keyId == KEY_GENERATOR ||
+        l->_keyId == KEY_VERSION || l->_keyId == KEY_MIN_VERSION)
     ) {
         l->_counts.allStrLen += length + 1;
     }
 
-    // image URIs
+    // image URIs. data URIs get decoded into raw data instead.
     else if (
-        l->crumb(-1).matches(TYPE_ARR, "images") &&
-        strEqu(l->_key, "uri")
+        l->crumb(-1).matches(TYPE_ARR, KEY_IMAGES) &&
+        l->_keyId == KEY_URI
     ) {
-        l->_counts.allStrLen += length + 1;
+        size_t b64Len = length;
+        char const * b64 = base64DataURI(str, &b64Len);
+        if (b64) {
+            l->_counts.rawDataLen += (uint32_t)base64DecodedSize(b64, b64Len);
+        }
+        else {
+            l->_counts.allStrLen += length + 1;
+        }
     }
 
     return true;
@@ -77,19 +257,19 @@ bool GLTFLoader::Counter::StartObject() {
 }
 
 bool GLTFLoader::Counter::Key(char const * str, uint32_t length, bool copy) {
-    snprintf(l->_key, MaxKeyLen, "%.*s", length, str);
+    l->setKey(str, length);
     return true;
 }
 
 bool GLTFLoader::Counter::EndObject(uint32_t memberCount) {
     if (
-        (l->crumb(-4).matches(TYPE_ARR, "meshes") &&
-        l->crumb(-2).matches("primitives") &&
-        l->crumb().matches("attributes"))
+        (l->crumb(-4).matches(TYPE_ARR, KEY_MESHES) &&
+        l->crumb(-2).matches(KEY_PRIMITIVES) &&
+        l->crumb().matches(KEY_ATTRIBUTES))
         ||
-        (l->crumb(-5).matches(TYPE_ARR, "meshes") &&
-        l->crumb(-3).matches("primitives") &&
-        l->crumb(-1).matches("targets"))
+        (l->crumb(-5).matches(TYPE_ARR, KEY_MESHES) &&
+        l->crumb(-3).matches(KEY_PRIMITIVES) &&
+        l->crumb(-1).matches(KEY_TARGETS))
     ) {
         l->_counts.meshAttributes += memberCount;
     }
@@ -106,46 +286,51 @@ bool GLTFLoader::Counter::EndArray(uint32_t elementCount) {
     Crumb & crumb = l->crumb();
     // count the main sub-objects
     if (l->_depth == 2) {
-        if      (crumb.matches("accessors"  )) { l->_counts.accessors   = elementCount; }
-        else if (crumb.matches("animations" )) { l->_counts.animations  = elementCount; }
-        else if (crumb.matches("buffers"    )) { l->_counts.buffers     = elementCount; }
-        else if (crumb.matches("bufferViews")) { l->_counts.bufferViews = elementCount; }
-        else if (crumb.matches("cameras"    )) { l->_counts.cameras     = elementCount; }
-        else if (crumb.matches("images"     )) { l->_counts.images      = elementCount; }
-        else if (crumb.matches("materials"  )) { l->_counts.materials   = elementCount; }
-        else if (crumb.matches("meshes"     )) { l->_counts.meshes      = elementCount; }
-        else if (crumb.matches("nodes"      )) { l->_counts.nodes       = elementCount; }
-        else if (crumb.matches("samplers"   )) { l->_counts.samplers    = elementCount; }
-        else if (crumb.matches("scenes"     )) { l->_counts.scenes      = elementCount; }
-        else if (crumb.matches("skins"      )) { l->_counts.skins       = elementCount; }
-        else if (crumb.matches("textures"   )) { l->_counts.textures    = elementCount; }
-    }
-    // node children and scene children
+        switch (crumb.keyId) {
+        case KEY_ACCESSORS:    { l->_counts.accessors   = elementCount; break; }
+        case KEY_ANIMATIONS:   { l->_counts.animations  = elementCount; break; }
+        case KEY_BUFFERS:      { l->_counts.buffers     = elementCount; break; }
+        case KEY_BUFFER_VIEWS: { l->_counts.bufferViews = elementCount; break; }
+        case KEY_CAMERAS:      { l->_counts.cameras     = elementCount; break; }
+        case KEY_IMAGES:       { l->_counts.images      = elementCount; break; }
+        case KEY_MATERIALS:    { l->_counts.materials   = elementCount; break; }
+        case KEY_MESHES:       { l->_counts.meshes      = elementCount; break; }
+        case KEY_NODES:        { l->_counts.nodes       = elementCount; break; }
+        case KEY_SAMPLERS:     { l->_counts.samplers    = elementCount; break; }
+        case KEY_SCENES:       { l->_counts.scenes      = elementCount; break; }
+        case KEY_SKINS:        { l->_counts.skins       = elementCount; break; }
+        case KEY_TEXTURES:     { l->_counts.textures    = elementCount; break; }
+        default: {}
+        }
+    }
+    // node children, scene children and skin joints
     else if (
         l->_depth == 4 &&
-        ((crumb.matches("nodes") && l->crumb(-2).matches("scenes"))
+        ((crumb.matches(KEY_NODES) && l->crumb(-2).matches(KEY_SCENES))
         ||
-        (crumb.matches("children") && l->crumb(-2).matches("nodes")))
+        (crumb.matches(KEY_CHILDREN) && l->crumb(-2).matches(KEY_NODES))
+        ||
+        (crumb.matches(KEY_JOINTS) && l->crumb(-2).matches(KEY_SKINS)))
     ) {
         l->_counts.nodeChildren += elementCount;
     }
     // animation channels and samplers
-    else if (l->_depth == 4 && l->crumb(-2).matches("animations")) {
-        if      (crumb.matches("channels")) { l->_counts.animationChannels += elementCount; }
-        else if (crumb.matches("samplers")) { l->_counts.animationSamplers += elementCount; }
+    else if (l->_depth == 4 && l->crumb(-2).matches(KEY_ANIMATIONS)) {
+        if      (crumb.matches(KEY_CHANNELS)) { l->_counts.animationChannels += elementCount; }
+        else if (crumb.matches(KEY_SAMPLERS)) { l->_counts.animationSamplers += elementCount; }
     }
     // mesh primitives and weights
-    else if (l->_depth == 4 && l->crumb(-2).matches("meshes")) {
-        if      (crumb.matches("primitives")) { l->_counts.meshPrimitives += elementCount; }
-        else if (crumb.matches("weights")) { l->_counts.meshWeights += elementCount; }
+    else if (l->_depth == 4 && l->crumb(-2).matches(KEY_MESHES)) {
+        if      (crumb.matches(KEY_PRIMITIVES)) { l->_counts.meshPrimitives += elementCount; }
+        else if (crumb.matches(KEY_WEIGHTS)) { l->_counts.meshWeights += elementCount; }
     }
-    else if (l->crumb(-4).matches(TYPE_ARR, "meshes") &&
-        l->crumb(-2).matches(TYPE_ARR, "primitives") &&
-        l->crumb().matches(TYPE_ARR, "targets"))
+    else if (l->crumb(-4).matches(TYPE_ARR, KEY_MESHES) &&
+        l->crumb(-2).matches(TYPE_ARR, KEY_PRIMITIVES) &&
+        l->crumb().matches(TYPE_ARR, KEY_TARGETS))
     {
         l->_counts.meshTargets += elementCount;
     }
-    else if (l->_depth == 4 && l->crumb(-2).matches("nodes") && crumb.matches("weights")) {
+    else if (l->_depth == 4 && l->crumb(-2).matches(KEY_NODES) && crumb.matches(KEY_WEIGHTS)) {
         l->_counts.nodeWeights += elementCount;
     }
     l->pop();
@@ -217,7 +402,7 @@ bool GLTFLoader::Scanner::StartObject() {
 }
 
 bool GLTFLoader::Scanner::Key(char const * str, uint32_t length, bool copy) {
-    snprintf(l->_key, MaxKeyLen, "%.*s", length, str);
+    l->setKey(str, length);
     return true;
 }
 
@@ -252,6 +437,43 @@ bool GLTFLoader::Scanner::EndArray(uint32_t elementCount) {
     return true;
 }
 
+// -------------------------------------------------------------------------- //
+// TOKENIZER
+// -------------------------------------------------------------------------- //
+
+// parsed with kParseNumbersAsStringsFlag, so these never get called
+bool GLTFLoader::Tokenizer::Int(int i) { return false; }
+bool GLTFLoader::Tokenizer::Int64(int64_t i) { return false; }
+bool GLTFLoader::Tokenizer::Uint64(uint64_t i) { return false; }
+bool GLTFLoader::Tokenizer::Uint(unsigned i) { return false; }
+bool GLTFLoader::Tokenizer::Double(double d) { return false; }
+
+bool GLTFLoader::Tokenizer::Null() { return add(TOKEN_NULL); }
+bool GLTFLoader::Tokenizer::Bool(bool b) { return add(b ? TOKEN_TRUE : TOKEN_FALSE); }
+bool GLTFLoader::Tokenizer::String(char const * str, uint32_t length, bool copy) { return add(TOKEN_STR, str, length); }
+bool GLTFLoader::Tokenizer::RawNumber(char const * str, uint32_t length, bool copy) { return add(TOKEN_NUM, str, length); }
+bool GLTFLoader::Tokenizer::StartObject() { return add(TOKEN_START_OBJ); }
+bool GLTFLoader::Tokenizer::Key(char const * str, uint32_t length, bool copy) { return add(TOKEN_KEY, str, length); }
+bool GLTFLoader::Tokenizer::EndObject(uint32_t memberCount) { return add(TOKEN_END_OBJ, nullptr, memberCount); }
+bool GLTFLoader::Tokenizer::StartArray() { return add(TOKEN_START_ARR); }
+bool GLTFLoader::Tokenizer::EndArray(uint32_t elementCount) { return add(TOKEN_END_ARR, nullptr, elementCount); }
+
+bool GLTFLoader::Tokenizer::add(TokenType type, char const * str, uint32_t length) {
+    if (l->_tapeLength >= l->_tapeCapacity) {
+        fprintf(stderr, "GLTF tape full.\n");
+        return false;
+    }
+    if (length > TokenMaxLength) {
+        fprintf(stderr, "GLTF JSON value too long for tape (%u).\n", length);
+        return false;
+    }
+    // parsed in situ, so strings stay valid in the JSON string
+    uint32_t offset = (str) ? (uint32_t)(str - l->jsonStr()) : 0;
+    l->_tape[l->_tapeLength] = {offset, length, (uint32_t)type};
+    ++l->_tapeLength;
+    return true;
+}
+
 // -------------------------------------------------------------------------- //
 // CRUMB
 // -------------------------------------------------------------------------- //
@@ -259,6 +481,7 @@ bool GLTFLoader::Scanner::EndArray(uint32_t elementCount) {
 GLTFLoader::Crumb::Crumb(ObjType objType, char const * key) {
     this->objType = objType;
     setKey(key);
+    keyId = (key) ? keyFromStr(key, (uint32_t)strlen(key)) : KEY_NONE;
 }
 
 GLTFLoader::Crumb::Crumb() {}
@@ -272,21 +495,14 @@ void GLTFLoader::Crumb::setKey(char const * key) {
     }
 }
 
-bool GLTFLoader::Crumb::matches(char const * key) const {
+bool GLTFLoader::Crumb::matches(Key keyId) const {
     if (objType == TYPE_UNKNOWN) return false;
-    // TODO: unsure of how these key rules should work... simplify this
-    assert(key);
-    // passed null key matches any (no check, always true)
-    if (!key || key[0] == '\0') return true;
-    // always false if Crumb has no key, except true when empty string is passed
-    if (!hasKey()) return strEqu(key, "");
-    // both passed and Crumb key exists, check if passed key contains Crumb key
-    return strWithin(this->key, key, '|');
+    return (this->keyId == keyId);
 }
 
-bool GLTFLoader::Crumb::matches(ObjType objType, char const * key) const {
+bool GLTFLoader::Crumb::matches(ObjType objType, Key keyId) const {
     if (objType != this->objType) return false;
-    return matches(key);
+    return (keyId == KEY_NONE || this->keyId == keyId);
 }
 
 char const * GLTFLoader::Crumb::objTypeStr() const {
@@ -301,7 +517,7 @@ bool GLTFLoader::Crumb::isValid() const { return (objType != TYPE_UNKNOWN); }
 // LOADER PUBLIC INTERFACE
 // -------------------------------------------------------------------------- //
 
-GLTFLoader::GLTFLoader(byte_t const * gltfData, char const * loadingDir) :
+GLTFLoader::GLTFLoader(byte_t * gltfData, char const * loadingDir) :
     _gltfData(gltfData),
     _loadingDir(loadingDir)
 {
@@ -311,6 +527,7 @@ GLTFLoader::GLTFLoader(byte_t const * gltfData, char const * loadingDir) :
     // set loader pointer to json handlers
     _scanner.l = this;
     _counter.l = this;
+    _tokenizer.l = this;
 
     // binary
     if (strEqu((char const *)_gltfData, "glTF", 4)) {
@@ -332,6 +549,64 @@ GLTFLoader::GLTFLoader(byte_t const * gltfData, char const * loadingDir) :
     }
 }
 
+size_t GLTFLoader::tapeSize() {
+    assert(_gltfData && "GLTF data invalid.");
+    if (_tapeCapacity) return sizeof(Token) * _tapeCapacity;
+
+    // every key is followed by a ':', and every other value by a ',', ']' or
+    // '}', or is the whole document. containers also take a token at each end.
+    // structural chars inside strings only make the count larger.
+    char const * json = jsonStr();
+    uint32_t length = jsonStrLength();
+    size_t count = 1;
+    for (uint32_t i = 0; i < length; ++i) {
+        switch (json[i]) {
+        case ']':
+        case '}':
+            ++count; // value it ends
+            [[fallthrough]];
+        case '[':
+        case '{':
+        case ',':
+        case ':':
+            ++count;
+            break;
+        default:
+            break;
+        }
+    }
+    assert(count <= UINT32_MAX && "GLTF JSON too large for tape.");
+    _tapeCapacity = (uint32_t)count;
+    return sizeof(Token) * _tapeCapacity;
+}
+
+bool GLTFLoader::tokenize(void * tape) {
+    assert(_gltfData && "GLTF data invalid.");
+    assert(_tape == nullptr && "GLTF already tokenized.");
+
+    _tape = (Token *)tape;
+    _tapeLength = 0;
+    tapeSize();
+
+    // in situ: strings are unescaped and terminated in place, and numbers are
+    // left where they are, so the tape can point at both.
+    auto ss = rapidjson::InsituStringStream((char *)jsonStr());
+    constexpr static unsigned parseFlags =
+        rapidjson::kParseInsituFlag |
+        rapidjson::kParseStopWhenDoneFlag |
+        rapidjson::kParseNumbersAsStringsFlag;
+    rapidjson::ParseResult result = _reader.Parse<parseFlags>(ss, _tokenizer);
+    if (result.IsError()) {
+        fprintf(stderr, "JSON parse error: %s (%zu)\n",
+            rapidjson::GetParseError_En(result.Code()), result.Offset());
+        // JSON string is already partly modified, text can't be parsed again
+        _tapeLength = 0;
+        _gltfData = nullptr;
+        return false;
+    }
+    return true;
+}
+
 size_t GLTFLoader::calculateSize() {
     assert(_gltfData && "GLTF data invalid.");
 
@@ -342,8 +617,13 @@ size_t GLTFLoader::calculateSize() {
     _counts.allStrLen += prettyJSONSize;
     #endif // DEBUG
 
-    auto ss = rapidjson::StringStream(jsonStr());
-    _reader.Parse<rapidjson::kParseStopWhenDoneFlag>(ss, _counter);
+    if (_tape) {
+        replay(_counter);
+    }
+    else {
+        auto ss = rapidjson::StringStream(jsonStr());
+        _reader.Parse<rapidjson::kParseStopWhenDoneFlag>(ss, _counter);
+    }
     return _counts.totalSize();
 }
 
@@ -352,6 +632,7 @@ bool GLTFLoader::load(Gobj * gobj) {
     assert(_gltfData && "GLTF data invalid.");
 
     _key[0] = '\0';
+    _keyId = KEY_NONE;
     _scanner.g = gobj;
     _nextRawDataPtr = gobj->rawData;
 
@@ -359,25 +640,44 @@ bool GLTFLoader::load(Gobj * gobj) {
     // write pretty JSON into string buffer
     uint32_t length;
     char const * str = prettyJSON(&length);
+    if (str == nullptr) {
+        fprintf(stderr, "Error formatting pretty JSON.\n");
+        return false;
+    }
     gobj->jsonStr = gobj->strings->copyStr(str, length);
     #endif // DEBUG
 
-    auto ss = rapidjson::StringStream(jsonStr());
-    constexpr static unsigned parseFlags =
-        rapidjson::kParseStopWhenDoneFlag |
-        rapidjson::kParseNumbersAsStringsFlag;
-    rapidjson::ParseResult result = _reader.Parse<parseFlags>(ss, _scanner);
-    if (result.IsError()) {
-        fprintf(stderr, "JSON parse error: %s (%zu)\n",
-            rapidjson::GetParseError_En(result.Code()), result.Offset());
+    bool success;
+    if (_tape) {
+        success = replay(_scanner);
+    }
+    else {
+        auto ss = rapidjson::StringStream(jsonStr());
+        constexpr static unsigned parseFlags =
+            rapidjson::kParseStopWhenDoneFlag |
+            rapidjson::kParseNumbersAsStringsFlag;
+        rapidjson::ParseResult result = _reader.Parse<parseFlags>(ss, _scanner);
+        if (result.IsError()) {
+            fprintf(stderr, "JSON parse error: %s (%zu)\n",
+                rapidjson::GetParseError_En(result.Code()), result.Offset());
+        }
+        success = result;
     }
 
+    // buffers have to be filled, and reads can't outlive the load, even if
+    // it failed (the gobj may be released)
+    success = waitPendingReads() && success;
+
     // track count of actual sub-objects populated by loader
     gobj->counts += _counts;
 
     postLoad(gobj);
 
-    return result;
+    return success;
+}
+
+void GLTFLoader::setBinInPlace(bool binInPlace) {
+    _binInPlace = binInPlace;
 }
 
 void GLTFLoader::setCounts(Gobj::Counts const & counts) {
@@ -404,16 +704,30 @@ bool GLTFLoader::validData() const {
 char const * GLTFLoader::prettyJSON(uint32_t * prettyJSONSize) {
     assert(_gltfData && "GLTF data invalid.");
 
+    // PrettyWriter::RawNumber would quote numbers replayed from the tape
+    struct Writer : rapidjson::PrettyWriter<rapidjson::StringBuffer> {
+        using PrettyWriter::PrettyWriter;
+        bool RawNumber(char const * str, uint32_t length, bool copy) {
+            return RawValue(str, length, rapidjson::kNumberType);
+        }
+    };
     rapidjson::StringBuffer sb;
-    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(sb);
+    Writer writer(sb);
 
-    auto ss = rapidjson::StringStream(jsonStr());
-    _reader.Parse(ss, writer);
+    if (_tape) {
+        replay(writer);
+    }
+    else {
+        auto ss = rapidjson::StringStream(jsonStr());
+        _reader.Parse(ss, writer);
+    }
 
     if (prettyJSONSize) {
         *prettyJSONSize = (uint32_t)sb.GetSize() + 1;
     }
-    return mm.frameFormatStr("%s", sb.GetString());
+    // not frameFormatStr, which asserts. big dumps can fill the frame stack
+    // when many are loaded at once, and that fails the load instead.
+    return mm.frameStack->formatStr("%s", sb.GetString());
 }
 #endif // DEBUG
 
@@ -421,6 +735,25 @@ char const * GLTFLoader::prettyJSON(uint32_t * prettyJSONSize) {
 // LOADER INTERNALS
 // -------------------------------------------------------------------------- //
 
+void GLTFLoader::setKey(char const * str, uint32_t length) {
+    uint32_t copyLength = (length < MaxKeyLen) ? length : MaxKeyLen - 1;
+    memcpy(_key, str, copyLength);
+    _key[copyLength] = '\0';
+    _keyId = keyFromStr(str, length);
+}
+
+GLTFLoader::Key GLTFLoader::keyFromStr(char const * str, uint32_t length) {
+    uint8_t key = Keys.slots[keyHash(str, length, Keys.seed)];
+    // unlisted keys can land in any slot, so confirm
+    if (key == KEY_NONE ||
+        Keys.lengths[key] != length ||
+        memcmp(KeyStrs[key], str, length) != 0
+    ) {
+        return KEY_NONE;
+    }
+    return (Key)key;
+}
+
 void GLTFLoader::push(ObjType objType) {
     assert(_depth < MaxDepth && "Can't push crumb.");
 
@@ -442,7 +775,9 @@ void GLTFLoader::push(ObjType objType) {
     newCrumb.objType = objType;
     // set key (copy and reset buffer)
     newCrumb.setKey(_key);
+    newCrumb.keyId = _keyId;
     _key[0] = '\0';
+    _keyId = KEY_NONE;
     // reset everthing
     newCrumb.childCount = 0;
     newCrumb.handleChild = nullptr;
@@ -496,15 +831,65 @@ void GLTFLoader::postLoad(Gobj * g) {
         g->scene->nodes[nodeIndex]->syncMatrixTRS(true);
     }
 
+    // local mesh bounds, for culling
+    g->updateMeshBounds();
+
+    // transforms breadth first, for linear world matrix updates
+    g->flattenNodes();
+
     // update bounds
     g->updateBoundsForCurrentScene();
 }
 
+bool GLTFLoader::waitPendingReads() {
+    bool success = true;
+    for (uint16_t i = 0; i < _nPendingReads; ++i) {
+        if (!mm.io.wait(_pendingReads[i])) {
+            fprintf(stderr, "Error reading buffer file.\n");
+            success = false;
+        }
+    }
+    _nPendingReads = 0;
+    return success;
+}
+
+template <typename Handler>
+bool GLTFLoader::replay(Handler & handler) {
+    char const * json = jsonStr();
+    for (uint32_t i = 0; i < _tapeLength; ++i) {
+        Token const & token = _tape[i];
+        char const * str = json + token.offset;
+        bool success = false;
+        switch (token.type) {
+        case TOKEN_NULL:      { success = handler.Null(); break; }
+        case TOKEN_FALSE:     { success = handler.Bool(false); break; }
+        case TOKEN_TRUE:      { success = handler.Bool(true); break; }
+        case TOKEN_NUM:       { success = handler.RawNumber(str, token.length, false); break; }
+        case TOKEN_STR:       { success = handler.String(str, token.length, false); break; }
+        case TOKEN_KEY:       { success = handler.Key(str, token.length, false); break; }
+        case TOKEN_START_OBJ: { success = handler.StartObject(); break; }
+        case TOKEN_END_OBJ:   { success = handler.EndObject(token.length); break; }
+        case TOKEN_START_ARR: { success = handler.StartArray(); break; }
+        case TOKEN_END_ARR:   { success = handler.EndArray(token.length); break; }
+        default: {}
+        }
+        if (!success) {
+            fprintf(stderr, "GLTF tape replay stopped at token %u.\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
 uint32_t GLTFLoader::jsonStrSize() const {
     assert(_isBinary && "jsonStrSize() not available when _isBinary==false.");
     return *(uint32_t *)(_gltfData + 12);
 }
 
+uint32_t GLTFLoader::jsonStrLength() const {
+    return (_isBinary) ? jsonStrSize() : (uint32_t)strlen(jsonStr());
+}
+
 char const * GLTFLoader::jsonStr() const {
     // returns _gltfData if GLTF,
     // returns _gltfData+20 if GLB
@@ -554,145 +939,69 @@ void GLTFLoader::printBreadcrumbs() const {
 // LOADER JSON PART HANDLERS
 // -------------------------------------------------------------------------- //
 
+std::array<GLTFLoader::HandlerFnSig *, GLTFLoader::NKeys> const GLTFLoader::RootElementHandlers = []{
+    std::array<HandlerFnSig *, NKeys> handlers{};
+    handlers[KEY_ACCESSORS]    = handleAccessor;
+    handlers[KEY_ANIMATIONS]   = handleAnimation;
+    handlers[KEY_BUFFERS]      = handleBuffer;
+    handlers[KEY_BUFFER_VIEWS] = handleBufferView;
+    handlers[KEY_CAMERAS]      = handleCamera;
+    handlers[KEY_IMAGES]       = handleImage;
+    handlers[KEY_MATERIALS]    = handleMaterial;
+    handlers[KEY_MESHES]       = handleMesh;
+    handlers[KEY_NODES]        = handleNode;
+    handlers[KEY_SAMPLERS]     = handleSampler;
+    handlers[KEY_SCENES]       = handleScene;
+    handlers[KEY_SKINS]        = handleSkin;
+    handlers[KEY_TEXTURES]     = handleTexture;
+    return handlers;
+}();
+
 bool GLTFLoader::handleRoot(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     auto & c = l->crumb();
-    switch(*(uint16_t *)c.key) {
-    // accessors
-    case 'a'|'c'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleAccessor;
-            return true;
-        };
-        break; }
+    switch (c.keyId) {
     // asset
-    case 'a'|'s'<<8: {
+    case KEY_ASSET: {
         c.handleChild = handleAsset;
         break; }
-    // animations
-    case 'a'|'n'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleAnimation;
-            return true;
-        };
+    // scene
+    case KEY_SCENE: {
+        g->scene = g->scenes + Number{str, len};
         break; }
-    // buffers|bufferViews
-    case 'b'|'u'<<8: {
-        switch(c.key[6]) {
-        // buffers
-        case 's': {
-            c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-                l->crumb().handleChild = handleBuffer;
-                return true;
-            };
-            break; }
-        // bufferViews
-        case 'V': {
-            c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-                l->crumb().handleChild = handleBufferView;
-                return true;
-            };
-            break; }
+    // accessors, animations, buffers, etc.
+    default: {
+        if (RootElementHandlers[c.keyId]) {
+            c.handleChild = handleRootElement;
         }
         break; }
-    // cameras
-    case 'c'|'a'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleCamera;
-            return true;
-        };
-        break; }
-    // images
-    case 'i'|'m'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleImage;
-            return true;
-        };
-        break; }
-    // materials
-    case 'm'|'a'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleMaterial;
-            return true;
-        };
-        break; }
-    // meshes
-    case 'm'|'e'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleMesh;
-            return true;
-        };
-        break; }
-    // nodes
-    case 'n'|'o'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleNode;
-            return true;
-        };
-        break; }
-    // samplers
-    case 's'|'a'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleSampler;
-            return true;
-        };
-        break; }
-    // scenes
-    case 's'|'c'<<8: {
-        switch (c.key[5]) {
-        case '\0': {
-            g->scene = g->scenes + Number{str, len};
-            break; }
-        case 's': {
-            c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-                l->crumb().handleChild = handleScene;
-                return true;
-            };
-            break; }
-        }
-        break; }
-    // skins
-    case 's'|'k'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleSkin;
-            return true;
-        };
-        break; }
-    // textures
-    case 't'|'e'<<8: {
-        c.handleChild = [](GLTFLoader * l, Gobj *, char const *, uint32_t) {
-            l->crumb().handleChild = handleTexture;
-            return true;
-        };
-        break; }
     }
     return true;
 }
 
+bool GLTFLoader::handleRootElement(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+    l->crumb().handleChild = RootElementHandlers[l->crumb(-1).keyId];
+    return true;
+}
+
 bool GLTFLoader::handleAccessor(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     auto & c = l->crumb();
     Gobj::Accessor * a = g->accessors + l->crumb(-1).index;
     Number n{str, len};
 
-    switch(*(uint16_t *)c.key) {
-    // bufferView
-    case 'b'|'u'<<8: {
+    switch (c.keyId) {
+    case KEY_BUFFER_VIEW: {
         a->bufferView = g->bufferViews + n;
         break; }
-    // byteOffset
-    case 'b'|'y'<<8: {
+    case KEY_BYTE_OFFSET: {
         a->byteOffset = n;
         break; }
-    // componentType|count
-    case 'c'|'o'<<8: {
-        if (c.key[2]=='m') {
-            a->componentType = (Gobj::Accessor::ComponentType)(int)n;
-        }
-        else {
-            a->count = n;
-        }
+    case KEY_COMPONENT_TYPE: {
+        a->componentType = (Gobj::Accessor::ComponentType)(int)n;
+        break; }
+    case KEY_COUNT: {
+        a->count = n;
         break; }
-    // max
-    case 'm'|'a'<<8: {
+    case KEY_MAX: {
         c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
             uint16_t accIndex = l->crumb(-2).index;
             uint16_t maxIndex = l->crumb().index;
@@ -700,8 +1009,7 @@ bool GLTFLoader::handleAccessor(GLTFLoader * l, Gobj * g, char const * str, uint
             return true;
         };
         break; }
-    // min
-    case 'm'|'i'<<8: {
+    case KEY_MIN: {
         c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
             uint16_t accIndex = l->crumb(-2).index;
             uint16_t minIndex = l->crumb().index;
@@ -709,141 +1017,135 @@ bool GLTFLoader::handleAccessor(GLTFLoader * l, Gobj * g, char const * str, uint
             return true;
         };
         break; }
-    // name
-    case 'n'|'a'<<8: {
+    case KEY_NAME: {
         a->name = g->strings->copyStr(str, len);
         break; }
-    // normalized
-    case 'n'|'o'<<8: {
+    case KEY_NORMALIZED: {
         a->normalized = n;
         break; }
-    // type
-    case 't'|'y'<<8: {
+    case KEY_TYPE: {
         a->type = Gobj::accessorTypeFromStr(str);
         break; }
+    default: {}
     }
     return true;
 }
 
 bool GLTFLoader::handleAsset(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-    switch(l->crumb().key[0]) {
-    // copyright
-    case 'c': {  g->copyright  = g->strings->copyStr(str, len); break; }
-    // generator
-    case 'g': {  g->generator  = g->strings->copyStr(str, len); break; }
-    // version
-    case 'v': {  g->version    = g->strings->copyStr(str, len); break; }
-    // minVersion
-    case 'm': {  g->minVersion = g->strings->copyStr(str, len); break; }
+    switch (l->crumb().keyId) {
+    case KEY_COPYRIGHT:   { g->copyright  = g->strings->copyStr(str, len); break; }
+    case KEY_GENERATOR:   { g->generator  = g->strings->copyStr(str, len); break; }
+    case KEY_VERSION:     { g->version    = g->strings->copyStr(str, len); break; }
+    case KEY_MIN_VERSION: { g->minVersion = g->strings->copyStr(str, len); break; }
+    default: {}
     }
     return true;
 }
 
 bool GLTFLoader::handleAnimation(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     auto & c = l->crumb();
-    uint16_t aniIndex = l->crumb(-1).index;
-    switch(*(uint16_t *)c.key) {
-    // channels
-    case 'c'|'h'<<8: {
-        g->animations[aniIndex].channels = g->animationChannels + l->_nextAnimationChannel;
+    Gobj::Animation * ani = g->animations + l->crumb(-1).index;
+    switch (c.keyId) {
+    case KEY_CHANNELS: {
+        ani->channels = g->animationChannels + l->_nextAnimationChannel;
         c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
             l->crumb().handleChild = handleAnimationChannel;
             return true;
         };
-        c.handleEnd = [aniIndex](GLTFLoader * l, Gobj * g, uint32_t count) {
-            g->animations[aniIndex].nChannels = count;
+        c.handleEnd = [](GLTFLoader * l, Gobj * g, uint32_t count) {
+            g->animations[l->crumb(-1).index].nChannels = count;
             l->_nextAnimationChannel += count;
             return true;
         };
         break; }
-    // samplers
-    case 's'|'a'<<8: {
-        g->animations[aniIndex].samplers = g->animationSamplers + l->_nextAnimationSampler;
+    case KEY_SAMPLERS: {
+        ani->samplers = g->animationSamplers + l->_nextAnimationSampler;
         c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
             l->crumb().handleChild = handleAnimationSampler;
             return true;
         };
-        c.handleEnd = [aniIndex](GLTFLoader * l, Gobj * g, uint32_t count) {
-            g->animations[aniIndex].nSamplers = count;
+        c.handleEnd = [](GLTFLoader * l, Gobj * g, uint32_t count) {
+            g->animations[l->crumb(-1).index].nSamplers = count;
             l->_nextAnimationSampler += count;
             return true;
         };
         break; }
-    // name
-    case 'n'|'a'<<8: {
-        g->animations[l->crumb(-1).index].name = g->strings->copyStr(str, len);
+    case KEY_NAME: {
+        ani->name = g->strings->copyStr(str, len);
         break; }
+    default: {}
     }
     return true;
 }
 
 bool GLTFLoader::handleAnimationChannel(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     auto & c = l->crumb();
-    switch (c.key[0]) {
-    // sampler
-    case 's': {
+    switch (c.keyId) {
+    case KEY_SAMPLER: {
         uint16_t aniIndex = l->crumb(-3).index;
         Gobj::AnimationChannel * ac = g->animations[aniIndex].channels + l->crumb(-1).index;
         ac->sampler = g->animations[aniIndex].samplers + Number{str, len};
         break; }
-    // target
-    case 't': {
+    case KEY_TARGET: {
         // handle target object children
         c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-            auto & c = l->crumb();
             uint16_t aniIndex = l->crumb(-4).index;
             Gobj::AnimationChannel * ac = g->animations[aniIndex].channels + l->crumb(-2).index;
-            switch (c.key[0]) {
-            // sampler
-            case 'n': {
+            switch (l->crumb().keyId) {
+            case KEY_NODE: {
                 ac->node = g->nodes + Number{str, len};
                 break; }
-            // path
-            case 'p': {
+            case KEY_PATH: {
                 ac->path = Gobj::animationTargetFromStr(str);
                 break; }
+            default: {}
             }
             return true;
         };
         break; }
+    default: {}
     }
     return true;
 }
 
 bool GLTFLoader::handleAnimationSampler(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-    auto & c = l->crumb();
     uint16_t aniIndex = l->crumb(-3).index;
     Gobj::AnimationSampler * as = g->animations[aniIndex].samplers + l->crumb(-1).index;
-    switch(*(uint32_t *)c.key) {
-    // input
-    case 'i'|'n'<<8|'p'<<16|'u'<<24: {
+    switch (l->crumb().keyId) {
+    case KEY_INPUT: {
         as->input  = g->accessors + Number{str, len};
         break; }
-    // interpolation
-    case 'i'|'n'<<8|'t'<<16|'e'<<24: {
+    case KEY_INTERPOLATION: {
         as->interpolation = Gobj::interpolationFromStr(str);
         break; }
-    // output
-    case 'o'|'u'<<8|'t'<<16|'p'<<24: {
+    case KEY_OUTPUT: {
         as->output = g->accessors + Number{str, len};
         break; }
+    default: {}
     }
     return true;
 }
 
 bool GLTFLoader::handleBuffer(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-    auto & c = l->crumb();
     uint16_t bufIndex = l->crumb(-1).index;
     Gobj::Buffer * buf = g->buffers + bufIndex;
-    switch(c.key[0]) {
-    // uri
-    case 'u': {
+    switch (l->crumb().keyId) {
+    case KEY_URI: {
         // copy data and set byteLength for non-GLB
         if (l->_isBinary) {
             fprintf(stderr, "Unexpected buffer.uri in GLB.\n");
             return false;
         }
-        size_t bytesWritten = l->handleDataString(l->_nextRawDataPtr, l->_loadingDir, str, len);
+        // file reads overlap the rest of the load
+        if (l->_nPendingReads == MaxPendingReads && !l->waitPendingReads()) {
+            return false;
+        }
+        IOHandle * pendingRead = l->_pendingReads + l->_nPendingReads;
+        *pendingRead = {};
+        size_t bytesWritten = l->handleDataString(l->_nextRawDataPtr, l->_loadingDir, str, len, pendingRead);
+        if (pendingRead->isValid()) {
+            ++l->_nPendingReads;
+        }
         if (bytesWritten == 0) {
             fprintf(stderr, "No bytes written in buffer %d.\n", bufIndex);
             return false;
@@ -853,8 +1155,7 @@ bool GLTFLoader::handleBuffer(GLTFLoader * l, Gobj * g, char const * str, uint32
         l->_nextRawDataPtr += bytesWritten;
 
         break; }
-    // byteLength
-    case 'b': {
+    case KEY_BYTE_LENGTH: {
         // copy data and set byteLength for GLB
         if (l->_isBinary && bufIndex == 0) {
             Number n{str, len};
@@ -863,16 +1164,21 @@ bool GLTFLoader::handleBuffer(GLTFLoader * l, Gobj * g, char const * str, uint32
                 fprintf(stderr, "Unexpected buffer size.\n");
                 return false;
             }
-            memcpy(l->_nextRawDataPtr, l->binData(), n);
-            g->buffers[bufIndex].data = l->_nextRawDataPtr;
-            l->_nextRawDataPtr += n;
+            if (l->_binInPlace) {
+                buf->data = (byte_t *)l->binData();
+            }
+            else {
+                memcpy(l->_nextRawDataPtr, l->binData(), n);
+                g->buffers[bufIndex].data = l->_nextRawDataPtr;
+                l->_nextRawDataPtr += n;
+            }
         }
 
         break; }
-    // name
-    case 'n': {
+    case KEY_NAME: {
         buf->name = g->strings->copyStr(str, len);
         break; }
+    default: {}
     }
     return true;
 }
@@ -880,36 +1186,14 @@ bool GLTFLoader::handleBuffer(GLTFLoader * l, Gobj * g, char const * str, uint32
 bool GLTFLoader::handleBufferView(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     uint16_t bvIndex = l->crumb(-1).index;
     Gobj::BufferView * bv = g->bufferViews + bvIndex;
-    auto & c = l->crumb();
-    switch (c.key[0]) {
-    case 'b': {
-        switch (c.key[4]) {
-        // buffer
-        case 'e': {
-            bv->buffer = g->buffers + Number{str, len};
-            break; }
-        // byteLength
-        case 'L': {
-            bv->byteLength = Number{str, len};
-            break; }
-        // byteOffset
-        case 'O': {
-            bv->byteOffset = Number{str, len};
-            break; }
-        // byteStride
-        case 'S': {
-            bv->byteStride = Number{str, len};
-            break; }
-        }
-        break; }
-    // target
-    case 't': {
-        bv->target = (Gobj::BufferView::Target)(int)Number{str, len};
-        break; }
-    // name
-    case 'n': {
-        bv->name = g->strings->copyStr(str, len);
-        break; }
+    switch (l->crumb().keyId) {
+    case KEY_BUFFER:      { bv->buffer = g->buffers + Number{str, len}; break; }
+    case KEY_BYTE_LENGTH: { bv->byteLength = Number{str, len}; break; }
+    case KEY_BYTE_OFFSET: { bv->byteOffset = Number{str, len}; break; }
+    case KEY_BYTE_STRIDE: { bv->byteStride = Number{str, len}; break; }
+    case KEY_TARGET:      { bv->target = (Gobj::BufferView::Target)(int)Number{str, len}; break; }
+    case KEY_NAME:        { bv->name = g->strings->copyStr(str, len); break; }
+    default: {}
     }
     return true;
 }
@@ -917,79 +1201,84 @@ bool GLTFLoader::handleBufferView(GLTFLoader * l, Gobj * g, char const * str, ui
 bool GLTFLoader::handleCamera(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     auto & c = l->crumb();
     Gobj::Camera * cam = g->cameras + l->crumb(-1).index;
-    switch (c.key[0]) {
-    // orthographic
-    case 'o': {
+    switch (c.keyId) {
+    case KEY_ORTHOGRAPHIC: {
         cam->orthographic = (Gobj::CameraOrthographic *)&cam->_data;
-        c.handleChild = [cam](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Camera * cam = g->cameras + l->crumb(-2).index;
             Number n{str, len};
-            switch (*(uint16_t *)l->crumb().key) {
-            // xmag
-            case 'x'|'m'<<8: { cam->_data[0] = n; break; }
-            // ymag
-            case 'y'|'m'<<8: { cam->_data[1] = n; break; }
-            // zfar
-            case 'z'|'f'<<8: { cam->_data[2] = n; break; }
-            // znear
-            case 'z'|'n'<<8: { cam->_data[3] = n; break; }
+            switch (l->crumb().keyId) {
+            case KEY_XMAG:  { cam->_data[0] = n; break; }
+            case KEY_YMAG:  { cam->_data[1] = n; break; }
+            case KEY_ZFAR:  { cam->_data[2] = n; break; }
+            case KEY_ZNEAR: { cam->_data[3] = n; break; }
+            default: {}
             }
             return true;
         };
         break; }
-    // perspective
-    case 'p': {
+    case KEY_PERSPECTIVE: {
         cam->perspective = (Gobj::CameraPerspective *)&cam->_data;
-        c.handleChild = [cam](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Camera * cam = g->cameras + l->crumb(-2).index;
             Number n{str, len};
-            switch (*(uint16_t *)l->crumb().key) {
-            // aspectRatio
-            case 'a'|'s'<<8: { cam->_data[0] = n; break; }
-            // yfov
-            case 'y'|'f'<<8: { cam->_data[1] = n; break; }
-            // zfar
-            case 'z'|'f'<<8: { cam->_data[2] = n; break; }
-            // znear
-            case 'z'|'n'<<8: { cam->_data[3] = n; break; }
+            switch (l->crumb().keyId) {
+            case KEY_ASPECT_RATIO: { cam->_data[0] = n; break; }
+            case KEY_YFOV:         { cam->_data[1] = n; break; }
+            case KEY_ZFAR:         { cam->_data[2] = n; break; }
+            case KEY_ZNEAR:        { cam->_data[3] = n; break; }
+            default: {}
             }
             return true;
         };
         break; }
-    case 't': {
+    case KEY_TYPE: {
         cam->type = Gobj::cameraTypeFromStr(str);
         break; }
-    case 'n': {
+    case KEY_NAME: {
         cam->name = g->strings->copyStr(str, len);
         break; }
+    default: {}
     }
     return true;
 }
 
 bool GLTFLoader::handleImage(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-    auto & c = l->crumb();
     Gobj::Image * img = g->images + l->crumb(-1).index;
-    switch (c.key[0]) {
-    // uri
-    case 'u': {
-        char * buf = g->strings->copyStr(str, len);
-        // urldecode all strings that aren't data. len<8 strings always get decoded.
-        // don't run strEqu if len is not at least 8.
-        if (len < 8 || strEqu(buf, "data:ima", 8) == false) {
-            urldecode2(buf, buf);
+    switch (l->crumb().keyId) {
+    case KEY_URI: {
+        // data URI, decode straight into raw data
+        size_t b64Len = len;
+        char const * b64 = base64DataURI(str, &b64Len);
+        if (b64) {
+            size_t size = base64DecodedSize(b64, b64Len);
+            if (l->_nextRawDataPtr + size > g->rawData + g->maxCounts.rawDataLen) {
+                fprintf(stderr, "Not enough raw data for image %d.\n", l->crumb(-1).index);
+                return false;
+            }
+            if (base64Decode(l->_nextRawDataPtr, b64, b64Len) != size) {
+                fprintf(stderr, "Error decoding data URI of image %d.\n", l->crumb(-1).index);
+                return false;
+            }
+            img->data = l->_nextRawDataPtr;
+            img->dataSize = (uint32_t)size;
+            l->_nextRawDataPtr += size;
+            break;
         }
+        char * buf = g->strings->copyStr(str, len);
+        urldecode2(buf, buf);
         img->uri = buf;
         break; }
-    // mimeType
-    case 'm': {
+    case KEY_MIME_TYPE: {
         img->mimeType = Gobj::imageMIMETypeFromStr(str);
         break; }
-    // bufferView
-    case 'b': {
+    case KEY_BUFFER_VIEW: {
         img->bufferView = g->bufferViews + Number{str, len};
         break; }
-    // name
-    case 'n': {
+    case KEY_NAME: {
         img->name = g->strings->copyStr(str, len);
         break; }
+    default: {}
     }
     return true;
 }
@@ -997,135 +1286,107 @@ bool GLTFLoader::handleImage(GLTFLoader * l, Gobj * g, char const * str, uint32_
 bool GLTFLoader::handleMaterial(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     Gobj::Material * mat = g->materials + l->crumb(-1).index;
     auto & c = l->crumb();
-    switch (c.key[0]) {
-    // alphaMode || alphaCutoff
-    case 'a': {
-        switch (c.key[5]) {
-        case 'M': { mat->alphaMode = Gobj::alphaModeFromStr(str); break; }
-        case 'C': { mat->alphaCutoff = Number{str, len}; break; }
-        }
+    switch (c.keyId) {
+    case KEY_ALPHA_MODE:   { mat->alphaMode = Gobj::alphaModeFromStr(str); break; }
+    case KEY_ALPHA_CUTOFF: { mat->alphaCutoff = Number{str, len}; break; }
+    case KEY_EMISSIVE_TEXTURE: {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Material * mat = g->materials + l->crumb(-2).index;
+            Number n{str, len};
+            switch (l->crumb().keyId) {
+            case KEY_INDEX:     { mat->emissiveTexture = g->textures + n; break; }
+            case KEY_TEX_COORD: { mat->emissiveTexCoord = Gobj::texCoordAttr((int)n); break; }
+            default: {}
+            }
+            return true;
+        };
         break; }
-    // emissiveTexture || emissiveFactor
-    case 'e': {
-        switch (c.key[8]) {
-        // emissiveTexture
-        case 'T': {
-            c.handleChild = [mat](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-                Number n{str, len};
-                switch (l->crumb().key[0]) {
-                // index
-                case 'i': { mat->emissiveTexture = g->textures + n; break; }
-                // texCoord
-                case 't': { mat->emissiveTexCoord = Gobj::texCoordAttr((int)n); break; }
-                }
-                return true;
-            };
-            break; }
-        // emissiveFactor
-        case 'F': {
-            c.handleChild = [mat](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-                mat->emissiveFactor[l->crumb().index] = Number{str, len};
-                return true;
-            };
-            break; }
-        }
+    case KEY_EMISSIVE_FACTOR: {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Material * mat = g->materials + l->crumb(-2).index;
+            mat->emissiveFactor[l->crumb().index] = Number{str, len};
+            return true;
+        };
         break; }
-    // doubleSided
-    case 'd': {
+    case KEY_DOUBLE_SIDED: {
         mat->doubleSided = Number{str, len};
         break; }
-    // normalTexture || name
-    case 'n': {
-        switch (c.key[1]) {
-        // normalTexture
-        case 'o': {
-            c.handleChild = [mat](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-                Number n{str, len};
-                switch (l->crumb().key[0]) {
-                // index
-                case 'i': { mat->normalTexture = g->textures + n; break; }
-                // scale
-                case 's': { mat->normalScale = n; break; }
-                // texCoord
-                case 't': { mat->normalTexCoord = Gobj::texCoordAttr((int)n); break; }
-                }
-                return true;
-            };
-            break; }
-        // name
-        case 'a': { mat->name = g->strings->copyStr(str, len); break; }
-        }
+    case KEY_NORMAL_TEXTURE: {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Material * mat = g->materials + l->crumb(-2).index;
+            Number n{str, len};
+            switch (l->crumb().keyId) {
+            case KEY_INDEX:     { mat->normalTexture = g->textures + n; break; }
+            case KEY_SCALE:     { mat->normalScale = n; break; }
+            case KEY_TEX_COORD: { mat->normalTexCoord = Gobj::texCoordAttr((int)n); break; }
+            default: {}
+            }
+            return true;
+        };
+        break; }
+    case KEY_NAME: {
+        mat->name = g->strings->copyStr(str, len);
         break; }
-    // occlusionTexture
-    case 'o': {
-        c.handleChild = [mat](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+    case KEY_OCCLUSION_TEXTURE: {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Material * mat = g->materials + l->crumb(-2).index;
             Number n{str, len};
-            switch (l->crumb().key[0]) {
-            // index
-            case 'i': { mat->occlusionTexture = g->textures + n; break; }
-            // strength
-            case 's': { mat->occlusionStrength = n; break; }
-            // texCoord
-            case 't': { mat->occlusionTexCoord = Gobj::texCoordAttr((int)n); break; }
+            switch (l->crumb().keyId) {
+            case KEY_INDEX:     { mat->occlusionTexture = g->textures + n; break; }
+            case KEY_STRENGTH:  { mat->occlusionStrength = n; break; }
+            case KEY_TEX_COORD: { mat->occlusionTexCoord = Gobj::texCoordAttr((int)n); break; }
+            default: {}
             }
             return true;
         };
         break; }
-    // pbrMetallicRoughness
-    case 'p': {
-        c.handleChild = [mat](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-            switch (l->crumb().key[0]) {
-            // baseColorFactor || baseColorTexture
-            case 'b': {
-                switch (l->crumb().key[9]) {
-                // baseColorFactor
-                case 'F': {
-                    l->crumb().handleChild = [mat](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-                        mat->baseColorFactor[l->crumb().index] = Number{str, len};
-                        return true;
-                    };
-                    break; }
-                // baseColorTexture
-                case 'T': {
-                    l->crumb().handleChild = [mat](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-                        Number n{str, len};
-                        switch (l->crumb().key[0]) {
-                        // index
-                        case 'i': { mat->baseColorTexture = g->textures + n; break; }
-                        // texCoord
-                        case 't': { mat->baseColorTexCoord = Gobj::texCoordAttr((int)n); break; }
-                        }
-                        return true;
-                    };
-                    break; }
-                }
+    case KEY_PBR_METALLIC_ROUGHNESS: {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Material * mat = g->materials + l->crumb(-2).index;
+            switch (l->crumb().keyId) {
+            case KEY_BASE_COLOR_FACTOR: {
+                l->crumb().handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+                    Gobj::Material * mat = g->materials + l->crumb(-3).index;
+                    mat->baseColorFactor[l->crumb().index] = Number{str, len};
+                    return true;
+                };
                 break; }
-            // metallicFactor || metallicRoughnessTexture
-            case 'm': {
-                switch (l->crumb().key[8]) {
-                // metallicFactor
-                case 'F': { mat->metallicFactor = Number{str, len}; break; }
-                // metallicRoughnessTexture
-                case 'R': {
-                    l->crumb().handleChild = [mat](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-                        Number n{str, len};
-                        switch (l->crumb().key[0]) {
-                        // index
-                        case 'i': { mat->metallicRoughnessTexture = g->textures + n; break; }
-                        // texCoord
-                        case 't': { mat->metallicRoughnessTexCoord = Gobj::texCoordAttr((int)n); break; }
-                        }
-                        return true;
-                    };
-                    break; }
-                }
+            case KEY_BASE_COLOR_TEXTURE: {
+                l->crumb().handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+                    Gobj::Material * mat = g->materials + l->crumb(-3).index;
+                    Number n{str, len};
+                    switch (l->crumb().keyId) {
+                    case KEY_INDEX:     { mat->baseColorTexture = g->textures + n; break; }
+                    case KEY_TEX_COORD: { mat->baseColorTexCoord = Gobj::texCoordAttr((int)n); break; }
+                    default: {}
+                    }
+                    return true;
+                };
+                break; }
+            case KEY_METALLIC_FACTOR: {
+                mat->metallicFactor = Number{str, len};
+                break; }
+            case KEY_METALLIC_ROUGHNESS_TEXTURE: {
+                l->crumb().handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+                    Gobj::Material * mat = g->materials + l->crumb(-3).index;
+                    Number n{str, len};
+                    switch (l->crumb().keyId) {
+                    case KEY_INDEX:     { mat->metallicRoughnessTexture = g->textures + n; break; }
+                    case KEY_TEX_COORD: { mat->metallicRoughnessTexCoord = Gobj::texCoordAttr((int)n); break; }
+                    default: {}
+                    }
+                    return true;
+                };
+                break; }
+            case KEY_ROUGHNESS_FACTOR: {
+                mat->roughnessFactor = Number{str, len};
                 break; }
-            // roughnessFactor
-            case 'r': { mat->roughnessFactor = Number{str, len}; break; }
+            default: {}
             }
             return true;
         };
         break; }
+    default: {}
     }
     return true;
 }
@@ -1133,35 +1394,36 @@ bool GLTFLoader::handleMaterial(GLTFLoader * l, Gobj * g, char const * str, uint
 bool GLTFLoader::handleMesh(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     auto & c = l->crumb();
     Gobj::Mesh * mesh = g->meshes + l->crumb(-1).index;
-    switch (c.key[0]) {
-    // primitives
-    case 'p': {
+    switch (c.keyId) {
+    case KEY_PRIMITIVES: {
         // primitives array
         mesh->primitives = g->meshPrimitives + l->_nextMeshPrimitive;
         // handle each primitive
-        c.handleChild = [mesh](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
             l->crumb().handleChild = handleMeshPrimitive;
             return true;
         };
         // on end of primitives array
-        c.handleEnd = [mesh](GLTFLoader * l, Gobj * g, uint32_t count) {
-            mesh->nPrimitives = count;
+        c.handleEnd = [](GLTFLoader * l, Gobj * g, uint32_t count) {
+            g->meshes[l->crumb(-1).index].nPrimitives = count;
             l->_nextMeshPrimitive += count;
             return true;
         };
         break; }
-    // weights
-    case 'w': {
+    case KEY_WEIGHTS: {
         mesh->weights = g->meshWeights + l->_nextMeshWeight;
-        c.handleChild = [mesh](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Mesh * mesh = g->meshes + l->crumb(-2).index;
             mesh->weights[mesh->nWeights] = Number{str, len};
             ++mesh->nWeights;
             ++l->_nextMeshWeight;
             return true;
         };
         break; }
-    // name
-    case 'n': { mesh->name = g->strings->copyStr(str, len); break; }
+    case KEY_NAME: {
+        mesh->name = g->strings->copyStr(str, len);
+        break; }
+    default: {}
     }
     return true;
 }
@@ -1170,13 +1432,14 @@ bool GLTFLoader::handleMeshPrimitive(GLTFLoader * l, Gobj * g, char const * str,
     Gobj::Mesh * mesh = g->meshes + l->crumb(-3).index;
     Gobj::MeshPrimitive * prim = mesh->primitives + l->crumb(-1).index;
     auto & c = l->crumb();
-    switch (*(uint16_t *)c.key) {
-    // attributes
-    case 'a'|'t'<<8: {
+    switch (c.keyId) {
+    case KEY_ATTRIBUTES: {
         // set array location
         prim->attributes = g->meshAttributes + l->_nextMeshAttribute;
         // handle each attribute
-        c.handleChild = [prim](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Mesh * mesh = g->meshes + l->crumb(-4).index;
+            Gobj::MeshPrimitive * prim = mesh->primitives + l->crumb(-2).index;
             Gobj::MeshAttribute * ma = prim->attributes + prim->nAttributes;
             ma->type = Gobj::attrFromStr(l->crumb().key);
             ma->accessor = g->accessors + Number{str, len};
@@ -1185,22 +1448,23 @@ bool GLTFLoader::handleMeshPrimitive(GLTFLoader * l, Gobj * g, char const * str,
             return true;
         };
         break; }
-    // indices
-    case 'i'|'n'<<8: { prim->indices = g->accessors + Number{str, len}; break; }
-    // material
-    case 'm'|'a'<<8: { prim->material = g->materials + Number{str, len}; break; }
-    // mode
-    case 'm'|'o'<<8: { prim->mode = (Gobj::MeshPrimitive::Mode)(int)Number{str, len}; break; }
-    // targets
-    case 't'|'a'<<8: {
+    case KEY_INDICES:  { prim->indices = g->accessors + Number{str, len}; break; }
+    case KEY_MATERIAL: { prim->material = g->materials + Number{str, len}; break; }
+    case KEY_MODE:     { prim->mode = (Gobj::MeshPrimitive::Mode)(int)Number{str, len}; break; }
+    case KEY_TARGETS: {
         // set array location
         prim->targets = g->meshTargets + l->_nextMeshTarget;
         // handle each target
-        c.handleChild = [prim](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Mesh * mesh = g->meshes + l->crumb(-4).index;
+            Gobj::MeshPrimitive * prim = mesh->primitives + l->crumb(-2).index;
             Gobj::MeshTarget * targ = prim->targets + prim->nTargets;
             targ->attributes = g->meshAttributes + l->_nextMeshAttribute;
             // handle each attribute of the target
-            l->crumb().handleChild = [targ](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            l->crumb().handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+                Gobj::Mesh * mesh = g->meshes + l->crumb(-5).index;
+                Gobj::MeshPrimitive * prim = mesh->primitives + l->crumb(-3).index;
+                Gobj::MeshTarget * targ = prim->targets + l->crumb(-1).index;
                 targ->attributes[targ->nAttributes].type = Gobj::attrFromStr(l->crumb().key);
                 targ->attributes[targ->nAttributes].accessor = g->accessors + Number{str, len};
                 ++targ->nAttributes;
@@ -1212,6 +1476,7 @@ bool GLTFLoader::handleMeshPrimitive(GLTFLoader * l, Gobj * g, char const * str,
             return true;
         };
         break; }
+    default: {}
     }
     return true;
 }
@@ -1219,35 +1484,33 @@ bool GLTFLoader::handleMeshPrimitive(GLTFLoader * l, Gobj * g, char const * str,
 bool GLTFLoader::handleNode(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     auto & c = l->crumb();
     Gobj::Node * node = g->nodes + l->crumb(-1).index;
-    switch (*(uint16_t *)c.key) {
-    // camera
-    case 'c'|'a'<<8: {
+    switch (c.keyId) {
+    case KEY_CAMERA: {
         node->camera = g->cameras + Number{str, len};
         break; }
-    // children
-    case 'c'|'h'<<8: {
+    case KEY_CHILDREN: {
         node->children = g->nodeChildren + l->_nextNodeChild;
-        c.handleChild = [node](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Node * node = g->nodes + l->crumb(-2).index;
             node->children[node->nChildren] = g->nodes + Number{str, len};
             ++node->nChildren;
             ++l->_nextNodeChild;
             return true;
         };
         break; }
-    // matrix
-    case 'm'|'a'<<8: {
-        c.handleChild = [node](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-            glm::value_ptr(node->matrix)[l->crumb().index] = Number{str, len};
+    case KEY_MATRIX: {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Node * node = g->nodes + l->crumb(-2).index;
+            glm::value_ptr(*node->matrix)[l->crumb().index] = Number{str, len};
             return true;
         };
         break; }
-    // mesh
-    case 'm'|'e'<<8: {
+    case KEY_MESH: {
         node->mesh = g->meshes + Number{str, len};
         break; }
-    // rotation
-    case 'r'|'o'<<8: {
-        c.handleChild = [node](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+    case KEY_ROTATION: {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Node * node = g->nodes + l->crumb(-2).index;
             uint32_t i = l->crumb().index;
             // mind the order! glm quat can be wxyz or xyzw
             // see GLM_FORCE_QUAT_DATA_WXYZ
@@ -1257,72 +1520,58 @@ bool GLTFLoader::handleNode(GLTFLoader * l, Gobj * g, char const * str, uint32_t
             // (but we're not using the constructor here)
             #ifdef GLM_FORCE_QUAT_DATA_WXYZ
             // printl("SETTING QUAT *WITH* GLM_FORCE_QUAT_DATA_WXYZ");
-            node->rotation[(i+1)%4] = Number{str, len};
+            (*node->rotation)[(i+1)%4] = Number{str, len};
             #else
             // printl("SETTING QUAT *WITHOUT* GLM_FORCE_QUAT_DATA_WXYZ");
-            node->rotation[i] = Number{str, len};
+            (*node->rotation)[i] = Number{str, len};
             #endif
             return true;
         };
         break; }
-    // scale
-    case 's'|'c'<<8: {
-        c.handleChild = [node](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-            node->scale[l->crumb().index] = Number{str, len};
+    case KEY_SCALE: {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Node * node = g->nodes + l->crumb(-2).index;
+            (*node->scale)[l->crumb().index] = Number{str, len};
             return true;
         };
         break; }
-    // skin
-    case 's'|'k'<<8: {
+    case KEY_SKIN: {
         node->skin = g->skins + Number{str, len};
         break; }
-    // translation
-    case 't'|'r'<<8: {
-        c.handleChild = [node](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
-            node->translation[l->crumb().index] = Number{str, len};
+    case KEY_TRANSLATION: {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Node * node = g->nodes + l->crumb(-2).index;
+            (*node->translation)[l->crumb().index] = Number{str, len};
             return true;
         };
         break; }
-    // weights
-    case 'w'|'e'<<8: {
+    case KEY_WEIGHTS: {
         node->weights = g->nodeWeights + l->_nextNodeWeight;
-        c.handleChild = [node](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Node * node = g->nodes + l->crumb(-2).index;
             node->weights[l->crumb().index] = Number{str, len};
             ++node->nWeights;
             ++l->_nextNodeWeight;
             return true;
         };
         break; }
-    // name
-    case 'n'|'a'<<8: {
+    case KEY_NAME: {
         node->name = g->strings->copyStr(str, len);
         break; }
+    default: {}
     }
     return true;
 }
 
 bool GLTFLoader::handleSampler(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     Gobj::Sampler * samp = g->samplers + l->crumb(-1).index;
-    auto & c = l->crumb();
-    switch (c.key[0]) {
-    case 'm': {
-        switch (c.key[1]) {
-        // magFilter
-        case 'a': { samp->magFilter = (Gobj::Sampler::Filter)(int)Number{str, len}; break; }
-        // minFilter
-        case 'i': { samp->minFilter = (Gobj::Sampler::Filter)(int)Number{str, len}; break; }
-        }
-        break; }
-    case 'w': {
-        switch (c.key[4]) {
-        // wrapS
-        case 'S': { samp->wrapS = (Gobj::Sampler::Wrap)(int)Number{str, len}; break; }
-        // wrapT
-        case 'T': { samp->wrapT = (Gobj::Sampler::Wrap)(int)Number{str, len}; break; }
-        }
-        break; }
-    // name
-    case 'n': { samp->name = g->strings->copyStr(str, len); break; }
+    switch (l->crumb().keyId) {
+    case KEY_MAG_FILTER: { samp->magFilter = (Gobj::Sampler::Filter)(int)Number{str, len}; break; }
+    case KEY_MIN_FILTER: { samp->minFilter = (Gobj::Sampler::Filter)(int)Number{str, len}; break; }
+    case KEY_WRAP_S:     { samp->wrapS = (Gobj::Sampler::Wrap)(int)Number{str, len}; break; }
+    case KEY_WRAP_T:     { samp->wrapT = (Gobj::Sampler::Wrap)(int)Number{str, len}; break; }
+    case KEY_NAME:       { samp->name = g->strings->copyStr(str, len); break; }
+    default: {}
     }
     return true;
 }
@@ -1330,21 +1579,22 @@ bool GLTFLoader::handleSampler(GLTFLoader * l, Gobj * g, char const * str, uint3
 bool GLTFLoader::handleScene(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     auto & c = l->crumb();
     Gobj::Scene * scn = g->scenes + l->crumb(-1).index;
-    switch (*(uint16_t *)c.key) {
+    switch (c.keyId) {
     // nodes (root children)
-    case 'n'|'o'<<8: {
+    case KEY_NODES: {
         scn->nodes = g->nodeChildren + l->_nextNodeChild;
-        c.handleChild = [scn](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Scene * scn = g->scenes + l->crumb(-2).index;
             scn->nodes[scn->nNodes] = g->nodes + Number{str, len};
             ++scn->nNodes;
             ++l->_nextNodeChild;
             return true;
         };
         break; }
-    // name
-    case 'n'|'a'<<8: {
+    case KEY_NAME: {
         snprintf(scn->name, Gobj::Scene::NameMax, "%.*s", len, str);
         break; }
+    default: {}
     }
 
     return true;
@@ -1353,72 +1603,69 @@ bool GLTFLoader::handleScene(GLTFLoader * l, Gobj * g, char const * str, uint32_
 bool GLTFLoader::handleSkin(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     Gobj::Skin * skin = g->skins + l->crumb(-1).index;
     auto & c = l->crumb();
-    switch (c.key[0]) {
-    // inverseBindMatrices
-    case 'i': { skin->inverseBindMatrices = g->accessors + Number{str, len}; break; }
-    // joints
-    case 'j': {
+    switch (c.keyId) {
+    case KEY_INVERSE_BIND_MATRICES: { skin->inverseBindMatrices = g->accessors + Number{str, len}; break; }
+    case KEY_JOINTS: {
         skin->joints = g->nodeChildren + l->_nextNodeChild;
-        c.handleChild = [skin](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+        c.handleChild = [](GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
+            Gobj::Skin * skin = g->skins + l->crumb(-2).index;
             skin->joints[skin->nJoints] = g->nodes + Number{str, len};
             ++skin->nJoints;
             ++l->_nextNodeChild;
             return true;
         };
         break; }
-    // skeleton
-    case 's': { skin->skeleton = g->nodes + Number{str, len}; break; }
-    // name
-    case 'n': { skin->name = g->strings->copyStr(str, len); break; }
+    case KEY_SKELETON: { skin->skeleton = g->nodes + Number{str, len}; break; }
+    case KEY_NAME:     { skin->name = g->strings->copyStr(str, len); break; }
+    default: {}
     }
     return true;
 }
 
 bool GLTFLoader::handleTexture(GLTFLoader * l, Gobj * g, char const * str, uint32_t len) {
     Gobj::Texture * tex = g->textures + l->crumb(-1).index;
-    auto & c = l->crumb();
-    switch (*(uint16_t *)c.key) {
-    // sampler
-    case 's'|'a'<<8: { tex->sampler = g->samplers + Number{str, len}; break; }
-    // source
-    case 's'|'o'<<8: { tex->source = g->images + Number{str, len}; break; }
-    // name
-    case 'n'|'a'<<8: { tex->name = g->strings->copyStr(str, len); break; }
+    switch (l->crumb().keyId) {
+    case KEY_SAMPLER: { tex->sampler = g->samplers + Number{str, len}; break; }
+    case KEY_SOURCE:  { tex->source = g->images + Number{str, len}; break; }
+    case KEY_NAME:    { tex->name = g->strings->copyStr(str, len); break; }
+    default: {}
     }
     return true;
 }
 
-size_t GLTFLoader::handleDataString(byte_t * dst, char const * loadingDir, char const * str, size_t strLength) {
+size_t GLTFLoader::handleDataString(byte_t * dst, char const * loadingDir, char const * str, size_t strLength, IOHandle * pendingRead) {
     // base64?
-    static char const * isDataStr = "data:application/octet-stream;base64,";
-    static size_t isDataLen = strlen(isDataStr);
-    if (strEqu(str, isDataStr, isDataLen)) {
-        size_t b64StrLen = strLength - isDataLen;
-        modp_b64_decode((char *)dst, (char *)str + isDataLen, b64StrLen);
-        return modp_b64_decode_len(b64StrLen);
+    size_t b64Len = strLength;
+    char const * b64 = base64DataURI(str, &b64Len);
+    if (b64) {
+        size_t written = base64Decode(dst, b64, b64Len);
+        if (written == Base64Error) {
+            fprintf(stderr, "Error decoding buffer data URI.\n");
+            return 0;
+        }
+        return written;
     }
 
     // uri to load?
     // TODO: test this
     char * fullPath = mm.frameFormatStr("%s%s", loadingDir, str);
-    FILE * fp = fopen(fullPath, "r");
-    if (!fp) {
-        fprintf(stderr, "WARNING: Error opening buffer file: %s\n", fullPath);
+    if (fullPath == nullptr) {
+        fprintf(stderr, "Error formatting buffer file path.\n");
         return 0;
     }
-    long fileSize = getFileSize(fp);
-    if (fileSize == -1) {
-        fclose(fp);
+    struct stat st;
+    if (stat(fullPath, &st) != 0) {
+        fprintf(stderr, "WARNING: Error opening buffer file: %s\n", fullPath);
         return 0;
     }
-    size_t readSize = fread(dst, 1, fileSize, fp);
-    // error
-    if (ferror(fp) || readSize != fileSize) {
-        fprintf(stderr, "Error reading file \"%s\" contents: read %zu, expecting %zu\n",
-            fullPath, readSize, fileSize);
-        fclose(fp);
+    size_t fileSize = (size_t)st.st_size;
+    IOHandle read = mm.io.read(fullPath, dst, fileSize);
+    if (pendingRead) {
+        *pendingRead = read;
+    }
+    else if (!mm.io.wait(read)) {
         return 0;
     }
 
-    return readSize;
+    return fileSize;
 }
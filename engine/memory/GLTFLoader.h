@@ -1,10 +1,12 @@
 #pragma once
+#include <array>
 #include <functional>
 #include <stdint.h>
 #include <stddef.h>
 #include <rapidjson/reader.h>
 #include "../common/debug_defines.h"
 #include "Gobj.h"
+#include "../worker/FileIO.h"
 
 /*
 
@@ -18,6 +20,7 @@ Implemented:
         • images in separate file
         • base64-encoded images
     • Calculating size
+    • tokenizing JSON once to a tape, which counting and loading replay
     • loading strings
     • loading all Gobj sub-objects
 
@@ -34,8 +37,11 @@ class GLTFLoader {
 public:
     static constexpr size_t MaxDepth = 12;
     static constexpr size_t MaxKeyLen = 32;
+    // external buffer files read at once during load. more wait for earlier.
+    static constexpr uint16_t MaxPendingReads = 16;
 
     using HandlerFnSig = bool (GLTFLoader *, Gobj *, char const *, uint32_t);
+    using EndFnSig = bool (GLTFLoader *, Gobj *, uint32_t);
 
 // TYPES
 public:
@@ -48,6 +54,147 @@ public:
         TYPE_NUM,
     };
 
+    // every JSON key the loader reacts to. keys are looked up once, by perfect
+    // hash, when read. handlers then switch on the id. anything not listed
+    // (extensions, extras, attribute names) is KEY_NONE.
+    enum Key : uint8_t {
+        KEY_NONE,
+        KEY_ACCESSORS,
+        KEY_ALPHA_CUTOFF,
+        KEY_ALPHA_MODE,
+        KEY_ANIMATIONS,
+        KEY_ASPECT_RATIO,
+        KEY_ASSET,
+        KEY_ATTRIBUTES,
+        KEY_BASE_COLOR_FACTOR,
+        KEY_BASE_COLOR_TEXTURE,
+        KEY_BUFFER,
+        KEY_BUFFER_VIEW,
+        KEY_BUFFER_VIEWS,
+        KEY_BUFFERS,
+        KEY_BYTE_LENGTH,
+        KEY_BYTE_OFFSET,
+        KEY_BYTE_STRIDE,
+        KEY_CAMERA,
+        KEY_CAMERAS,
+        KEY_CHANNELS,
+        KEY_CHILDREN,
+        KEY_COMPONENT_TYPE,
+        KEY_COPYRIGHT,
+        KEY_COUNT,
+        KEY_DOUBLE_SIDED,
+        KEY_EMISSIVE_FACTOR,
+        KEY_EMISSIVE_TEXTURE,
+        KEY_GENERATOR,
+        KEY_IMAGES,
+        KEY_INDEX,
+        KEY_INDICES,
+        KEY_INPUT,
+        KEY_INTERPOLATION,
+        KEY_INVERSE_BIND_MATRICES,
+        KEY_JOINTS,
+        KEY_MAG_FILTER,
+        KEY_MATERIAL,
+        KEY_MATERIALS,
+        KEY_MATRIX,
+        KEY_MAX,
+        KEY_MESH,
+        KEY_MESHES,
+        KEY_METALLIC_FACTOR,
+        KEY_METALLIC_ROUGHNESS_TEXTURE,
+        KEY_MIME_TYPE,
+        KEY_MIN,
+        KEY_MIN_FILTER,
+        KEY_MIN_VERSION,
+        KEY_MODE,
+        KEY_NAME,
+        KEY_NODE,
+        KEY_NODES,
+        KEY_NORMAL_TEXTURE,
+        KEY_NORMALIZED,
+        KEY_OCCLUSION_TEXTURE,
+        KEY_ORTHOGRAPHIC,
+        KEY_OUTPUT,
+        KEY_PATH,
+        KEY_PBR_METALLIC_ROUGHNESS,
+        KEY_PERSPECTIVE,
+        KEY_PRIMITIVES,
+        KEY_ROTATION,
+        KEY_ROUGHNESS_FACTOR,
+        KEY_SAMPLER,
+        KEY_SAMPLERS,
+        KEY_SCALE,
+        KEY_SCENE,
+        KEY_SCENES,
+        KEY_SKELETON,
+        KEY_SKIN,
+        KEY_SKINS,
+        KEY_SOURCE,
+        KEY_STRENGTH,
+        KEY_TARGET,
+        KEY_TARGETS,
+        KEY_TEX_COORD,
+        KEY_TEXTURES,
+        KEY_TRANSLATION,
+        KEY_TYPE,
+        KEY_URI,
+        KEY_VERSION,
+        KEY_WEIGHTS,
+        KEY_WRAP_S,
+        KEY_WRAP_T,
+        KEY_XMAG,
+        KEY_YFOV,
+        KEY_YMAG,
+        KEY_ZFAR,
+        KEY_ZNEAR,
+    };
+    static constexpr uint32_t NKeys = KEY_ZNEAR + 1;
+
+    // JSON event recorded to the tape
+    enum TokenType {
+        TOKEN_NULL,
+        TOKEN_FALSE,
+        TOKEN_TRUE,
+        TOKEN_NUM,
+        TOKEN_STR,
+        TOKEN_KEY,
+        TOKEN_START_OBJ,
+        TOKEN_END_OBJ,
+        TOKEN_START_ARR,
+        TOKEN_END_ARR,
+    };
+
+    // str tokens point into the JSON string (tokenized in place). end tokens
+    // hold member/element count in length.
+    struct Token {
+        uint32_t offset;
+        uint32_t length : 28;
+        uint32_t type : 4;
+    };
+    static constexpr uint32_t TokenMaxLength = (1 << 28) - 1;
+
+    // rapidjson handler
+    // records every JSON event to the tape, in order
+    struct Tokenizer {
+        bool Null();
+        bool Bool(bool b);
+        bool Int(int i);
+        bool Uint(unsigned i);
+        bool Int64(int64_t i);
+        bool Uint64(uint64_t i);
+        bool Double(double d);
+        bool String(char const * str, uint32_t length, bool copy);
+        bool RawNumber(char const * str, uint32_t length, bool copy);
+        bool StartObject();
+        bool Key(char const * str, uint32_t length, bool copy);
+        bool EndObject(uint32_t memberCount);
+        bool StartArray();
+        bool EndArray(uint32_t elementCount);
+
+        GLTFLoader * l;
+        bool add(TokenType type, char const * str = nullptr, uint32_t length = 0);
+    };
+
     // rapidjson handler
     // counts objects to determine size/layout of final Gobj
     struct Counter {
@@ -98,6 +245,7 @@ public:
     struct Crumb {
         ObjType objType = TYPE_UNKNOWN;
         char key[MaxKeyLen] = {'\0'};
+        Key keyId = KEY_NONE;
         uint32_t index = UINT32_MAX; // index if this is child of array
         uint32_t childCount = 0;
 
@@ -105,25 +253,42 @@ public:
         Crumb();
 
         void setKey(char const * key);
-        // match key. null key matches any (no check, always true)
-        bool matches(char const * key) const;
-        // match obj type and (optionally) key
-        bool matches(ObjType objType, char const * key = nullptr) const;
+        // match key
+        bool matches(Key keyId) const;
+        // match obj type and (optionally) key. KEY_NONE matches any key.
+        bool matches(ObjType objType, Key keyId = KEY_NONE) const;
         char const * objTypeStr() const;
         bool hasKey() const;
         bool isValid() const;
 
-        std::function<bool(GLTFLoader *, Gobj * g, char const *, uint32_t)> handleChild = nullptr;
-        std::function<bool(GLTFLoader *, Gobj * g, uint32_t)> handleEnd = nullptr;
+        // anything a handler needs is found through the crumb stack, so these
+        // are plain function pointers (lambdas can't capture)
+        HandlerFnSig * handleChild = nullptr;
+        EndFnSig * handleEnd = nullptr;
     };
 
 // PUBLIC INTERFACE
 public:
-    GLTFLoader(byte_t const * gltfData, char const * loadingDir = nullptr);
+    // gltfData is modified by tokenize()
+    GLTFLoader(byte_t * gltfData, char const * loadingDir = nullptr);
+
+    // bytes needed for tape. counts the JSON's structural characters on first
+    // call, which bounds the number of tokens.
+    size_t tapeSize();
+    // parse JSON once into tape (tapeSize() bytes, which must outlive the
+    // loader's use). calculateSize, load and prettyJSON then replay the tape
+    // instead of parsing the text again. JSON string is parsed in place, so
+    // it is modified.
+    bool tokenize(void * tape);
 
     size_t calculateSize();
     bool load(Gobj * gobj);
 
+    // GLB only. buffer 0 points at the BIN chunk in gltfData instead of a copy
+    // in Gobj::rawData (and isn't counted in rawDataLen), so gltfData must
+    // outlive the Gobj. call before calculateSize.
+    void setBinInPlace(bool binInPlace);
+
     // allows user to add counts and string length before calculateSize,
     // or just to reset the counts object
     void setCounts(Gobj::Counts const & counts);
@@ -133,6 +298,7 @@ public:
     bool validData() const;
 
     #if DEBUG
+    // in frame stack. nullptr if it's full, but size is still set.
     char const * prettyJSON(uint32_t * prettyJSONSize = nullptr);
     #endif // DEBUG
 
@@ -141,8 +307,9 @@ private:
     // carries all info necessary to determine byte-size of Gobj
     Gobj::Counts _counts;
     // json string. is NOT copied. might not be null terminated.
-    byte_t const * _gltfData;
+    byte_t * _gltfData;
     bool _isBinary = false;
+    bool _binInPlace = false;
     // loading dir
     char const * _loadingDir = nullptr;
     // crumb stack
@@ -151,12 +318,19 @@ private:
     Crumb _invalidCrumb;
     // key buffer, for most recent key encountered
     char _key[MaxKeyLen] = {'\0'};
+    Key _keyId = KEY_NONE;
 
     // json reading tools
     Counter _counter;
     Scanner _scanner;
+    Tokenizer _tokenizer;
     rapidjson::Reader _reader;
 
+    // tape of JSON events, set by tokenize()
+    Token * _tape = nullptr;
+    uint32_t _tapeLength = 0;
+    uint32_t _tapeCapacity = 0;
+
     // tracking vars during scanning
     uint16_t _nextAnimationChannel = 0;
     uint16_t _nextAnimationSampler = 0;
@@ -168,8 +342,15 @@ private:
     uint16_t _nextNodeWeight = 0;
     byte_t * _nextRawDataPtr = nullptr;
 
+    // external buffer reads, still in flight. waited on at end of load.
+    IOHandle _pendingReads[MaxPendingReads];
+    uint16_t _nPendingReads = 0;
+
 // INTERNALS
 private:
+    // copy key to _key and look up its id
+    void setKey(char const * str, uint32_t length);
+    static Key keyFromStr(char const * str, uint32_t length);
     // push/pop to crumb stack
     void push(ObjType objType);
     void pop();
@@ -178,9 +359,16 @@ private:
     Crumb & crumb(int offset = 0);
     // do additional work after load
     void postLoad(Gobj * g);
+    // wait for every pending read. true if all succeeded.
+    bool waitPendingReads();
+    // feed tape to rapidjson-style handler, as if parsing the text
+    template <typename Handler>
+    bool replay(Handler & handler);
 
     // data access
     uint32_t jsonStrSize() const;
+    // length of json string. works for GLTF and GLB.
+    uint32_t jsonStrLength() const;
     char const * jsonStr() const;
     byte_t const * binChunkStart() const;
     byte_t const * binData() const;
@@ -195,6 +383,9 @@ private:
 private:
     // handle json objects
     static bool handleRoot              (GLTFLoader * l, Gobj * g, char const * str, uint32_t len);
+    static bool handleRootElement       (GLTFLoader * l, Gobj * g, char const * str, uint32_t len);
+    // handler for children of each element of a root array, by array's key
+    static std::array<HandlerFnSig *, NKeys> const RootElementHandlers;
     static bool handleAccessor          (GLTFLoader * l, Gobj * g, char const * str, uint32_t len);
     static bool handleAsset             (GLTFLoader * l, Gobj * g, char const * str, uint32_t len);
     static bool handleAnimation         (GLTFLoader * l, Gobj * g, char const * str, uint32_t len);
@@ -213,7 +404,8 @@ private:
     static bool handleSkin              (GLTFLoader * l, Gobj * g, char const * str, uint32_t len);
     static bool handleTexture           (GLTFLoader * l, Gobj * g, char const * str, uint32_t len);
 
-    // handles string that might be a uri OR data-stream
-    static size_t handleDataString(byte_t * dst, char const * loadingDir, char const * str, size_t strLength);
+    // handles string that might be a uri OR data-stream. if pendingRead is
+    // set, a file is only queued, and dst isn't filled until it completes.
+    static size_t handleDataString(byte_t * dst, char const * loadingDir, char const * str, size_t strLength, IOHandle * pendingRead = nullptr);
 
 };
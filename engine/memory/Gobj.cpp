@@ -1,12 +1,13 @@
 #include "Gobj.h"
 #include <new>
+#include <glm/common.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
 #include "FrameStack.h"
 #include "mem_utils.h"
 #include "../common/string_utils.h"
+#include "../MrManager.h"
 #if DEBUG || DEV_INTERFACE
 #include "../dev/print.h"
-#include "../MrManager.h"
 #endif // DEBUG || DEV_INTERFACE
 
 #define ALIGN_SIZE(SIZE) alignSize(SIZE, Gobj::Align)
@@ -161,10 +162,10 @@ Gobj::Gobj(Gobj::Counts const & maxCounts) :
     }
 
     if (maxCounts.nodeChildren) {
-        nodeChildren = (Node **)head;
+        nodeChildren = (RelPtr<Node> *)head;
         for (uint16_t i = 0; i < maxCounts.nodeChildren; ++i) {
-            *(Node **)head = nullptr;
-            head += sizeof(Node *);
+            new (head) RelPtr<Node>{};
+            head += sizeof(RelPtr<Node>);
         }
         // aligns on group, not on each ptr
         head = (byte_t *)ALIGN_PTR(head);
@@ -180,6 +181,45 @@ Gobj::Gobj(Gobj::Counts const & maxCounts) :
         head = (byte_t *)ALIGN_PTR(head);
     }
 
+    if (maxCounts.nodes) {
+        uint16_t const n = maxCounts.nodes;
+        nodeOrder        = (uint16_t *)head;  head += ALIGN_SIZE(sizeof(uint16_t)  * n);
+        nodeParents      = (uint16_t *)head;  head += ALIGN_SIZE(sizeof(uint16_t)  * n);
+        nodeTranslations = (glm::vec3 *)head; head += ALIGN_SIZE(sizeof(glm::vec3) * n);
+        nodeRotations    = (glm::quat *)head; head += ALIGN_SIZE(sizeof(glm::quat) * n);
+        nodeScales       = (glm::vec3 *)head; head += ALIGN_SIZE(sizeof(glm::vec3) * n);
+        nodeMatrices     = (glm::mat4 *)head; head += ALIGN_SIZE(sizeof(glm::mat4) * n);
+        nodeWorlds       = (glm::mat4 *)head; head += ALIGN_SIZE(sizeof(glm::mat4) * n);
+        nodeNormals      = (glm::mat3 *)head; head += ALIGN_SIZE(sizeof(glm::mat3) * n);
+        nodeDirty        = (uint8_t *)head;   head += ALIGN_SIZE(sizeof(uint8_t)   * n);
+        size_t const stride = nodeLaneStride();
+        nodeBounds       = (float *)head;     head += ALIGN_SIZE(sizeof(float) * NodeBoundsLanes * stride);
+        nodeVisible      = (uint8_t *)head;   head += ALIGN_SIZE(sizeof(uint8_t) * stride);
+        // padding past the last slot is an empty box at the origin
+        memset(nodeBounds, 0, sizeof(float) * NodeBoundsLanes * stride);
+        memset(nodeVisible, 1, stride);
+        // each node starts in its own slot, until flattened
+        for (uint16_t i = 0; i < n; ++i) {
+            nodeOrder[i] = i;
+            nodeParents[i] = NoParent;
+            new (nodeTranslations + i) glm::vec3{0.f, 0.f, 0.f};
+            new (nodeRotations + i) glm::quat{1.f, 0.f, 0.f, 0.f};
+            new (nodeScales + i) glm::vec3{1.f, 1.f, 1.f};
+            new (nodeMatrices + i) glm::mat4{1.f};
+            new (nodeWorlds + i) glm::mat4{1.f};
+            new (nodeNormals + i) glm::mat3{1.f};
+            nodeDirty[i] = 1;
+            Node & node = nodes[i];
+            node.translation = nodeTranslations + i;
+            node.rotation = nodeRotations + i;
+            node.scale = nodeScales + i;
+            node.matrix = nodeMatrices + i;
+            node.world = nodeWorlds + i;
+            node.normalMatrix = nodeNormals + i;
+            node.worldDirty = nodeDirty + i;
+        }
+    }
+
     if (maxCounts.samplers) {
         samplers = (Sampler *)head;
         for (uint16_t i = 0; i < maxCounts.samplers; ++i) {
@@ -232,83 +272,92 @@ bool Gobj::isReadyToDraw() const {
     return (_status == STATUS_READY_TO_DRAW);
 }
 
+bool Gobj::isLoading() const {
+    std::lock_guard<std::mutex> guard{_mutex};
+    return (_status == STATUS_LOADING);
+}
+
 void Gobj::copy(Gobj * src) {
-    if (src->strings) {
-        memcpy(strings, src->strings, src->strings->totalSize());
-    }
-    for (uint16_t i = 0; i < src->counts.accessors && i < maxCounts.accessors; ++i) {
-        accessors[i].copy(src->accessors + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.animations && i < maxCounts.animations; ++i) {
-        animations[i].copy(src->animations + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.animationChannels && i < maxCounts.animationChannels; ++i) {
-        animationChannels[i].copy(src->animationChannels + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.animationSamplers && i < maxCounts.animationSamplers; ++i) {
-        animationSamplers[i].copy(src->animationSamplers + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.buffers && i < maxCounts.buffers; ++i) {
-        buffers[i].copy(src->buffers + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.bufferViews && i < maxCounts.bufferViews; ++i) {
-        bufferViews[i].copy(src->bufferViews + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.cameras && i < maxCounts.cameras; ++i) {
-        cameras[i].copy(src->cameras + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.images && i < maxCounts.images; ++i) {
-        images[i].copy(src->images + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.materials && i < maxCounts.materials; ++i) {
-        materials[i].copy(src->materials + i, this, src);
+    bool const sameLayout = (maxCounts == src->maxCounts);
+    if (sameLayout) {
+        // every section moves by the same amount, so offsets between them
+        // hold. one memcpy of everything past the header.
+        size_t begin = ALIGN_SIZE(sizeof(Gobj));
+        size_t end = (src->rawData) ?
+            (size_t)(src->rawData - (byte_t *)src) + src->counts.rawDataLen :
+            maxCounts.totalSize();
+        memcpy((byte_t *)this + begin, (byte_t *)src + begin, end - begin);
     }
-    for (uint16_t i = 0; i < src->counts.meshes && i < maxCounts.meshes; ++i) {
-        meshes[i].copy(src->meshes + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.meshAttributes && i < maxCounts.meshAttributes; ++i) {
-        meshAttributes[i].copy(src->meshAttributes + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.meshPrimitives && i < maxCounts.meshPrimitives; ++i) {
-        meshPrimitives[i].copy(src->meshPrimitives + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.meshTargets && i < maxCounts.meshTargets; ++i) {
-        meshTargets[i].copy(src->meshTargets + i, this, src);
-    }
-    memcpy(meshWeights, src->meshWeights, sizeof(float) * min(src->counts.meshWeights, maxCounts.meshWeights));
-    for (uint16_t i = 0; i < src->counts.nodes && i < maxCounts.nodes; ++i) {
-        nodes[i].copy(src->nodes + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.nodeChildren && i < maxCounts.nodeChildren; ++i) {
-        nodeChildren[i] = src->nodeRelPtr(src->nodeChildren[i], this);
-    }
-    memcpy(nodeWeights, src->nodeWeights, sizeof(float) * min(src->counts.nodeWeights, maxCounts.nodeWeights));
-    for (uint16_t i = 0; i < src->counts.samplers && i < maxCounts.samplers; ++i) {
-        samplers[i].copy(src->samplers + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.scenes && i < maxCounts.scenes; ++i) {
-        scenes[i].copy(src->scenes + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.skins && i < maxCounts.skins; ++i) {
-        skins[i].copy(src->skins + i, this, src);
-    }
-    for (uint16_t i = 0; i < src->counts.textures && i < maxCounts.textures; ++i) {
-        textures[i].copy(src->textures + i, this, src);
+    else {
+        // sections differ in size, copy each to where it is here
+        if (strings && src->strings) {
+            size_t strLen = min(src->strings->head(), strings->size());
+            memcpy(strings->data(), src->strings->data(), strLen);
+            strings->_head.store(strLen, std::memory_order_relaxed);
+        }
+        memcpy(accessors,         src->accessors,         sizeof(Accessor)         * min(src->counts.accessors,         maxCounts.accessors));
+        memcpy(animations,        src->animations,        sizeof(Animation)        * min(src->counts.animations,        maxCounts.animations));
+        memcpy(animationChannels, src->animationChannels, sizeof(AnimationChannel) * min(src->counts.animationChannels, maxCounts.animationChannels));
+        memcpy(animationSamplers, src->animationSamplers, sizeof(AnimationSampler) * min(src->counts.animationSamplers, maxCounts.animationSamplers));
+        memcpy(buffers,           src->buffers,           sizeof(Buffer)           * min(src->counts.buffers,           maxCounts.buffers));
+        memcpy(bufferViews,       src->bufferViews,       sizeof(BufferView)       * min(src->counts.bufferViews,       maxCounts.bufferViews));
+        memcpy(cameras,           src->cameras,           sizeof(Camera)           * min(src->counts.cameras,           maxCounts.cameras));
+        memcpy(images,            src->images,            sizeof(Image)            * min(src->counts.images,            maxCounts.images));
+        memcpy(materials,         src->materials,         sizeof(Material)         * min(src->counts.materials,         maxCounts.materials));
+        memcpy(meshes,            src->meshes,            sizeof(Mesh)             * min(src->counts.meshes,            maxCounts.meshes));
+        memcpy(meshAttributes,    src->meshAttributes,    sizeof(MeshAttribute)    * min(src->counts.meshAttributes,    maxCounts.meshAttributes));
+        memcpy(meshPrimitives,    src->meshPrimitives,    sizeof(MeshPrimitive)    * min(src->counts.meshPrimitives,    maxCounts.meshPrimitives));
+        memcpy(meshTargets,       src->meshTargets,       sizeof(MeshTarget)       * min(src->counts.meshTargets,       maxCounts.meshTargets));
+        memcpy(meshWeights,       src->meshWeights,       sizeof(float)            * min(src->counts.meshWeights,       maxCounts.meshWeights));
+        memcpy(nodes,             src->nodes,             sizeof(Node)             * min(src->counts.nodes,             maxCounts.nodes));
+        memcpy(nodeChildren,      src->nodeChildren,      sizeof(RelPtr<Node>)     * min(src->counts.nodeChildren,      maxCounts.nodeChildren));
+        memcpy(nodeWeights,       src->nodeWeights,       sizeof(float)            * min(src->counts.nodeWeights,       maxCounts.nodeWeights));
+        uint16_t const nNodes = min(src->counts.nodes, maxCounts.nodes);
+        memcpy(nodeOrder,         src->nodeOrder,         sizeof(uint16_t)         * nNodes);
+        memcpy(nodeParents,       src->nodeParents,       sizeof(uint16_t)         * nNodes);
+        memcpy(nodeTranslations,  src->nodeTranslations,  sizeof(glm::vec3)        * nNodes);
+        memcpy(nodeRotations,     src->nodeRotations,     sizeof(glm::quat)        * nNodes);
+        memcpy(nodeScales,        src->nodeScales,        sizeof(glm::vec3)        * nNodes);
+        memcpy(nodeMatrices,      src->nodeMatrices,      sizeof(glm::mat4)        * nNodes);
+        memcpy(nodeWorlds,        src->nodeWorlds,        sizeof(glm::mat4)        * nNodes);
+        memcpy(nodeNormals,       src->nodeNormals,       sizeof(glm::mat3)        * nNodes);
+        memcpy(nodeDirty,         src->nodeDirty,         sizeof(uint8_t)          * nNodes);
+        for (int lane = 0; lane < NodeBoundsLanes; ++lane) {
+            memcpy(nodeBounds + lane * nodeLaneStride(), src->nodeBounds + lane * src->nodeLaneStride(), sizeof(float) * nNodes);
+        }
+        memcpy(nodeVisible,       src->nodeVisible,       sizeof(uint8_t)          * nNodes);
+        memcpy(samplers,          src->samplers,          sizeof(Sampler)          * min(src->counts.samplers,          maxCounts.samplers));
+        memcpy(scenes,            src->scenes,            sizeof(Scene)            * min(src->counts.scenes,            maxCounts.scenes));
+        memcpy(skins,             src->skins,             sizeof(Skin)             * min(src->counts.skins,             maxCounts.skins));
+        memcpy(textures,          src->textures,          sizeof(Texture)          * min(src->counts.textures,          maxCounts.textures));
+        memcpy(rawData,           src->rawData,                                      min(src->counts.rawDataLen,        maxCounts.rawDataLen));
     }
-    memcpy(rawData, src->rawData, min(src->counts.rawDataLen, maxCounts.rawDataLen));
     // maxCounts = src->maxCounts; // don't copy the maxCounts! Gobj ctor requires maxCounts and gets set permenantly.
     counts = src->counts;
-    scene = src->sceneRelPtr(src->scene, this);
     bounds = src->bounds;
-    copyright = src->stringRelPtr(src->copyright, this);
-    generator = src->stringRelPtr(src->generator, this);
-    version = src->stringRelPtr(src->version, this);
-    minVersion = src->stringRelPtr(src->minVersion, this);
-    loadedDirName = src->stringRelPtr(src->loadedDirName, this);
+    // truncated hierarchy gets flattened again
+    nFlatNodes = (counts.nodes <= maxCounts.nodes) ? src->nFlatNodes : 0;
+    // header links keep their offsets, same as the memcpy'd sections
+    scene.setOffset(src->scene.offset());
+    copyright.setOffset(src->copyright.offset());
+    generator.setOffset(src->generator.offset());
+    version.setOffset(src->version.offset());
+    minVersion.setOffset(src->minVersion.offset());
+    loadedDirName.setOffset(src->loadedDirName.offset());
     #if DEBUG
-    jsonStr = src->stringRelPtr(src->jsonStr, this);
+    jsonStr.setOffset(src->jsonStr.offset());
     #endif // DEBUG
 
+    if (!sameLayout || src->mappedFile) {
+        rebase(src);
+    }
+    resetRuntimeState();
+
+    // buffers still point into the mapping, so it moves here. src won't
+    // release it.
+    mappedFile = src->mappedFile;
+    src->mappedFile = nullptr;
+
     printl("GOBJ DEEP COPY");
     printl("SRC: %p", src);
     src->print();
@@ -316,234 +365,220 @@ void Gobj::copy(Gobj * src) {
     this->print();
 }
 
-void Gobj::Accessor::copy(Accessor * accessor, Gobj * dst, Gobj * src) {
-    memcpy(this, accessor, sizeof(Accessor));
-    bufferView = src->bufferViewRelPtr(accessor->bufferView, dst);
-    name = src->stringRelPtr(accessor->name, dst);
-    renderHandle = UINT16_MAX;
-}
-
-void Gobj::Animation::copy(Animation * animation, Gobj * dst, Gobj * src) {
-    channels = src->animationChannelRelPtr(animation->channels, dst);
-    nChannels = animation->nChannels;
-    samplers = src->animationSamplerRelPtr(animation->samplers, dst);
-    nSamplers = animation->nSamplers;
-    name = src->stringRelPtr(animation->name, dst);
-}
-
-void Gobj::AnimationChannel::copy(AnimationChannel * channel, Gobj * dst, Gobj * src) {
-    sampler = dst->animationSamplers + (channel->sampler - src->animationSamplers);
-    node = dst->nodes + (channel->node - src->nodes);
-    path = channel->path;
-}
-
-void Gobj::AnimationSampler::copy(AnimationSampler * sampler, Gobj * dst, Gobj * src) {
-    input = dst->accessors + (sampler->input - src->accessors);
-    interpolation = sampler->interpolation;
-    output = dst->accessors + (sampler->output - src->accessors);
-}
-
-void Gobj::Buffer::copy(Buffer * buffer, Gobj * dst, Gobj * src) {
-    data = src->rawDataRelPtr(buffer->data, dst);
-    byteLength = buffer->byteLength;
-    name = src->stringRelPtr(buffer->name, dst);
-}
-
-void Gobj::BufferView::copy(BufferView * bufferView, Gobj * dst, Gobj * src) {
-    buffer = src->bufferRelPtr(bufferView->buffer, dst);
-    byteOffset = bufferView->byteOffset;
-    byteLength = bufferView->byteLength;
-    byteStride = bufferView->byteStride;
-    target = bufferView->target;
-    name = src->stringRelPtr(bufferView->name, dst);
-}
-
-void Gobj::Camera::copy(Camera * camera, Gobj * dst, Gobj * src) {
-    memcpy(_data, camera->_data, sizeof(float) * 4);
-    orthographic = (camera->orthographic) ? (CameraOrthographic *)_data : nullptr;
-    perspective = (camera->perspective)   ? (CameraPerspective * )_data : nullptr;
-    type = camera->type;
-    name = src->stringRelPtr(camera->name, dst);
-}
-
-void Gobj::Image::copy(Image * image, Gobj * dst, Gobj * src) {
-    mimeType = image->mimeType;
-    bufferView = src->bufferViewRelPtr(image->bufferView, dst);
-    uri  = src->stringRelPtr(image->uri, dst);
-    name = src->stringRelPtr(image->name, dst);
-}
-
-void Gobj::Material::copy(Material * material, Gobj * dst, Gobj * src) {
-    memcpy(this, material, sizeof(Material));
-    emissiveTexture = src->textureRelPtr(material->emissiveTexture, dst);
-    normalTexture = src->textureRelPtr(material->normalTexture, dst);
-    occlusionTexture = src->textureRelPtr(material->occlusionTexture, dst);
-    baseColorTexture = src->textureRelPtr(material->baseColorTexture, dst);
-    metallicRoughnessTexture = src->textureRelPtr(material->metallicRoughnessTexture, dst);
-    name = src->stringRelPtr(material->name, dst);
-}
-
-void Gobj::Mesh::copy(Mesh * mesh, Gobj * dst, Gobj * src) {
-    primitives = src->meshPrimitiveRelPtr(mesh->primitives, dst);
-    nPrimitives = mesh->nPrimitives;
-    weights = src->meshWeightRelPtr(mesh->weights, dst);
-    nWeights = mesh->nWeights;
-    name = src->stringRelPtr(mesh->name, dst);
-}
-
-void Gobj::MeshAttribute::copy(MeshAttribute * meshAttribute, Gobj * dst, Gobj * src) {
-    type = meshAttribute->type;
-    accessor = src->accessorRelPtr(meshAttribute->accessor, dst);
-}
-
-void Gobj::MeshPrimitive::copy(MeshPrimitive * meshPrimitive, Gobj * dst, Gobj * src) {
-    attributes = src->meshAttributeRelPtr(meshPrimitive->attributes, dst);
-    nAttributes = meshPrimitive->nAttributes;
-    indices = src->accessorRelPtr(meshPrimitive->indices, dst);
-    material = src->materialRelPtr(meshPrimitive->material, dst);
-    mode = meshPrimitive->mode;
-    targets = src->meshTargetRelPtr(meshPrimitive->targets, dst);
-    nTargets = meshPrimitive->nTargets;
-}
-
-void Gobj::MeshTarget::copy(MeshTarget * meshTarget, Gobj * dst, Gobj * src) {
-    attributes = src->meshAttributeRelPtr(meshTarget->attributes, dst);
-    nAttributes = meshTarget->nAttributes;
-}
-
-void Gobj::Node::copy(Node * node, Gobj * dst, Gobj * src) {
-    camera = src->cameraRelPtr(node->camera, dst);
-    children = src->nodeChildrenRelPtr(node->children, dst);
-    nChildren = node->nChildren;
-    skin = src->skinRelPtr(node->skin, dst);
-    matrix = node->matrix;
-    mesh = src->meshRelPtr(node->mesh, dst);
-    rotation = node->rotation;
-    scale = node->scale;
-    translation = node->translation;
-    weights = src->meshWeightRelPtr(node->weights, dst);
-    name = src->stringRelPtr(node->name, dst);
-}
-
-void Gobj::Sampler::copy(Sampler * sampler, Gobj * dst, Gobj * src) {
-    magFilter = sampler->magFilter;
-    minFilter = sampler->minFilter;
-    wrapS = sampler->wrapS;
-    wrapT = sampler->wrapT;
-    name = src->stringRelPtr(sampler->name, dst);
- }
-
-void Gobj::Scene::copy(Scene * scene, Gobj * dst, Gobj * src) {
-    nodes = src->nodeChildrenRelPtr(scene->nodes, dst);
-    nNodes = scene->nNodes;
-    memcpy(name, scene->name, Scene::NameMax);
-}
-
-void Gobj::Skin::copy(Skin * skin, Gobj * dst, Gobj * src) {
-    inverseBindMatrices = src->accessorRelPtr(skin->inverseBindMatrices, dst);
-    skeleton = src->nodeRelPtr(skin->skeleton, dst);
-    joints = src->nodeChildrenRelPtr(skin->joints, dst);
-    nJoints = skin->nJoints;
-    name = src->stringRelPtr(skin->name, dst);
-}
-
-void Gobj::Texture::copy(Texture * texture, Gobj * dst, Gobj * src) {
-    sampler = src->samplerRelPtr(texture->sampler, dst);
-    source = src->imageRelPtr(texture->source, dst);
-    name = src->stringRelPtr(texture->name, dst);
-}
+void Gobj::rebase(Gobj const * src) {
+    // src sections in layout order, and how far each moved to get here
+    struct Section {
+        byte_t const * begin;
+        byte_t const * end;
+        ptrdiff_t moved;
+    };
+    Section sections[50];
+    int nSections = 0;
+    auto addSection = [&sections, &nSections](void const * srcBegin, size_t size, void const * dstBegin) {
+        if (srcBegin == nullptr || dstBegin == nullptr || size == 0) return;
+        sections[nSections++] = {
+            (byte_t const *)srcBegin,
+            (byte_t const *)srcBegin + size,
+            (byte_t const *)dstBegin - (byte_t const *)srcBegin,
+        };
+    };
+    Counts const & srcMax = src->maxCounts;
+    addSection(src, sizeof(Gobj), this);
+    if (src->strings && strings) {
+        addSection(src->strings->data(), src->strings->size(), strings->data());
+    }
+    addSection(src->accessors,         sizeof(Accessor)         * srcMax.accessors,         accessors);
+    addSection(src->animations,        sizeof(Animation)        * srcMax.animations,        animations);
+    addSection(src->animationChannels, sizeof(AnimationChannel) * srcMax.animationChannels, animationChannels);
+    addSection(src->animationSamplers, sizeof(AnimationSampler) * srcMax.animationSamplers, animationSamplers);
+    addSection(src->buffers,           sizeof(Buffer)           * srcMax.buffers,           buffers);
+    addSection(src->bufferViews,       sizeof(BufferView)       * srcMax.bufferViews,       bufferViews);
+    addSection(src->cameras,           sizeof(Camera)           * srcMax.cameras,           cameras);
+    addSection(src->images,            sizeof(Image)            * srcMax.images,            images);
+    addSection(src->materials,         sizeof(Material)         * srcMax.materials,         materials);
+    addSection(src->meshes,            sizeof(Mesh)             * srcMax.meshes,            meshes);
+    addSection(src->meshAttributes,    sizeof(MeshAttribute)    * srcMax.meshAttributes,    meshAttributes);
+    addSection(src->meshPrimitives,    sizeof(MeshPrimitive)    * srcMax.meshPrimitives,    meshPrimitives);
+    addSection(src->meshTargets,       sizeof(MeshTarget)       * srcMax.meshTargets,       meshTargets);
+    addSection(src->meshWeights,       sizeof(float)            * srcMax.meshWeights,       meshWeights);
+    addSection(src->nodes,             sizeof(Node)             * srcMax.nodes,             nodes);
+    addSection(src->nodeChildren,      sizeof(RelPtr<Node>)     * srcMax.nodeChildren,      nodeChildren);
+    addSection(src->nodeWeights,       sizeof(float)            * srcMax.nodeWeights,       nodeWeights);
+    addSection(src->nodeOrder,         sizeof(uint16_t)         * srcMax.nodes,             nodeOrder);
+    addSection(src->nodeParents,       sizeof(uint16_t)         * srcMax.nodes,             nodeParents);
+    addSection(src->nodeTranslations,  sizeof(glm::vec3)        * srcMax.nodes,             nodeTranslations);
+    addSection(src->nodeRotations,     sizeof(glm::quat)        * srcMax.nodes,             nodeRotations);
+    addSection(src->nodeScales,        sizeof(glm::vec3)        * srcMax.nodes,             nodeScales);
+    addSection(src->nodeMatrices,      sizeof(glm::mat4)        * srcMax.nodes,             nodeMatrices);
+    addSection(src->nodeWorlds,        sizeof(glm::mat4)        * srcMax.nodes,             nodeWorlds);
+    addSection(src->nodeNormals,       sizeof(glm::mat3)        * srcMax.nodes,             nodeNormals);
+    addSection(src->nodeDirty,         sizeof(uint8_t)          * srcMax.nodes,             nodeDirty);
+    addSection(src->nodeBounds,        sizeof(float) * NodeBoundsLanes * src->nodeLaneStride(), nodeBounds);
+    addSection(src->nodeVisible,       sizeof(uint8_t)          * src->nodeLaneStride(),    nodeVisible);
+    addSection(src->samplers,          sizeof(Sampler)          * srcMax.samplers,          samplers);
+    addSection(src->scenes,            sizeof(Scene)            * srcMax.scenes,            scenes);
+    addSection(src->skins,             sizeof(Skin)             * srcMax.skins,             skins);
+    addSection(src->textures,          sizeof(Texture)          * srcMax.textures,          textures);
+    addSection(src->rawData,                                      srcMax.rawDataLen,        rawData);
+
+    // how far whatever was at ptr in src moved. outside of src (mapped
+    // buffer data) stays put.
+    auto moved = [&sections, nSections](void const * ptr) -> ptrdiff_t {
+        int lo = 0;
+        int hi = nSections;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (sections[mid].end <= ptr) lo = mid + 1;
+            else hi = mid;
+        }
+        return (lo < nSections && sections[lo].begin <= ptr) ? sections[lo].moved : 0;
+    };
+    // link was memcpy'd from selfMoved bytes back, so it still targets src
+    // (shifted by selfMoved). point it at the target's new place.
+    auto fix = [&moved](auto & link, ptrdiff_t selfMoved) {
+        if (link == nullptr) return;
+        byte_t const * target = (byte_t const *)link.get() - selfMoved;
+        link = (decltype(link.get()))(target + moved(target));
+    };
+
+    ptrdiff_t m = moved(src);
+    fix(scene, m);
+    fix(copyright, m);
+    fix(generator, m);
+    fix(version, m);
+    fix(minVersion, m);
+    fix(loadedDirName, m);
+    #if DEBUG
+    fix(jsonStr, m);
+    #endif // DEBUG
 
-char const * Gobj::stringRelPtr(char const * str, Gobj * dst) const {
-    if (str == nullptr) return nullptr;
-    return (char const *)dst->strings->data() + (str - (char const *)strings->data());
-}
-Gobj::Accessor * Gobj::accessorRelPtr(Accessor * accessor, Gobj * dst) const {
-    if (accessor == nullptr) return nullptr;
-    return dst->accessors + (accessor - accessors);
-}
-Gobj::Animation * Gobj::animationRelPtr(Animation * animation, Gobj * dst) const {
-    if (animation == nullptr) return nullptr;
-    return dst->animations + (animation - animations);
-}
-Gobj::AnimationChannel * Gobj::animationChannelRelPtr(AnimationChannel * channel, Gobj * dst) const {
-    if (channel == nullptr) return nullptr;
-    return dst->animationChannels + (channel - animationChannels);
-}
-Gobj::AnimationSampler * Gobj::animationSamplerRelPtr(AnimationSampler * sampler, Gobj * dst) const {
-    if (sampler == nullptr) return nullptr;
-    return dst->animationSamplers + (sampler - animationSamplers);
-}
-Gobj::Buffer * Gobj::bufferRelPtr(Buffer * buffer, Gobj * dst) const {
-    if (buffer == nullptr) return nullptr;
-    return dst->buffers + (buffer - buffers);
-}
-Gobj::BufferView * Gobj::bufferViewRelPtr(BufferView * bufferView, Gobj * dst) const {
-    if (bufferView == nullptr) return nullptr;
-    return dst->bufferViews + (bufferView - bufferViews);
-}
-Gobj::Camera * Gobj::cameraRelPtr(Camera * camera, Gobj * dst) const {
-    if (camera == nullptr) return nullptr;
-    return dst->cameras + (camera - cameras);
-}
-Gobj::Image * Gobj::imageRelPtr(Image * image, Gobj * dst) const {
-    if (image == nullptr) return nullptr;
-    return dst->images + (image - images);
-}
-Gobj::Material * Gobj::materialRelPtr(Material * material, Gobj * dst) const {
-    if (material == nullptr) return nullptr;
-    return dst->materials + (material - materials);
-}
-Gobj::Mesh * Gobj::meshRelPtr(Mesh * mesh, Gobj * dst) const {
-    if (mesh == nullptr) return nullptr;
-    return dst->meshes + (mesh - meshes);
-}
-Gobj::MeshAttribute * Gobj::meshAttributeRelPtr(MeshAttribute * meshAttribute, Gobj * dst) const {
-    if (meshAttribute == nullptr) return nullptr;
-    return dst->meshAttributes + (meshAttribute - meshAttributes);
-}
-Gobj::MeshPrimitive * Gobj::meshPrimitiveRelPtr(MeshPrimitive * meshPrimitive, Gobj * dst) const {
-    if (meshPrimitive == nullptr) return nullptr;
-    return dst->meshPrimitives + (meshPrimitive - meshPrimitives);
-}
-Gobj::MeshTarget * Gobj::meshTargetRelPtr(MeshTarget * meshTarget, Gobj * dst) const {
-    if (meshTarget == nullptr) return nullptr;
-    return dst->meshTargets + (meshTarget - meshTargets);
-}
-float * Gobj::meshWeightRelPtr(float * meshWeight, Gobj * dst) const {
-    if (meshWeight == nullptr) return nullptr;
-    return dst->meshWeights + (meshWeight - meshWeights);
-}
-Gobj::Node * Gobj::nodeRelPtr(Node * node, Gobj * dst) const {
-    if (node == nullptr) return nullptr;
-    return dst->nodes + (node - nodes);
-}
-Gobj::Node ** Gobj::nodeChildrenRelPtr(Node ** nodeChildren, Gobj * dst) const {
-    if (nodeChildren == nullptr) return nullptr;
-    return dst->nodeChildren + (nodeChildren - this->nodeChildren);
-}
-float * Gobj::nodeWeightRelPtr(float * nodeWeight, Gobj * dst) const {
-    if (nodeWeight == nullptr) return nullptr;
-    return dst->nodeWeights + (nodeWeight - nodeWeights);
-}
-Gobj::Sampler * Gobj::samplerRelPtr(Sampler * sampler, Gobj * dst) const {
-    if (sampler == nullptr) return nullptr;
-    return dst->samplers + (sampler - samplers);
-}
-Gobj::Scene * Gobj::sceneRelPtr(Scene * scene, Gobj * dst) const {
-    if (scene == nullptr) return nullptr;
-    return dst->scenes + (scene - scenes);
-}
-Gobj::Skin * Gobj::skinRelPtr(Skin * skin, Gobj * dst) const {
-    if (skin == nullptr) return nullptr;
-    return dst->skins + (skin - skins);
-}
-Gobj::Texture * Gobj::textureRelPtr(Texture * texture, Gobj * dst) const {
-    if (texture == nullptr) return nullptr;
-    return dst->textures + (texture - textures);
-}
-byte_t * Gobj::rawDataRelPtr(byte_t * data, Gobj * dst) const {
-    if (data == nullptr) return nullptr;
-    return dst->rawData + (data - rawData);
+    m = moved(src->accessors);
+    for (uint16_t i = 0; i < counts.accessors && i < maxCounts.accessors; ++i) {
+        fix(accessors[i].bufferView, m);
+        fix(accessors[i].name, m);
+    }
+    m = moved(src->animations);
+    for (uint16_t i = 0; i < counts.animations && i < maxCounts.animations; ++i) {
+        fix(animations[i].channels, m);
+        fix(animations[i].samplers, m);
+        fix(animations[i].name, m);
+    }
+    m = moved(src->animationChannels);
+    for (uint16_t i = 0; i < counts.animationChannels && i < maxCounts.animationChannels; ++i) {
+        fix(animationChannels[i].sampler, m);
+        fix(animationChannels[i].node, m);
+    }
+    m = moved(src->animationSamplers);
+    for (uint16_t i = 0; i < counts.animationSamplers && i < maxCounts.animationSamplers; ++i) {
+        fix(animationSamplers[i].input, m);
+        fix(animationSamplers[i].output, m);
+    }
+    m = moved(src->buffers);
+    for (uint16_t i = 0; i < counts.buffers && i < maxCounts.buffers; ++i) {
+        fix(buffers[i].data, m);
+        fix(buffers[i].name, m);
+    }
+    m = moved(src->bufferViews);
+    for (uint16_t i = 0; i < counts.bufferViews && i < maxCounts.bufferViews; ++i) {
+        fix(bufferViews[i].buffer, m);
+        fix(bufferViews[i].name, m);
+    }
+    m = moved(src->cameras);
+    for (uint16_t i = 0; i < counts.cameras && i < maxCounts.cameras; ++i) {
+        fix(cameras[i].orthographic, m);
+        fix(cameras[i].perspective, m);
+        fix(cameras[i].name, m);
+    }
+    m = moved(src->images);
+    for (uint16_t i = 0; i < counts.images && i < maxCounts.images; ++i) {
+        fix(images[i].bufferView, m);
+        fix(images[i].uri, m);
+        fix(images[i].name, m);
+        fix(images[i].data, m);
+    }
+    m = moved(src->materials);
+    for (uint16_t i = 0; i < counts.materials && i < maxCounts.materials; ++i) {
+        fix(materials[i].emissiveTexture, m);
+        fix(materials[i].normalTexture, m);
+        fix(materials[i].occlusionTexture, m);
+        fix(materials[i].baseColorTexture, m);
+        fix(materials[i].metallicRoughnessTexture, m);
+        fix(materials[i].name, m);
+    }
+    m = moved(src->meshes);
+    for (uint16_t i = 0; i < counts.meshes && i < maxCounts.meshes; ++i) {
+        fix(meshes[i].primitives, m);
+        fix(meshes[i].weights, m);
+        fix(meshes[i].name, m);
+    }
+    m = moved(src->meshAttributes);
+    for (uint16_t i = 0; i < counts.meshAttributes && i < maxCounts.meshAttributes; ++i) {
+        fix(meshAttributes[i].accessor, m);
+    }
+    m = moved(src->meshPrimitives);
+    for (uint16_t i = 0; i < counts.meshPrimitives && i < maxCounts.meshPrimitives; ++i) {
+        fix(meshPrimitives[i].attributes, m);
+        fix(meshPrimitives[i].indices, m);
+        fix(meshPrimitives[i].material, m);
+        fix(meshPrimitives[i].targets, m);
+    }
+    m = moved(src->meshTargets);
+    for (uint16_t i = 0; i < counts.meshTargets && i < maxCounts.meshTargets; ++i) {
+        fix(meshTargets[i].attributes, m);
+    }
+    m = moved(src->nodes);
+    for (uint16_t i = 0; i < counts.nodes && i < maxCounts.nodes; ++i) {
+        fix(nodes[i].camera, m);
+        fix(nodes[i].children, m);
+        fix(nodes[i].skin, m);
+        fix(nodes[i].mesh, m);
+        fix(nodes[i].weights, m);
+        fix(nodes[i].name, m);
+        fix(nodes[i].matrix, m);
+        fix(nodes[i].rotation, m);
+        fix(nodes[i].scale, m);
+        fix(nodes[i].translation, m);
+        fix(nodes[i].world, m);
+        fix(nodes[i].normalMatrix, m);
+        fix(nodes[i].worldDirty, m);
+    }
+    m = moved(src->nodeChildren);
+    for (uint16_t i = 0; i < counts.nodeChildren && i < maxCounts.nodeChildren; ++i) {
+        fix(nodeChildren[i], m);
+    }
+    m = moved(src->samplers);
+    for (uint16_t i = 0; i < counts.samplers && i < maxCounts.samplers; ++i) {
+        fix(samplers[i].name, m);
+    }
+    m = moved(src->scenes);
+    for (uint16_t i = 0; i < counts.scenes && i < maxCounts.scenes; ++i) {
+        fix(scenes[i].nodes, m);
+    }
+    m = moved(src->skins);
+    for (uint16_t i = 0; i < counts.skins && i < maxCounts.skins; ++i) {
+        fix(skins[i].inverseBindMatrices, m);
+        fix(skins[i].skeleton, m);
+        fix(skins[i].joints, m);
+        fix(skins[i].name, m);
+    }
+    m = moved(src->textures);
+    for (uint16_t i = 0; i < counts.textures && i < maxCounts.textures; ++i) {
+        fix(textures[i].sampler, m);
+        fix(textures[i].source, m);
+        fix(textures[i].name, m);
+    }
+}
+
+void Gobj::resetRuntimeState() {
+    for (uint16_t i = 0; i < counts.accessors; ++i) {
+        accessors[i].renderHandle = UINT16_MAX;
+    }
+    for (uint16_t i = 0; i < counts.images; ++i) {
+        images[i].decoded = nullptr;
+    }
+    for (uint16_t i = 0; i < counts.textures; ++i) {
+        textures[i].renderHandle = UINT16_MAX;
+    }
 }
 
 bool Gobj::hasMemoryFor(Counts const & additionalCounts) const {
@@ -593,7 +628,7 @@ void Gobj::traverse(TraverseFns const & fns, glm::mat4 const & parentTransform)
 
 void Gobj::traverseNode(Node * node, TraverseFns const & fns, glm::mat4 const & parentTransform) {
     // calc global transform
-    glm::mat4 global = parentTransform * node->matrix;
+    glm::mat4 global = parentTransform * *node->matrix;
     // run node fn if present
     if (fns.eachNode) {
         fns.eachNode(node, global);
@@ -608,32 +643,306 @@ void Gobj::traverseNode(Node * node, TraverseFns const & fns, glm::mat4 const &
     }
 }
 
-void Gobj::updateBoundsForCurrentScene() {
-    traverse(
-        {.eachPosAccr = [this](Gobj::Accessor * accessor, glm::mat4 const & global) {
-            glm::vec4 min = global * glm::vec4{*(glm::vec3 *)accessor->min, 1.f};
-            glm::vec4 max = global * glm::vec4{*(glm::vec3 *)accessor->max, 1.f};
-            // check both min and max as global scale might have flipped things
-            // x min
-            if (bounds.min.x > min.x) bounds.min.x = min.x;
-            if (bounds.min.x > max.x) bounds.min.x = max.x;
-            // x max
-            if (bounds.max.x < max.x) bounds.max.x = max.x;
-            if (bounds.max.x < min.x) bounds.max.x = min.x;
-            // y min
-            if (bounds.min.y > min.y) bounds.min.y = min.y;
-            if (bounds.min.y > max.y) bounds.min.y = max.y;
-            // y max
-            if (bounds.max.y < max.y) bounds.max.y = max.y;
-            if (bounds.max.y < min.y) bounds.max.y = min.y;
-            // z min
-            if (bounds.min.z > min.z) bounds.min.z = min.z;
-            if (bounds.min.z > max.z) bounds.min.z = max.z;
-            // z max
-            if (bounds.max.z < max.z) bounds.max.z = max.z;
-            if (bounds.max.z < min.z) bounds.max.z = min.z;
-        }}
-    );
+/*
+Splits the node tree into enough independent pieces to keep every worker busy,
+then traverses the pieces in parallel. A piece is a run of sibling nodes that
+share a parent transform. Starting from the root nodes, pieces with more than
+one node are halved, and single-node pieces are visited here and replaced by
+their children, until there are enough pieces or nothing left to split.
+*/
+void Gobj::traverseParallel(TraverseFns const & fns, glm::mat4 const & parentTransform) {
+    // no scene, meshes are independent
+    if (scene == nullptr) {
+        mm.parallelFor(0, counts.meshes, 1, [this, &fns, &parentTransform](uint32_t begin, uint32_t end) {
+            for (uint32_t meshIndex = begin; meshIndex < end; ++meshIndex) {
+                (meshes + meshIndex)->traverse(fns, parentTransform);
+            }
+        });
+        return;
+    }
+
+    struct Piece {
+        RelPtr<Node> * nodes;
+        uint32_t nNodes;
+        glm::mat4 parentTransform;
+    };
+    static constexpr uint32_t MaxPieces = 256;
+    Piece pieces[MaxPieces];
+    uint32_t nPieces = 0;
+    uint32_t targetPieces = mm.jobs.threadCount() * 4;
+    if (targetPieces > MaxPieces) targetPieces = MaxPieces;
+
+    if (scene->nNodes) {
+        pieces[nPieces++] = {scene->nodes, (uint32_t)scene->nNodes, parentTransform};
+    }
+    for (uint32_t i = 0; nPieces && nPieces < targetPieces; i = (nPieces) ? (i + 1) % nPieces : 0) {
+        Piece & piece = pieces[i];
+        if (piece.nNodes > 1) {
+            uint32_t half = piece.nNodes / 2;
+            pieces[nPieces++] = {piece.nodes + half, piece.nNodes - half, piece.parentTransform};
+            piece.nNodes = half;
+            continue;
+        }
+        // visit single node, continue with its children
+        Node * node = piece.nodes[0];
+        glm::mat4 global = piece.parentTransform * *node->matrix;
+        if (fns.eachNode) {
+            fns.eachNode(node, global);
+        }
+        if (node->mesh) {
+            node->mesh->traverse(fns, global);
+        }
+        if (node->nChildren) {
+            piece = {node->children, (uint32_t)node->nChildren, global};
+        }
+        else {
+            piece = pieces[--nPieces];
+        }
+    }
+
+    mm.parallelFor(0, nPieces, 1, [this, &fns, &pieces](uint32_t begin, uint32_t end) {
+        for (uint32_t pieceIndex = begin; pieceIndex < end; ++pieceIndex) {
+            Piece const & piece = pieces[pieceIndex];
+            for (uint32_t nodeIndex = 0; nodeIndex < piece.nNodes; ++nodeIndex) {
+                traverseNode(piece.nodes[nodeIndex], fns, piece.parentTransform);
+            }
+        }
+    });
+}
+
+void Gobj::updateBoundsForCurrentScene(bool parallel) {
+    // each thread grows its own bounds, merged after
+    AABB threadBounds[JobSystem::MaxThreads + 1];
+    auto eachPosAccr = [&threadBounds](Gobj::Accessor * accessor, glm::mat4 const & global) {
+        AABB & bounds = threadBounds[JobSystem::threadIndex() + 1];
+        glm::vec4 min = global * glm::vec4{*(glm::vec3 *)accessor->min, 1.f};
+        glm::vec4 max = global * glm::vec4{*(glm::vec3 *)accessor->max, 1.f};
+        // check both min and max as global scale might have flipped things
+        // x min
+        if (bounds.min.x > min.x) bounds.min.x = min.x;
+        if (bounds.min.x > max.x) bounds.min.x = max.x;
+        // x max
+        if (bounds.max.x < max.x) bounds.max.x = max.x;
+        if (bounds.max.x < min.x) bounds.max.x = min.x;
+        // y min
+        if (bounds.min.y > min.y) bounds.min.y = min.y;
+        if (bounds.min.y > max.y) bounds.min.y = max.y;
+        // y max
+        if (bounds.max.y < max.y) bounds.max.y = max.y;
+        if (bounds.max.y < min.y) bounds.max.y = min.y;
+        // z min
+        if (bounds.min.z > min.z) bounds.min.z = min.z;
+        if (bounds.min.z > max.z) bounds.min.z = max.z;
+        // z max
+        if (bounds.max.z < max.z) bounds.max.z = max.z;
+        if (bounds.max.z < min.z) bounds.max.z = min.z;
+    };
+
+    if (parallel) {
+        traverseParallel({.eachPosAccr = eachPosAccr});
+    }
+    else {
+        traverse({.eachPosAccr = eachPosAccr});
+    }
+
+    for (AABB const & tb : threadBounds) {
+        bounds.min = glm::min(bounds.min, tb.min);
+        bounds.max = glm::max(bounds.max, tb.max);
+    }
+}
+
+/*
+Slots are handed out breadth first, every scene's roots before their
+descendants, so a parent's slot always comes before its children's. Trees no
+scene reaches follow, then anything left over (only in a malformed, cyclic
+hierarchy) as its own root. Node structs stay where they are, only their
+transforms move to new slots, along with the nodes' links to them.
+*/
+void Gobj::flattenNodes() {
+    uint16_t const n = counts.nodes;
+    if (n == 0) {
+        nFlatNodes = 0;
+        ++flattenCount;
+        return;
+    }
+
+    // transforms as they are now, by node index, and per-node flags
+    struct Transform {
+        glm::mat4 matrix;
+        glm::quat rotation;
+        glm::vec3 scale;
+        glm::vec3 translation;
+    };
+    enum : uint8_t {
+        FLAG_HAS_PARENT = 0x1,
+        FLAG_QUEUED     = 0x2,
+    };
+    size_t const scratchSize = sizeof(Transform) * n + n;
+    byte_t * scratch = (byte_t *)mm.memMan.request({.size = scratchSize, .align = alignof(Transform), .high = true});
+    if (scratch == nullptr) {
+        fprintf(stderr, "Not enough memory to flatten %u nodes.\n", n);
+        return;
+    }
+    Transform * prev = (Transform *)scratch;
+    uint8_t * flags = scratch + sizeof(Transform) * n;
+    memset(flags, 0, n);
+    for (uint16_t i = 0; i < n; ++i) {
+        Node const & node = nodes[i];
+        prev[i] = {*node.matrix, *node.rotation, *node.scale, *node.translation};
+        for (int c = 0; c < node.nChildren; ++c) {
+            size_t childIndex = node.children[c] - nodes;
+            if (childIndex < n) flags[childIndex] |= FLAG_HAS_PARENT;
+        }
+    }
+
+    // order doubles as the breadth first queue
+    uint16_t tail = 0;
+    auto push = [this, n, flags, &tail](Node const * node, uint16_t parentSlot) {
+        size_t index = node - nodes;
+        if (index >= n || (flags[index] & FLAG_QUEUED)) return;
+        flags[index] |= FLAG_QUEUED;
+        nodeOrder[tail] = (uint16_t)index;
+        nodeParents[tail] = parentSlot;
+        ++tail;
+    };
+    uint16_t head = 0;
+    auto drain = [this, &push, &head, &tail]() {
+        for (; head < tail; ++head) {
+            Node const & node = nodes[nodeOrder[head]];
+            for (int c = 0; c < node.nChildren; ++c) {
+                push(node.children[c], head);
+            }
+        }
+    };
+    for (uint16_t s = 0; s < counts.scenes; ++s) {
+        for (int r = 0; r < scenes[s].nNodes; ++r) {
+            push(scenes[s].nodes[r], NoParent);
+        }
+    }
+    drain();
+    for (uint8_t skipFlags : {(uint8_t)(FLAG_QUEUED | FLAG_HAS_PARENT), (uint8_t)FLAG_QUEUED}) {
+        for (uint16_t i = 0; i < n; ++i) {
+            if (flags[i] & skipFlags) continue;
+            push(nodes + i, NoParent);
+            drain();
+        }
+    }
+    assert(tail == n && "Every node should have a slot.");
+
+    // move transforms to their new slots, and point nodes at them
+    for (uint16_t slot = 0; slot < n; ++slot) {
+        Node & node = nodes[nodeOrder[slot]];
+        Transform const & t = prev[nodeOrder[slot]];
+        nodeMatrices[slot] = t.matrix;
+        nodeRotations[slot] = t.rotation;
+        nodeScales[slot] = t.scale;
+        nodeTranslations[slot] = t.translation;
+        nodeDirty[slot] = 1;
+        node.matrix = nodeMatrices + slot;
+        node.rotation = nodeRotations + slot;
+        node.scale = nodeScales + slot;
+        node.translation = nodeTranslations + slot;
+        node.world = nodeWorlds + slot;
+        node.normalMatrix = nodeNormals + slot;
+        node.worldDirty = nodeDirty + slot;
+    }
+    nFlatNodes = n;
+    ++flattenCount;
+
+    mm.memMan.request({.ptr = scratch});
+}
+
+/*
+One pass over the slots, parents always first. A parent's world is final by
+the time its children read it, and or-ing in the parent's flag carries a
+change down the whole subtree. Flags are cleared once every slot has seen its
+parent's.
+
+A dirty slot's world box is its mesh's local box, transformed: the center by
+the world matrix, the half extents by the absolute of its 3x3 part. Slots
+without a mesh get an empty box, and meshes with unknown bounds an infinite
+one, so they are never culled.
+*/
+void Gobj::updateWorldMatrices() {
+    if (nFlatNodes != counts.nodes) {
+        updateMeshBounds();
+        flattenNodes();
+    }
+    uint16_t const n = nFlatNodes;
+    uint16_t const * parents = nodeParents;
+    glm::mat4 const * matrices = nodeMatrices;
+    glm::mat4 * worlds = nodeWorlds;
+    glm::mat3 * normals = nodeNormals;
+    uint8_t * dirty = nodeDirty;
+    size_t const stride = nodeLaneStride();
+    float * cx = nodeBounds;
+    float * cy = cx + stride;
+    float * cz = cy + stride;
+    float * ex = cz + stride;
+    float * ey = ex + stride;
+    float * ez = ey + stride;
+    for (uint16_t i = 0; i < n; ++i) {
+        uint16_t parent = parents[i];
+        if (parent != NoParent) {
+            dirty[i] |= dirty[parent];
+        }
+        if (!dirty[i]) {
+            continue;
+        }
+        glm::mat4 const & world = worlds[i] = (parent != NoParent) ? worlds[parent] * matrices[i] : matrices[i];
+        normals[i] = glm::transpose(glm::inverse(glm::mat3{world}));
+
+        glm::vec3 center{0.f};
+        glm::vec3 extents{0.f};
+        Mesh const * mesh = nodes[nodeOrder[i]].mesh;
+        if (mesh && mesh->bounds.min.x > mesh->bounds.max.x) {
+            extents = glm::vec3{FLT_MAX};
+        }
+        else if (mesh) {
+            glm::vec3 localExtents = (mesh->bounds.max - mesh->bounds.min) * .5f;
+            center = glm::vec3{world * glm::vec4{mesh->bounds.center(), 1.f}};
+            extents =
+                glm::abs(glm::vec3{world[0]}) * localExtents.x +
+                glm::abs(glm::vec3{world[1]}) * localExtents.y +
+                glm::abs(glm::vec3{world[2]}) * localExtents.z;
+        }
+        cx[i] = center.x; cy[i] = center.y; cz[i] = center.z;
+        ex[i] = extents.x; ey[i] = extents.y; ez[i] = extents.z;
+    }
+    if (n) {
+        memset(dirty, 0, n);
+    }
+}
+
+void Gobj::updateMeshBounds() {
+    for (uint16_t m = 0; m < counts.meshes; ++m) {
+        Mesh & mesh = meshes[m];
+        mesh.bounds.min = glm::vec3{+FLT_MAX};
+        mesh.bounds.max = glm::vec3{-FLT_MAX};
+        bool known = true;
+        for (int p = 0; p < mesh.nPrimitives; ++p) {
+            MeshPrimitive & prim = mesh.primitives[p];
+            prim.bounds.min = glm::vec3{+FLT_MAX};
+            prim.bounds.max = glm::vec3{-FLT_MAX};
+            for (int a = 0; a < prim.nAttributes; ++a) {
+                Accessor const * acc = prim.attributes[a].accessor;
+                if (prim.attributes[a].type != ATTR_POSITION || acc == nullptr || acc->count == 0) continue;
+                prim.bounds.min = glm::vec3{acc->min[0], acc->min[1], acc->min[2]};
+                prim.bounds.max = glm::vec3{acc->max[0], acc->max[1], acc->max[2]};
+                break;
+            }
+            if (prim.bounds.min.x > prim.bounds.max.x) {
+                known = false;
+                continue;
+            }
+            mesh.bounds.min = glm::min(mesh.bounds.min, prim.bounds.min);
+            mesh.bounds.max = glm::max(mesh.bounds.max, prim.bounds.max);
+        }
+        if (!known) {
+            mesh.bounds.min = glm::vec3{+FLT_MAX};
+            mesh.bounds.max = glm::vec3{-FLT_MAX};
+        }
+    }
 }
 
 Gobj::Scene * Gobj::addScene(char const * name, bool makeDefault) {
@@ -652,7 +961,7 @@ Gobj::Scene * Gobj::addScene(char const * name, bool makeDefault) {
     return s;
 }
 
-Gobj::Node ** Gobj::addNodeChildren(uint16_t nNodes) {
+RelPtr<Gobj::Node> * Gobj::addNodeChildren(uint16_t nNodes) {
     if (counts.nodeChildren + nNodes > maxCounts.nodeChildren) {
         fprintf(stderr, "Not enough room to create %u node children.\n", nNodes);
         return nullptr;
@@ -662,7 +971,7 @@ Gobj::Node ** Gobj::addNodeChildren(uint16_t nNodes) {
         return nullptr;
     }
     // mark the start of the nodeChildren array
-    Node ** ret = nodeChildren + counts.nodeChildren;
+    RelPtr<Node> * ret = nodeChildren + counts.nodeChildren;
     // populate array with nodes, incrementing count of used nodes
     for (uint16_t i = 0; i < nNodes; ++i, ++counts.nodes) {
         ret[i] = nodes + counts.nodes;
@@ -927,8 +1236,19 @@ size_t Gobj::Counts::totalSize() const {
         ALIGN_SIZE(sizeof(Gobj::MeshTarget)        * meshTargets) +
         ALIGN_SIZE(sizeof(float)                   * meshWeights) +
         ALIGN_SIZE(sizeof(Gobj::Node)              * nodes) +
-        ALIGN_SIZE(sizeof(Gobj::Node *)            * nodeChildren) +
+        ALIGN_SIZE(sizeof(RelPtr<Gobj::Node>)      * nodeChildren) +
         ALIGN_SIZE(sizeof(float)                   * nodeWeights) +
+        ALIGN_SIZE(sizeof(uint16_t)                * nodes) + // order
+        ALIGN_SIZE(sizeof(uint16_t)                * nodes) + // parents
+        ALIGN_SIZE(sizeof(glm::vec3)               * nodes) + // translations
+        ALIGN_SIZE(sizeof(glm::quat)               * nodes) + // rotations
+        ALIGN_SIZE(sizeof(glm::vec3)               * nodes) + // scales
+        ALIGN_SIZE(sizeof(glm::mat4)               * nodes) + // matrices
+        ALIGN_SIZE(sizeof(glm::mat4)               * nodes) + // worlds
+        ALIGN_SIZE(sizeof(glm::mat3)               * nodes) + // normals
+        ALIGN_SIZE(sizeof(uint8_t)                 * nodes) + // dirty
+        ALIGN_SIZE(sizeof(float) * NodeBoundsLanes * nodeLaneStride(nodes)) + // bounds
+        ALIGN_SIZE(sizeof(uint8_t)                 * nodeLaneStride(nodes)) + // visible
         ALIGN_SIZE(sizeof(Gobj::Sampler)           * samplers) +
         ALIGN_SIZE(sizeof(Gobj::Scene)             * scenes) +
         ALIGN_SIZE(sizeof(Gobj::Skin)              * skins) +
@@ -943,6 +1263,33 @@ Gobj::Counts Gobj::Counts::operator+(Counts const & other) const {
     return ret;
 }
 
+bool Gobj::Counts::operator==(Counts const & other) const {
+    return
+        allStrLen          == other.allStrLen &&
+        accessors          == other.accessors &&
+        animations         == other.animations &&
+        animationChannels  == other.animationChannels &&
+        animationSamplers  == other.animationSamplers &&
+        buffers            == other.buffers &&
+        bufferViews        == other.bufferViews &&
+        cameras            == other.cameras &&
+        images             == other.images &&
+        materials          == other.materials &&
+        meshes             == other.meshes &&
+        meshAttributes     == other.meshAttributes &&
+        meshPrimitives     == other.meshPrimitives &&
+        meshTargets        == other.meshTargets &&
+        meshWeights        == other.meshWeights &&
+        nodes              == other.nodes &&
+        nodeChildren       == other.nodeChildren &&
+        nodeWeights        == other.nodeWeights &&
+        samplers           == other.samplers &&
+        scenes             == other.scenes &&
+        skins              == other.skins &&
+        textures           == other.textures &&
+        rawDataLen         == other.rawDataLen;
+}
+
 Gobj::Counts & Gobj::Counts::operator+=(Counts const & other) {
     allStrLen          += other.allStrLen;
     accessors          += other.accessors;
@@ -1010,14 +1357,49 @@ float Gobj::Accessor::componentValue(uint32_t index, uint8_t componentIndex) con
     }
 }
 
-void Gobj::Accessor::updateMinMax() {
+void Gobj::Accessor::updateMinMax(bool parallel) {
+    static constexpr uint32_t MinGrain = 1024*4;
+    static constexpr uint32_t MaxChunks = 64;
+
     uint8_t cc = componentCount();
-    for (uint32_t i = 0; i < count; ++i) {
+    uint32_t grain = (count + MaxChunks - 1) / MaxChunks;
+    if (grain < MinGrain) grain = MinGrain;
+
+    if (!parallel || count <= grain) {
+        for (uint32_t i = 0; i < count; ++i) {
+            for (uint8_t c = 0; c < cc; ++c) {
+                float fval = componentValue(i, c);
+                if (min[c] > fval) min[c] = fval;
+                if (max[c] < fval) max[c] = fval;
+                // printl("i: %u, c: %u, %f", i, c, fval);
+            }
+        }
+        return;
+    }
+
+    // each chunk finds its own min/max, merged after
+    float chunkMin[MaxChunks][16];
+    float chunkMax[MaxChunks][16];
+    uint32_t nChunks = (count + grain - 1) / grain;
+    mm.parallelFor(0, count, grain, [&](uint32_t begin, uint32_t end) {
+        float * cmin = chunkMin[begin / grain];
+        float * cmax = chunkMax[begin / grain];
+        for (uint8_t c = 0; c < cc; ++c) {
+            cmin[c] = min[c];
+            cmax[c] = max[c];
+        }
+        for (uint32_t i = begin; i < end; ++i) {
+            for (uint8_t c = 0; c < cc; ++c) {
+                float fval = componentValue(i, c);
+                if (cmin[c] > fval) cmin[c] = fval;
+                if (cmax[c] < fval) cmax[c] = fval;
+            }
+        }
+    });
+    for (uint32_t chunk = 0; chunk < nChunks; ++chunk) {
         for (uint8_t c = 0; c < cc; ++c) {
-            float fval = componentValue(i, c);
-            if (min[c] > fval) min[c] = fval;
-            if (max[c] < fval) max[c] = fval;
-            // printl("i: %u, c: %u, %f", i, c, fval);
+            if (min[c] > chunkMin[chunk][c]) min[c] = chunkMin[chunk][c];
+            if (max[c] < chunkMax[chunk][c]) max[c] = chunkMax[chunk][c];
         }
     }
 }
@@ -1035,10 +1417,10 @@ char * Gobj::Accessor::printToFrameStack(int indent) const {
     FrameStack & fs = *mm.frameStack;
     char * str = (char *)fs.dataHead();
 
-    fs.formatPen("%*sAccessor: %s (%p)\n", indent,"", name, this);
+    fs.formatPen("%*sAccessor: %s (%p)\n", indent,"", name.get(), this);
     fs.formatPen("%*s    count: %u\n", indent,"", count);
     fs.formatPen("%*s    byteOffset: %u\n", indent,"", byteOffset);
-    fs.formatPen("%*s    buffer: %p-%p\n", indent,"", bufferView->buffer->data, bufferView->buffer->data + bufferView->buffer->byteLength);
+    fs.formatPen("%*s    buffer: %p-%p\n", indent,"", bufferView->buffer->data.get(), bufferView->buffer->data + bufferView->buffer->byteLength);
     fs.formatPen("%*s    buffer byteLength: %u\n", indent,"", bufferView->buffer->byteLength);
     fs.formatPen("%*s    bufferView byteLength: %u\n", indent,"", bufferView->byteLength);
     fs.formatPen("%*s    bufferView byteOffset: %u\n", indent,"", bufferView->byteOffset);
@@ -1124,7 +1506,7 @@ char * Gobj::MeshAttribute::printToFrameStack(int indent) const {
 
 void Gobj::Node::syncMatrixTRS(bool syncChildren) {
     // is identity?
-    if (matrix == glm::mat4{1.f}) {
+    if (*matrix == glm::mat4{1.f}) {
         // TRS -> matrix
         setTRSToMatrix(syncChildren);
     }
@@ -1137,7 +1519,8 @@ void Gobj::Node::syncMatrixTRS(bool syncChildren) {
 void Gobj::Node::setMatrixToTRS(bool syncChildren) {
     glm::vec3 skew;
     glm::vec4 perspective;
-    glm::decompose(matrix, scale, rotation, translation, skew, perspective);
+    glm::decompose(*matrix, *scale, *rotation, *translation, skew, perspective);
+    markDirty();
 
     // process children too?
     if (syncChildren) {
@@ -1148,10 +1531,12 @@ void Gobj::Node::setMatrixToTRS(bool syncChildren) {
 }
 
 void Gobj::Node::setTRSToMatrix(bool syncChildren) {
-    matrix = glm::mat4{1.f};
-    matrix = glm::translate(matrix, translation);
-    matrix *= glm::mat4_cast(rotation);
-    matrix = glm::scale(matrix, scale);
+    glm::mat4 m{1.f};
+    m = glm::translate(m, *translation);
+    m *= glm::mat4_cast(*rotation);
+    m = glm::scale(m, *scale);
+    *matrix = m;
+    markDirty();
 
     // process children too?
     if (syncChildren) {
@@ -1161,6 +1546,10 @@ void Gobj::Node::setTRSToMatrix(bool syncChildren) {
     }
 }
 
+void Gobj::Node::markDirty() {
+    *worldDirty = 1;
+}
+
 Gobj::Accessor::Type Gobj::accessorTypeFromStr(char const * str) {
     if (strEqu(str, "SCALAR")) return Accessor::TYPE_SCALAR;
     if (strEqu(str, "VEC2"  )) return Accessor::TYPE_VEC2;
@@ -1329,36 +1718,36 @@ char * Gobj::printToFrameStack() const {
 
     char * str = (char *)fs.dataHead();
 
-    fs.formatPen("strings     %011p (%u/%u)\n", strings,           counts.allStrLen,            maxCounts.allStrLen);
-    fs.formatPen("Accessors   %011p (%u/%u)\n", accessors,         counts.accessors,            maxCounts.accessors);
-    fs.formatPen("Animation   %011p (%u/%u)\n", animations,        counts.animations,           maxCounts.animations);
-    fs.formatPen("AChannels   %011p (%u/%u)\n", animationChannels, counts.animationChannels,    maxCounts.animationChannels);
-    fs.formatPen("ASamplers   %011p (%u/%u)\n", animationSamplers, counts.animationSamplers,    maxCounts.animationSamplers);
-    fs.formatPen("Buffers     %011p (%u/%u)\n", buffers,           counts.buffers,              maxCounts.buffers);
-    fs.formatPen("BufferViews %011p (%u/%u)\n", bufferViews,       counts.bufferViews,          maxCounts.bufferViews);
-    fs.formatPen("Cameras     %011p (%u/%u)\n", cameras,           counts.cameras,              maxCounts.cameras);
-    fs.formatPen("Images      %011p (%u/%u)\n", images,            counts.images,               maxCounts.images);
-    fs.formatPen("Materials   %011p (%u/%u)\n", materials,         counts.materials,            maxCounts.materials);
-    fs.formatPen("Meshs       %011p (%u/%u)\n", meshes,            counts.meshes,               maxCounts.meshes);
-    fs.formatPen("MAttributes %011p (%u/%u)\n", meshAttributes,    counts.meshAttributes,       maxCounts.meshAttributes);
-    fs.formatPen("MPrimitives %011p (%u/%u)\n", meshPrimitives,    counts.meshPrimitives,       maxCounts.meshPrimitives);
-    fs.formatPen("MTargets    %011p (%u/%u)\n", meshTargets,       counts.meshTargets,          maxCounts.meshTargets);
-    fs.formatPen("MWeights    %011p (%u/%u)\n", meshWeights,       counts.meshWeights,          maxCounts.meshWeights);
-    fs.formatPen("Nodes       %011p (%u/%u)\n", nodes,             counts.nodes,                maxCounts.nodes);
-    fs.formatPen("Node Kids   %011p (%u/%u)\n", nodeChildren,      counts.nodeChildren,         maxCounts.nodeChildren);
-    fs.formatPen("NWeights    %011p (%u/%u)\n", nodeWeights,       counts.nodeWeights,          maxCounts.nodeWeights);
-    fs.formatPen("Samplers    %011p (%u/%u)\n", samplers,          counts.samplers,             maxCounts.samplers);
-    fs.formatPen("Scenes      %011p (%u/%u)\n", scenes,            counts.scenes,               maxCounts.scenes);
-    fs.formatPen("Skins       %011p (%u/%u)\n", skins,             counts.skins,                maxCounts.skins);
-    fs.formatPen("Textures    %011p (%u/%u)\n", textures,          counts.textures,             maxCounts.textures);
-    fs.formatPen("raw data    %011p (%u/%u)\n", rawData,           counts.rawDataLen,           maxCounts.rawDataLen);
-
-    fs.formatPen("scene       %011p (%zu)\n", scene, scene - scenes);
-
-    fs.formatPen("copyright:  %s\n", copyright);
-    fs.formatPen("generator:  %s\n", generator);
-    fs.formatPen("version:    %s\n", version);
-    fs.formatPen("minVersion: %s\n", minVersion);
+    fs.formatPen("strings     %011p (%u/%u)\n", strings.get(),            counts.allStrLen,            maxCounts.allStrLen);
+    fs.formatPen("Accessors   %011p (%u/%u)\n", accessors.get(),          counts.accessors,            maxCounts.accessors);
+    fs.formatPen("Animation   %011p (%u/%u)\n", animations.get(),         counts.animations,           maxCounts.animations);
+    fs.formatPen("AChannels   %011p (%u/%u)\n", animationChannels.get(),  counts.animationChannels,    maxCounts.animationChannels);
+    fs.formatPen("ASamplers   %011p (%u/%u)\n", animationSamplers.get(),  counts.animationSamplers,    maxCounts.animationSamplers);
+    fs.formatPen("Buffers     %011p (%u/%u)\n", buffers.get(),            counts.buffers,              maxCounts.buffers);
+    fs.formatPen("BufferViews %011p (%u/%u)\n", bufferViews.get(),        counts.bufferViews,          maxCounts.bufferViews);
+    fs.formatPen("Cameras     %011p (%u/%u)\n", cameras.get(),            counts.cameras,              maxCounts.cameras);
+    fs.formatPen("Images      %011p (%u/%u)\n", images.get(),             counts.images,               maxCounts.images);
+    fs.formatPen("Materials   %011p (%u/%u)\n", materials.get(),          counts.materials,            maxCounts.materials);
+    fs.formatPen("Meshs       %011p (%u/%u)\n", meshes.get(),             counts.meshes,               maxCounts.meshes);
+    fs.formatPen("MAttributes %011p (%u/%u)\n", meshAttributes.get(),     counts.meshAttributes,       maxCounts.meshAttributes);
+    fs.formatPen("MPrimitives %011p (%u/%u)\n", meshPrimitives.get(),     counts.meshPrimitives,       maxCounts.meshPrimitives);
+    fs.formatPen("MTargets    %011p (%u/%u)\n", meshTargets.get(),        counts.meshTargets,          maxCounts.meshTargets);
+    fs.formatPen("MWeights    %011p (%u/%u)\n", meshWeights.get(),        counts.meshWeights,          maxCounts.meshWeights);
+    fs.formatPen("Nodes       %011p (%u/%u)\n", nodes.get(),              counts.nodes,                maxCounts.nodes);
+    fs.formatPen("Node Kids   %011p (%u/%u)\n", nodeChildren.get(),       counts.nodeChildren,         maxCounts.nodeChildren);
+    fs.formatPen("NWeights    %011p (%u/%u)\n", nodeWeights.get(),        counts.nodeWeights,          maxCounts.nodeWeights);
+    fs.formatPen("Samplers    %011p (%u/%u)\n", samplers.get(),           counts.samplers,             maxCounts.samplers);
+    fs.formatPen("Scenes      %011p (%u/%u)\n", scenes.get(),             counts.scenes,               maxCounts.scenes);
+    fs.formatPen("Skins       %011p (%u/%u)\n", skins.get(),              counts.skins,                maxCounts.skins);
+    fs.formatPen("Textures    %011p (%u/%u)\n", textures.get(),           counts.textures,             maxCounts.textures);
+    fs.formatPen("raw data    %011p (%u/%u)\n", rawData.get(),            counts.rawDataLen,           maxCounts.rawDataLen);
+
+    fs.formatPen("scene       %011p (%zu)\n", scene.get(), scene - scenes);
+
+    fs.formatPen("copyright:  %s\n", copyright.get());
+    fs.formatPen("generator:  %s\n", generator.get());
+    fs.formatPen("version:    %s\n", version.get());
+    fs.formatPen("minVersion: %s\n", minVersion.get());
 
     fs.formatPen("bounds min: %14.6f,%14.6f,%14.6f\n", bounds.min.x, bounds.min.y, bounds.min.z);
     fs.formatPen("bounds max: %14.6f,%14.6f,%14.6f\n", bounds.max.x, bounds.max.y, bounds.max.z);
@@ -1,12 +1,15 @@
 #pragma once
 #include <mutex>
 #include <stddef.h>
+#include <stdio.h>
+#include <glm/mat3x3.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include "../common/AABB.h"
 #include "../common/debug_defines.h"
 #include "../common/types.h"
+#include "RelPtr.h"
 
 /*
 Gobj (game object, "gobject")
@@ -18,8 +21,29 @@ MemMan. Use GLTFLoader::calculateSize to determine size beforehand.
 Supports buffers (maxCounts) larger than actual number (counts) of sub-objects,
 so that Gobjs can be created with in-place-room to grow.
 
-If copy is necessary (growing too much, etc) use `copy` function, which will
-perform a deep copy and translate sub-object pointers.
+Every link between parts of a Gobj (sub-objects, strings, raw data, and the
+storage pointers themselves) is a RelPtr, an offset from the link's own
+address. So the whole block can be moved or memcpy'd and stays valid. Nothing
+inside may link outside the block, except buffer data in mappedFile.
+
+If copy is necessary (growing too much, etc) use `copy` function. With the same
+maxCounts it is a single memcpy, otherwise a memcpy per section plus one pass
+to shift links between sections that moved by different amounts.
+
+A loaded Gobj can be baked: its block written to disk as is, and loaded back
+with one read and no pointer fix-up (see MemMan::createBakedGobj).
+
+Large GLBs can be loaded with their buffer pointing into a memory-mapped file
+(mappedFile) instead of raw buffer. The mapping is released with the Gobj.
+
+Node transforms (TRS, local matrix, world and normal matrices) are kept apart
+from the Nodes, as parallel arrays in flattened order: breadth first, so every
+parent's slot comes before its children's (see flattenNodes). World matrices
+are then updated in one linear pass. Each Node links to its own slot.
+
+Each slot also keeps the world AABB of its node's mesh, for frustum culling.
+These are stored as lanes of floats (center x, y, z, half extents x, y, z),
+each nodeLaneStride() long, so renderers can test several boxes at once.
 
 Visual data closely mirrors the GLTF spec.
 https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html
@@ -110,14 +134,41 @@ Node
 Node
 ...
 ----------------------------------------
-Node *                                  // Node children
-Node *
+RelPtr<Node>                            // Node children
+RelPtr<Node>
 ...
 ----------------------------------------
 float                                   // Node weights
 float
 ...
 ----------------------------------------
+uint16_t                                // Node flat order (node index per slot)
+...
+----------------------------------------
+uint16_t                                // Node parents (parent slot per slot)
+...
+----------------------------------------
+glm::vec3                               // Node translations
+...
+----------------------------------------
+glm::quat                               // Node rotations
+...
+----------------------------------------
+glm::vec3                               // Node scales
+...
+----------------------------------------
+glm::mat4                               // Node matrices (local)
+...
+----------------------------------------
+glm::mat4                               // Node worlds
+...
+----------------------------------------
+glm::mat3                               // Node normal matrices
+...
+----------------------------------------
+uint8_t                                 // Node world dirty flags
+...
+----------------------------------------
 Sampler
 Sampler
 ...
@@ -136,13 +187,14 @@ Texture
 ----------------------------------------
 raw data                                // buffer data, image data, etc.
                                         // anything that loaded externally or from base64 data.
-                                        // for now, just buffer data, as images are not loaded
-                                        // to main memory.
+                                        // images only when from data URIs, others are not
+                                        // loaded to main memory.
 ----------------------------------------
 
 */
 
 // forward
+class File;
 class FrameStack;
 
 class Gobj {
@@ -150,6 +202,11 @@ class Gobj {
 // STATIC CONSTANTS
 public:
     static constexpr size_t Align = 16;
+    // node slot of scene roots' parent
+    static constexpr uint16_t NoParent = UINT16_MAX;
+    // node bounds lanes are padded to a multiple of this, for SIMD batches
+    static constexpr uint16_t NodeLaneAlign = 8;
+    static constexpr int NodeBoundsLanes = 6;
 
 // -------------------------------------------------------------------------- //
 // FORWARD
@@ -208,6 +265,8 @@ public:
 
         Counts operator+(Counts const & other) const;
         Counts & operator+=(Counts const & other);
+        bool operator==(Counts const & other) const;
+        bool operator!=(Counts const & other) const { return !(*this == other); }
 
         #if DEBUG || DEV_INTERFACE
         void print() const;
@@ -267,47 +326,72 @@ private:
 // -------------------------------------------------------------------------- //
 // STORAGE
 public:
-    FrameStack       * strings           = nullptr;
-    Accessor         * accessors         = nullptr;
-    Animation        * animations        = nullptr;
-    AnimationChannel * animationChannels = nullptr;
-    AnimationSampler * animationSamplers = nullptr;
-    Buffer           * buffers           = nullptr;
-    BufferView       * bufferViews       = nullptr;
-    Camera           * cameras           = nullptr;
-    Image            * images            = nullptr;
-    Material         * materials         = nullptr;
-    Mesh             * meshes            = nullptr;
-    MeshAttribute    * meshAttributes    = nullptr;
-    MeshPrimitive    * meshPrimitives    = nullptr;
-    MeshTarget       * meshTargets       = nullptr;
-    float            * meshWeights       = nullptr;
-    Node             * nodes             = nullptr;
-    Node *           * nodeChildren      = nullptr;
-    float            * nodeWeights       = nullptr;
-    Sampler          * samplers          = nullptr;
-    Scene            * scenes            = nullptr;
-    Skin             * skins             = nullptr;
-    Texture          * textures          = nullptr;
-    byte_t           * rawData           = nullptr;
+    RelPtr<FrameStack>       strings           = nullptr;
+    RelPtr<Accessor>         accessors         = nullptr;
+    RelPtr<Animation>        animations        = nullptr;
+    RelPtr<AnimationChannel> animationChannels = nullptr;
+    RelPtr<AnimationSampler> animationSamplers = nullptr;
+    RelPtr<Buffer>           buffers           = nullptr;
+    RelPtr<BufferView>       bufferViews       = nullptr;
+    RelPtr<Camera>           cameras           = nullptr;
+    RelPtr<Image>            images            = nullptr;
+    RelPtr<Material>         materials         = nullptr;
+    RelPtr<Mesh>             meshes            = nullptr;
+    RelPtr<MeshAttribute>    meshAttributes    = nullptr;
+    RelPtr<MeshPrimitive>    meshPrimitives    = nullptr;
+    RelPtr<MeshTarget>       meshTargets       = nullptr;
+    RelPtr<float>            meshWeights       = nullptr;
+    RelPtr<Node>             nodes             = nullptr;
+    RelPtr<RelPtr<Node>>     nodeChildren      = nullptr;
+    RelPtr<float>            nodeWeights       = nullptr;
+    // node transforms, by slot. sized by nodes.
+    RelPtr<uint16_t>         nodeOrder         = nullptr;
+    RelPtr<uint16_t>         nodeParents       = nullptr;
+    RelPtr<glm::vec3>        nodeTranslations  = nullptr;
+    RelPtr<glm::quat>        nodeRotations     = nullptr;
+    RelPtr<glm::vec3>        nodeScales        = nullptr;
+    RelPtr<glm::mat4>        nodeMatrices      = nullptr;
+    RelPtr<glm::mat4>        nodeWorlds        = nullptr;
+    RelPtr<glm::mat3>        nodeNormals       = nullptr;
+    RelPtr<uint8_t>          nodeDirty         = nullptr;
+    // world AABB by slot, NodeBoundsLanes lanes of nodeLaneStride() floats,
+    // and whether each slot passed the last cull
+    RelPtr<float>            nodeBounds        = nullptr;
+    RelPtr<uint8_t>          nodeVisible       = nullptr;
+    RelPtr<Sampler>          samplers          = nullptr;
+    RelPtr<Scene>            scenes            = nullptr;
+    RelPtr<Skin>             skins             = nullptr;
+    RelPtr<Texture>          textures          = nullptr;
+    RelPtr<byte_t>           rawData           = nullptr;
 
     Counts const maxCounts; // size of buffers
     Counts counts;          // actual count of active objects
 
-    Scene * scene = nullptr;
+    RelPtr<Scene> scene = nullptr;
+
+    // nodes in flattened order. if not counts.nodes, hierarchy is flattened
+    // again on next world update.
+    uint16_t nFlatNodes = 0;
+    // bumped whenever slots are handed out again, so anything holding on to
+    // slots can tell they moved
+    uint16_t flattenCount = 0;
 
     AABB bounds;
 
     // asset
-    char const * copyright = nullptr;
-    char const * generator = nullptr;
-    char const * version = nullptr;
-    char const * minVersion = nullptr;
+    RelPtr<char const> copyright = nullptr;
+    RelPtr<char const> generator = nullptr;
+    RelPtr<char const> version = nullptr;
+    RelPtr<char const> minVersion = nullptr;
+
+    RelPtr<char const> loadedDirName = nullptr;
 
-    char const * loadedDirName = nullptr;
+    // if set, buffer data may point into this mapping instead of rawData.
+    // released along with the Gobj.
+    File * mappedFile = nullptr;
 
     #if DEBUG
-    char const * jsonStr = nullptr;
+    RelPtr<char const> jsonStr = nullptr;
     #endif // DEBUG
 
 // -------------------------------------------------------------------------- //
@@ -315,12 +399,30 @@ public:
 public:
     void setStatus(Status status);
     bool isReadyToDraw() const;
+    bool isLoading() const;
     void copy(Gobj * srcGobj);
     bool hasMemoryFor(Counts const & counts) const;
     void traverse(                          TraverseFns const & params, glm::mat4 const & parentTransform = glm::mat4{1.f});
     void traverseNode(Node * node,          TraverseFns const & params, glm::mat4 const & parentTransform = glm::mat4{1.f});
     // void traverseMesh(Mesh * mesh,          TraverseFns const & params, glm::mat4 const & parentTransform = glm::mat4{1.f});
-    void updateBoundsForCurrentScene();
+    // same as traverse, but subtrees are split across job system workers.
+    // fns are called from multiple threads at once, in no particular order.
+    void traverseParallel(                  TraverseFns const & params, glm::mat4 const & parentTransform = glm::mat4{1.f});
+    void updateBoundsForCurrentScene(bool parallel = true);
+    // reorder node transform slots breadth first. call after changing
+    // hierarchy without adding nodes (loader does it after load).
+    void flattenNodes();
+    // refresh world and normal matrices, and world bounds, of dirty nodes
+    // and their subtrees, in every scene, in one pass over the slots
+    void updateWorldMatrices();
+    // set mesh and primitive bounds from their POSITION accessors' min/max.
+    // call after changing vertex data (loader does it after load).
+    void updateMeshBounds();
+    uint16_t nodeSlot(Node const * node) const { return (uint16_t)(node->matrix - nodeMatrices); }
+    size_t nodeLaneStride() const { return nodeLaneStride(maxCounts.nodes); }
+    static size_t nodeLaneStride(uint16_t nodes) {
+        return ((size_t)nodes + NodeLaneAlign - 1) / NodeLaneAlign * NodeLaneAlign;
+    }
 
 // CREATE SUB-OBJECT HELPERS
 public:
@@ -333,7 +435,7 @@ public:
     // they add the named object, plus sometimes 1-2 support objects
 
     Scene * addScene(char const * name = "", bool makeDefault = false);
-    Node ** addNodeChildren(uint16_t nNodes);
+    RelPtr<Node> * addNodeChildren(uint16_t nNodes);
     Node * addNode(char const * name = "");
     Mesh * addMesh(char const * name = "");
     MeshPrimitive * _addMeshPrimitive(int count, ...);
@@ -376,42 +478,56 @@ public:
     char * copyStr(char const * str, size_t length);
     char * copyStr(char const * str);
 
+// BAKE
+public:
+    static constexpr uint32_t BakeVersion = 4;
+
+    // identifies the source file a Gobj was baked from
+    struct BakeKey {
+        int64_t mtime = 0;
+        uint64_t size = 0;
+        uint64_t hash = 0; // contents
+    };
+
+    struct BakeHeader {
+        char magic[4] = {'G', 'O', 'B', 'J'};
+        uint32_t version = BakeVersion;
+        uint32_t layout = 0; // bakeLayout() of the baking build
+        uint32_t _pad = 0;
+        uint64_t imageSize = 0;
+        BakeKey key;
+        char sourcePath[256] = "";
+    };
+
+    // hashContents is slower, only needed if mtime or size differ
+    static bool bakeKeyForFile(char const * path, BakeKey * key, bool hashContents);
+    // changes with struct sizes and alignment, so images from other builds are
+    // rejected
+    static uint32_t bakeLayout();
+    // write header and image to fp. buffers outside the block (mapped GLB)
+    // are moved into raw data, so the image stands alone.
+    bool bake(FILE * fp, BakeKey const & key, char const * sourcePath) const;
+
 // PRIVATE STORAGE
 private:
     Status _status = STATUS_UNINITIALIZED;
     mutable std::mutex _mutex;
 
-// RELATIVE POINTER FUNCTIONS
+// COPY / BAKE INTERNALS
 private:
-    char const       * stringRelPtr             (char const * str,              Gobj * dst) const;
-    Accessor         * accessorRelPtr           (Accessor * accessor,           Gobj * dst) const;
-    Animation        * animationRelPtr          (Animation * animation,         Gobj * dst) const;
-    AnimationChannel * animationChannelRelPtr   (AnimationChannel * channel,    Gobj * dst) const;
-    AnimationSampler * animationSamplerRelPtr   (AnimationSampler * sampler,    Gobj * dst) const;
-    Buffer           * bufferRelPtr             (Buffer * buffer,               Gobj * dst) const;
-    BufferView       * bufferViewRelPtr         (BufferView * bufferView,       Gobj * dst) const;
-    Camera           * cameraRelPtr             (Camera * camera,               Gobj * dst) const;
-    Image            * imageRelPtr              (Image * image,                 Gobj * dst) const;
-    Material         * materialRelPtr           (Material * material,           Gobj * dst) const;
-    Mesh             * meshRelPtr               (Mesh * mesh,                   Gobj * dst) const;
-    MeshAttribute    * meshAttributeRelPtr      (MeshAttribute * meshAttribute, Gobj * dst) const;
-    MeshPrimitive    * meshPrimitiveRelPtr      (MeshPrimitive * meshPrimitive, Gobj * dst) const;
-    MeshTarget       * meshTargetRelPtr         (MeshTarget * meshTarget,       Gobj * dst) const;
-    float            * meshWeightRelPtr         (float * meshWeight,            Gobj * dst) const;
-    Node             * nodeRelPtr               (Node * node,                   Gobj * dst) const;
-    Node            ** nodeChildrenRelPtr       (Node ** nodeChildren,          Gobj * dst) const;
-    float            * nodeWeightRelPtr         (float * nodeWeight,            Gobj * dst) const;
-    Sampler          * samplerRelPtr            (Sampler * sampler,             Gobj * dst) const;
-    Scene            * sceneRelPtr              (Scene * scene,                 Gobj * dst) const;
-    Skin             * skinRelPtr               (Skin * skin,                   Gobj * dst) const;
-    Texture          * textureRelPtr            (Texture * texture,             Gobj * dst) const;
-    byte_t           * rawDataRelPtr            (byte_t * data,                 Gobj * dst) const;
+    // after sections were memcpy'd from src, each moved by its own amount,
+    // point every link at where its target went.
+    void rebase(Gobj const * src);
+    // render handles, decoded images, etc. are never valid in a copy.
+    void resetRuntimeState();
+    // after image has been read into this, make it usable in place
+    void unbake();
 
 // -------------------------------------------------------------------------- //
 // SUB-OBJECTS
 public:
     struct Accessor {
-        BufferView * bufferView = nullptr;
+        RelPtr<BufferView> bufferView = nullptr;
         uint32_t byteOffset = 0;
         enum ComponentType {
             COMPTYPE_BYTE           = 0x1400, // 5120
@@ -437,7 +553,7 @@ public:
         Type type = TYPE_UNDEFINED;
         float min[16] = {0.0f};
         float max[16] = {0.0f};
-        char const * name = nullptr;
+        RelPtr<char const> name = nullptr;
 
         uint16_t renderHandle = UINT16_MAX;
 
@@ -446,9 +562,8 @@ public:
         uint32_t byteSize() const;
         float componentValue(uint32_t index, uint8_t componentIndex) const;
 
-        void updateMinMax();
-
-        void copy(Accessor * accessor, Gobj * dst, Gobj * src);
+        // large accessors are split across job system workers if parallel
+        void updateMinMax(bool parallel = true);
 
         #if DEBUG || DEV_INTERFACE
         void print(int indent = 0) const;
@@ -457,18 +572,16 @@ public:
     };
 
     struct Animation {
-        AnimationChannel * channels = nullptr;
+        RelPtr<AnimationChannel> channels = nullptr;
         uint32_t nChannels = 0;
-        AnimationSampler * samplers = nullptr;
+        RelPtr<AnimationSampler> samplers = nullptr;
         uint32_t nSamplers = 0;
-        char const * name = nullptr;
-
-        void copy(Animation * animation, Gobj * dst, Gobj * src);
+        RelPtr<char const> name = nullptr;
     };
 
     struct AnimationChannel {
-        AnimationSampler * sampler = nullptr;
-        Node * node = nullptr;
+        RelPtr<AnimationSampler> sampler = nullptr;
+        RelPtr<Node> node = nullptr;
         enum Target {
             TARGET_UNDEFINED,
             TARGET_WEIGHTS,
@@ -477,33 +590,27 @@ public:
             TARGET_SCALE,
         };
         Target path = TARGET_UNDEFINED;
-
-        void copy(AnimationChannel * channel, Gobj * dst, Gobj * src);
     };
 
     struct AnimationSampler {
-        Accessor * input = nullptr;
+        RelPtr<Accessor> input = nullptr;
         enum Interpolation {
             INTERP_LINEAR,
             INTERP_STEP,
             INTERP_CUBICSPLINE
         };
         Interpolation interpolation = INTERP_LINEAR;
-        Accessor * output = nullptr;
-
-        void copy(AnimationSampler * sampler, Gobj * dst, Gobj * src);
+        RelPtr<Accessor> output = nullptr;
     };
 
     struct Buffer {
-        byte_t * data = nullptr;
+        RelPtr<byte_t> data = nullptr;
         uint32_t byteLength = 0;
-        char const * name = nullptr;
-
-        void copy(Buffer * buffer, Gobj * dst, Gobj * src);
+        RelPtr<char const> name = nullptr;
     };
 
     struct BufferView {
-        Buffer * buffer = nullptr;
+        RelPtr<Buffer> buffer = nullptr;
         uint32_t byteOffset = 0;
         uint32_t byteLength = 0;
         uint32_t byteStride = 0;
@@ -512,24 +619,20 @@ public:
             ELEMENT_ARRAY_BUFFER    = 0x8893, // 34963
         };
         Target target = ARRAY_BUFFER;
-        char const * name = nullptr;
-
-        void copy(BufferView * bufferView, Gobj * dst, Gobj * src);
+        RelPtr<char const> name = nullptr;
     };
 
     struct Camera {
-        CameraOrthographic * orthographic = nullptr;
-        CameraPerspective * perspective = nullptr;
+        RelPtr<CameraOrthographic> orthographic = nullptr;
+        RelPtr<CameraPerspective> perspective = nullptr;
         enum Type {
             TYPE_ORTHO,
             TYPE_PERSP,
         };
         Type type = TYPE_PERSP;
-        char const * name = nullptr;
+        RelPtr<char const> name = nullptr;
         // pointed to by orthographic or perspective
         float _data[4] = {0.f};
-
-        void copy(Camera * camera, Gobj * dst, Gobj * src);
     };
 
     struct CameraOrthographic {
@@ -552,13 +655,14 @@ public:
             TYPE_PNG,
         };
         MIMEType mimeType = TYPE_PNG;
-        BufferView * bufferView = nullptr;
-        char const * uri = nullptr;
-        char const * name = nullptr;
+        RelPtr<BufferView> bufferView = nullptr;
+        RelPtr<char const> uri = nullptr;
+        RelPtr<char const> name = nullptr;
+        // data URI decoded at load, in rawData. uri not kept.
+        RelPtr<byte_t> data = nullptr;
+        uint32_t dataSize = 0;
 
         void * decoded = nullptr;
-
-        void copy(Image * image, Gobj * dst, Gobj * src);
     };
 
     struct Material {
@@ -570,38 +674,36 @@ public:
         AlphaMode alphaMode = ALPHA_OPAQUE;
         float alphaCutoff = 0.5f;
         bool doubleSided = false;
-        Texture * emissiveTexture = nullptr;
+        RelPtr<Texture> emissiveTexture = nullptr;
         Attr emissiveTexCoord = ATTR_TEXCOORD0;
         float emissiveFactor[3] = {0.f};
         // normalTexture
-            Texture * normalTexture = nullptr;
+            RelPtr<Texture> normalTexture = nullptr;
             Attr normalTexCoord = ATTR_TEXCOORD0;
             float normalScale = 1.f;
         // occlusionTexture
-            Texture * occlusionTexture = nullptr;
+            RelPtr<Texture> occlusionTexture = nullptr;
             Attr occlusionTexCoord = ATTR_TEXCOORD0;
             float occlusionStrength = 1.f;
         // pbrMetallicRoughness
             float baseColorFactor[4] = {1.f, 1.f, 1.f, 1.f};
-            Texture * baseColorTexture = nullptr;
+            RelPtr<Texture> baseColorTexture = nullptr;
             Attr baseColorTexCoord = ATTR_TEXCOORD0;
             float metallicFactor = 0.f;
-            Texture * metallicRoughnessTexture = nullptr;
+            RelPtr<Texture> metallicRoughnessTexture = nullptr;
             Attr metallicRoughnessTexCoord = ATTR_TEXCOORD0;
             float roughnessFactor = 0.5f;
-        char const * name = nullptr;
-
-        void copy(Material * material, Gobj * dst, Gobj * src);
+        RelPtr<char const> name = nullptr;
     };
 
     struct Mesh {
-        MeshPrimitive * primitives = nullptr;
+        RelPtr<MeshPrimitive> primitives = nullptr;
         int nPrimitives = 0;
-        float * weights = nullptr;
+        RelPtr<float> weights = nullptr;
         int nWeights = 0;
-        char const * name = nullptr;
-
-        void copy(Mesh * mesh, Gobj * dst, Gobj * src);
+        RelPtr<char const> name = nullptr;
+        // local, union of primitives'. empty if any primitive's is.
+        AABB bounds;
 
         void updateAccessorMinMax();
         void traverse(TraverseFns const & params, glm::mat4 const & parentTransform = glm::mat4{1.f});
@@ -610,9 +712,7 @@ public:
 
     struct MeshAttribute {
         Attr type = ATTR_POSITION;
-        Accessor * accessor = nullptr;
-
-        void copy(MeshAttribute * meshAttribute, Gobj * dst, Gobj * src);
+        RelPtr<Accessor> accessor = nullptr;
 
         #if DEBUG || DEV_INTERFACE
         void print(int indent = 0) const;
@@ -621,10 +721,10 @@ public:
     };
 
     struct MeshPrimitive {
-        MeshAttribute * attributes = nullptr;
+        RelPtr<MeshAttribute> attributes = nullptr;
         int nAttributes = 0;
-        Accessor * indices = nullptr;
-        Material * material = nullptr;
+        RelPtr<Accessor> indices = nullptr;
+        RelPtr<Material> material = nullptr;
         enum Mode {
             MODE_POINTS,
             MODE_LINES,
@@ -635,43 +735,44 @@ public:
             MODE_TRIANGLE_FAN,
         };
         Mode mode = MODE_TRIANGLES;
-        MeshTarget * targets = nullptr;
+        RelPtr<MeshTarget> targets = nullptr;
         int nTargets = 0;
-
-        void copy(MeshPrimitive * meshPrimitive, Gobj * dst, Gobj * src);
+        // local, from POSITION accessor. empty (min > max) if unknown.
+        AABB bounds;
     };
 
     struct MeshTarget {
-        MeshAttribute * attributes = nullptr;
+        RelPtr<MeshAttribute> attributes = nullptr;
         int nAttributes = 0;
-
-        void copy(MeshTarget * meshTarget, Gobj * dst, Gobj * src);
     };
 
     struct Node {
-        Camera * camera = nullptr;
-        Node ** children = nullptr;
+        RelPtr<Camera> camera = nullptr;
+        RelPtr<RelPtr<Node>> children = nullptr;
         int nChildren = 0;
-        Skin * skin = nullptr;
-        glm::mat4 matrix{
-            1.f, 0.f, 0.f, 0.f,
-            0.f, 1.f, 0.f, 0.f,
-            0.f, 0.f, 1.f, 0.f,
-            0.f, 0.f, 0.f, 1.f
-        };
-        Mesh * mesh = nullptr;
-        glm::quat rotation    {1.f, 0.f, 0.f, 0.f}; // glm::quat constructor takes wxyz!
-        glm::vec3 scale       {1.f, 1.f, 1.f};
-        glm::vec3 translation {0.f, 0.f, 0.f};
-        float * weights = nullptr;
+        RelPtr<Skin> skin = nullptr;
+        RelPtr<Mesh> mesh = nullptr;
+        RelPtr<float> weights = nullptr;
         int nWeights; // must match mesh weights
-        char const * name = nullptr;
+        RelPtr<char const> name = nullptr;
+
+        // this node's slot in the Gobj's node transform arrays. slots move
+        // when nodes are flattened, these follow.
+        RelPtr<glm::mat4> matrix = nullptr;
+        RelPtr<glm::quat> rotation = nullptr; // glm::quat constructor takes wxyz!
+        RelPtr<glm::vec3> scale = nullptr;
+        RelPtr<glm::vec3> translation = nullptr;
+        // parent world * matrix, and the transposed inverse of its
+        // rotation/scale for normals. valid after Gobj::updateWorldMatrices.
+        RelPtr<glm::mat4> world = nullptr;
+        RelPtr<glm::mat3> normalMatrix = nullptr;
+        RelPtr<uint8_t> worldDirty = nullptr;
 
         void syncMatrixTRS(bool syncChildren = true);
         void setMatrixToTRS(bool syncChildren = true);
         void setTRSToMatrix(bool syncChildren = true);
-
-        void copy(Node * node, Gobj * dst, Gobj * src);
+        // call after changing matrix directly. subtree follows on update.
+        void markDirty();
     };
 
     struct Sampler {
@@ -692,38 +793,30 @@ public:
         };
         Wrap wrapS = WRAP_CLAMP_TO_EDGE;
         Wrap wrapT = WRAP_CLAMP_TO_EDGE;
-        char const * name = nullptr;
-
-        void copy(Sampler * sampler, Gobj * dst, Gobj * src);
+        RelPtr<char const> name = nullptr;
     };
 
     struct Scene {
-        Node ** nodes = nullptr; // roots nodes (spec supports multiple roots)
+        RelPtr<RelPtr<Node>> nodes = nullptr; // roots nodes (spec supports multiple roots)
         int nNodes = 0;
         static constexpr size_t NameMax = 8;
         char name[NameMax] = "";
-
-        void copy(Scene * scene, Gobj * dst, Gobj * src);
     };
 
     struct Skin {
-        Accessor * inverseBindMatrices = nullptr;
-        Node * skeleton = nullptr;
-        Node ** joints = nullptr;
+        RelPtr<Accessor> inverseBindMatrices = nullptr;
+        RelPtr<Node> skeleton = nullptr;
+        RelPtr<RelPtr<Node>> joints = nullptr;
         int nJoints = 0;
-        char const * name = nullptr;
-
-        void copy(Skin * skin, Gobj * dst, Gobj * src);
+        RelPtr<char const> name = nullptr;
     };
 
     struct Texture {
-        Sampler * sampler = nullptr;
-        Image * source = nullptr;
-        char const * name = nullptr;
+        RelPtr<Sampler> sampler = nullptr;
+        RelPtr<Image> source = nullptr;
+        RelPtr<char const> name = nullptr;
 
         uint16_t renderHandle = UINT16_MAX;
-
-        void copy(Texture * texture, Gobj * dst, Gobj * src);
     };
 
 // -------------------------------------------------------------------------- //
@@ -0,0 +1,167 @@
+#include "Gobj.h"
+#include <new>
+#include <sys/stat.h>
+#include "FrameStack.h"
+#include "mem_utils.h"
+#include "../MrManager.h"
+
+#define ALIGN_SIZE(SIZE) alignSize(SIZE, Gobj::Align)
+
+// -------------------------------------------------------------------------- //
+// KEY
+// -------------------------------------------------------------------------- //
+
+/*
+Contents are hashed a word at a time, FNV-1a style with an extra shift to fold
+high bits back down. Only used to tell whether a source changed, so speed
+matters more than distribution.
+*/
+static constexpr uint64_t HashBasis = 0xcbf29ce484222325ull;
+static constexpr uint64_t HashPrime = 0x00000100000001b3ull;
+
+static uint64_t hashStep(uint64_t hash, uint64_t word) {
+    hash = (hash ^ word) * HashPrime;
+    return hash ^ (hash >> 32);
+}
+
+bool Gobj::bakeKeyForFile(char const * path, BakeKey * key, bool hashContents) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+    key->mtime = (int64_t)st.st_mtime;
+    key->size = (uint64_t)st.st_size;
+    key->hash = 0;
+    if (!hashContents) {
+        return true;
+    }
+
+    FILE * fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Error opening \"%s\" to hash.\n", path);
+        return false;
+    }
+    uint64_t hash = HashBasis;
+    uint64_t words[2048];
+    size_t n;
+    while ((n = fread(words, 1, sizeof(words), fp)) > 0) {
+        size_t nWords = n / sizeof(uint64_t);
+        for (size_t i = 0; i < nWords; ++i) {
+            hash = hashStep(hash, words[i]);
+        }
+        byte_t const * tail = (byte_t const *)(words + nWords);
+        for (size_t i = nWords * sizeof(uint64_t); i < n; ++i, ++tail) {
+            hash = hashStep(hash, *tail);
+        }
+    }
+    bool success = !ferror(fp);
+    fclose(fp);
+    key->hash = hash;
+    return success;
+}
+
+uint32_t Gobj::bakeLayout() {
+    size_t const sizes[] = {
+        sizeof(void *),
+        Align,
+        sizeof(Gobj),
+        sizeof(FrameStack),
+        sizeof(Accessor),
+        sizeof(Animation),
+        sizeof(AnimationChannel),
+        sizeof(AnimationSampler),
+        sizeof(Buffer),
+        sizeof(BufferView),
+        sizeof(Camera),
+        sizeof(Image),
+        sizeof(Material),
+        sizeof(Mesh),
+        sizeof(MeshAttribute),
+        sizeof(MeshPrimitive),
+        sizeof(MeshTarget),
+        sizeof(Node),
+        sizeof(Sampler),
+        sizeof(Scene),
+        sizeof(Skin),
+        sizeof(Texture),
+        sizeof(BakeHeader),
+    };
+    uint32_t layout = 2166136261u;
+    for (size_t size : sizes) {
+        layout = (layout ^ (uint32_t)size) * 16777619u;
+    }
+    return layout;
+}
+
+// -------------------------------------------------------------------------- //
+// BAKE
+// -------------------------------------------------------------------------- //
+
+bool Gobj::bake(FILE * fp, BakeKey const & key, char const * sourcePath) const {
+    byte_t const * base = (byte_t const *)this;
+
+    // raw data is the last section. image keeps everything up to its used
+    // part, and buffers outside the block are appended after that.
+    auto isExternal = [this](byte_t const * data) {
+        return data && (data < rawData || data >= rawData + maxCounts.rawDataLen);
+    };
+    size_t rawOffset = (rawData) ? (size_t)(rawData - base) : maxCounts.totalSize();
+    uint32_t rawLen = (rawData) ? counts.rawDataLen : 0;
+    for (uint16_t i = 0; i < counts.buffers; ++i) {
+        if (isExternal(buffers[i].data)) {
+            rawLen = (uint32_t)ALIGN_SIZE(rawLen) + buffers[i].byteLength;
+        }
+    }
+    uint32_t maxRawLen = (rawLen > maxCounts.rawDataLen) ? rawLen : maxCounts.rawDataLen;
+    size_t imageSize = (rawData) ? rawOffset + ALIGN_SIZE(maxRawLen) : maxCounts.totalSize();
+    size_t usedSize = (rawData) ? rawOffset + counts.rawDataLen : imageSize;
+
+    byte_t * image = (byte_t *)mm.memMan.request({.size = imageSize, .align = Align, .high = true});
+    if (image == nullptr) {
+        fprintf(stderr, "Not enough memory to bake Gobj (%zu bytes).\n", imageSize);
+        return false;
+    }
+    memcpy(image, (void const *)this, usedSize);
+    memset(image + usedSize, 0, imageSize - usedSize);
+    Gobj * baked = (Gobj *)image;
+
+    // fold external buffers in, linking to where they land in image
+    if (rawData) {
+        Buffer * bakedBuffers = (Buffer *)(image + ((byte_t const *)buffers.get() - base));
+        uint32_t rawHead = counts.rawDataLen;
+        for (uint16_t i = 0; i < counts.buffers; ++i) {
+            if (!isExternal(buffers[i].data)) continue;
+            rawHead = (uint32_t)ALIGN_SIZE(rawHead);
+            memcpy(image + rawOffset + rawHead, buffers[i].data, buffers[i].byteLength);
+            bakedBuffers[i].data = image + rawOffset + rawHead;
+            rawHead += buffers[i].byteLength;
+        }
+        baked->counts.rawDataLen = rawLen;
+        const_cast<Counts &>(baked->maxCounts).rawDataLen = maxRawLen;
+    }
+    baked->mappedFile = nullptr;
+
+    BakeHeader header;
+    header.layout = bakeLayout();
+    header.imageSize = imageSize;
+    header.key = key;
+    snprintf(header.sourcePath, sizeof(header.sourcePath), "%s", sourcePath);
+    bool success =
+        fwrite(&header, sizeof(BakeHeader), 1, fp) == 1 &&
+        fwrite(image, 1, imageSize, fp) == imageSize;
+    if (!success) {
+        fprintf(stderr, "Error writing baked Gobj for \"%s\".\n", sourcePath);
+    }
+
+    mm.memMan.request({.ptr = image});
+    return success;
+}
+
+void Gobj::unbake() {
+    // links are self-relative, nothing to fix up. only runtime state, never
+    // valid from disk.
+    new (&_mutex) std::mutex{};
+    _status = STATUS_LOADED;
+    mappedFile = nullptr;
+    resetRuntimeState();
+}
@@ -30,7 +30,7 @@ void Gobj::editorCreate() {
 void Gobj::drawNode(Node * node) {
     ImGuiTreeNodeFlags flags = 0;
     if (node->nChildren == 0) flags |= ImGuiTreeNodeFlags_Leaf;
-    if (!TreeNodeEx(node, flags, "Node %zu (%s)", node - nodes, node->name)) {
+    if (!TreeNodeEx(node, flags, "Node %zu (%s)", node - nodes, node->name.get())) {
         return;
     }
     for (uint16_t i = 0; i < node->nChildren; ++i) {
@@ -40,6 +40,12 @@ void Gobj::drawNode(Node * node) {
 }
 
 void Gobj::editorEditBlock() {
+    // still being filled on a worker
+    if (isLoading()) {
+        TextUnformatted("Loading...");
+        return;
+    }
+
     if (Button("Zoom To")) {
         mm.camera->zoomTo(this);
     }
@@ -82,11 +88,16 @@ void Gobj::editorEditBlock() {
         for (uint16_t i = 0; i < counts.materials; ++i) {
             Material * mat = materials + i;
             PushID(mat);
-            char const * title = mm.frameFormatStr("Material %u (%s)", mat - materials, mat->name);
+            char const * title = mm.frameFormatStr("Material %u (%s)", mat - materials, mat->name.get());
             if (CollapsingHeader(title)) {
-                ColorEdit4("Base Color", mat->baseColorFactor, ImGuiColorEditFlags_DisplayHex);
-                SliderFloat("Roughness", &mat->roughnessFactor, 0.0f, 1.0f, "%.5f");
-                SliderFloat("Metallic", &mat->metallicFactor, 0.0f, 1.0f, "%.5f");
+                bool changed = false;
+                changed |= ColorEdit4("Base Color", mat->baseColorFactor, ImGuiColorEditFlags_DisplayHex);
+                changed |= SliderFloat("Roughness", &mat->roughnessFactor, 0.0f, 1.0f, "%.5f");
+                changed |= SliderFloat("Metallic", &mat->metallicFactor, 0.0f, 1.0f, "%.5f");
+                // draw packets hold copies of these
+                if (changed) {
+                    mm.rendSys.refresh(this);
+                }
             }
             PopID();
         }
@@ -98,7 +109,7 @@ void Gobj::editorEditBlock() {
             Accessor * accr = accessors + i;
             PushID(accr);
             char * title = mm.frameFormatStr("%s %s/%s (%p)",
-                accr->name,
+                accr->name.get(),
                 accessorTypeStr(accr->type),
                 accessorComponentTypeStr(accr->componentType),
                 accr
@@ -5,6 +5,9 @@
 #endif // DEBUG
 #include "mem_utils.h"
 #include "FSA.h"
+#include "FrameRing.h"
+#include "FrameStack.h"
+#include "ThreadArena.h"
 #include "../common/string_utils.h"
 
 #if DEBUG
@@ -22,8 +25,12 @@ void MemMan::init(EngineSetup const & setup, FrameStack ** frameStack) {
     #endif // DEBUG
     _head = new (_data) BlockInfo();
     _head->_dataSize = _size - BlockInfoSize;
+    _blockCount = 1;
     _tail = _head;
     _firstFree = _head;
+    for (BlockInfo *& bin : _freeBins) bin = nullptr;
+    _freeBinMask = 0;
+    binFreeBlock(_head);
 
     #if DEBUG
     // printl("MEM MAN RANGE %*p—%*p", 8, _data, 8, _data+_size);
@@ -45,13 +52,22 @@ void MemMan::init(EngineSetup const & setup, FrameStack ** frameStack) {
     }
     if (setup.memManFrameStackSize) {
         FrameStack * fs = createFrameStack(setup.memManFrameStackSize);
+        if (fs) {
+            fs->setThreadPenSize(setup.memManFrameStackPenSize);
+        }
         if (fs && frameStack) {
             *frameStack = fs;
         }
     }
+    if (setup.memManFrameRingSize) {
+        _frameRing = createFrameRing(setup.memManFrameRingSize);
+    }
     if (setup.memManAutoReleaseBufferSize) {
         _autoReleaseBuffer = createAutoReleaseBuffer(setup.memManAutoReleaseBufferSize);
     }
+    _threadArenaSize = setup.memManThreadArenaSize;
+    _mapGLBMinSize = setup.memManMapGLBMinSize;
+    _gobjCacheDir = setup.memManGobjCacheDir;
 }
 
 void MemMan::startFrame(size_t frame) {
@@ -67,7 +83,14 @@ void MemMan::endFrame() {
     #endif // DEBUG
 
     autoReleaseEndFrame();
-    mergeAllAdjacentFreeBlocks();
+    if (_frameRing) {
+        _frameRing->endFrame();
+    }
+
+    // free blocks are merged on release. just make sure that's true.
+    #if DEBUG
+    validateAllBlocks();
+    #endif // DEBUG
 }
 
 void MemMan::shutdown() {
@@ -81,6 +104,9 @@ void MemMan::shutdown() {
     _head = nullptr;
     _tail = nullptr;
     _firstFree = nullptr;
+    for (BlockInfo *& bin : _freeBins) bin = nullptr;
+    _freeBinMask = 0;
+    _nThreadArenas = 0;
 }
 
 byte_t const * MemMan::data() const {
@@ -108,10 +134,21 @@ size_t MemMan::blockCountForDisplayOnly() const {
 }
 
 bool MemMan::isPtrInFSA(void * ptr) const {
-    return (_fsa && _fsa->containsPtr(ptr));
+    return (fsaForPtr(ptr) != nullptr);
 }
 
 void * MemMan::request(Request const & newRequest) {
+    // small requests from threads with an arena skip the lock
+    void * arenaPtr;
+    if (threadArenaRequest(newRequest, &arenaPtr)) {
+        return arenaPtr;
+    }
+    // as do requests the FSA can serve on its own
+    void * fsaPtr;
+    if (fsaRequest(newRequest, &fsaPtr)) {
+        return fsaPtr;
+    }
+
     guard_t guard{_mainMutex};
     *_request = newRequest;
     request();
@@ -135,14 +172,26 @@ void MemMan::request() {
         // alloc
         if (_request->ptr == nullptr) {
 
+            // frame ring. only short lifetimes, with nothing else to track.
+            if (
+                _request->lifetime >= 0 &&
+                _frameRing &&
+                (_result->ptr = _frameRing->alloc(_request->size, _request->align, _request->lifetime))
+            ) {
+                _result->size = _request->size;
+                _result->align = _request->align;
+                _result->block = blockForPtr(_frameRing);
+                return;
+            }
+
             // fsa
+            FSA * fsa;
             if (
                 _request->align == 0 &&
-                _fsa &&
-                (_result->ptr = _fsa->alloc(_request->size))
+                (_result->ptr = fsaAlloc(_request->size, &fsa))
             ) {
                 _result->size = _request->size;
-                _result->block = _fsaBlock;
+                _result->block = blockForPtr(fsa);
                 addAutoRelease();
                 return;
             }
@@ -163,20 +212,34 @@ void MemMan::request() {
         }
         // realloc
         else {
+            // ptr is in frame ring? move it. the ring doesn't track sizes, but
+            // everything up to its bucket's head is safe to copy.
+            if (_frameRing && _frameRing->containsPtr(_request->ptr)) {
+                void * oldPtr = _request->ptr;
+                size_t oldSize = _frameRing->bytesToHead(oldPtr);
+                _request->ptr = nullptr;
+                request();
+                if (_result->ptr) {
+                    memcpy(_result->ptr, oldPtr, (oldSize < _request->size) ? oldSize : _request->size);
+                }
+                return;
+            }
+
             // ptr is in FSA?
             bool ptrInFSA = false;
             BlockInfo * block = nullptr;
+            FSA * fsa = fsaForPtr(_request->ptr);
             uint16_t fsaGroupIndex;
             uint16_t fsaSubBlockIndex;
             size_t fsaCurrentSize = 0;
-            if (_fsa && _fsa->indicesForPtr(_request->ptr, &fsaGroupIndex, &fsaSubBlockIndex)) {
+            if (fsa && fsa->indicesForPtr(_request->ptr, &fsaGroupIndex, &fsaSubBlockIndex)) {
                 // leave ptr where it is. current FSA group is big enough for requested size.
                 fsaCurrentSize = FSA::SubBlockByteSize(fsaGroupIndex);
                 if (fsaCurrentSize >= _request->size) {
                     // TODO: consider FSA align
                     _result->ptr = _request->ptr;
                     _result->size = _request->size;
-                    _result->block = _fsaBlock;
+                    _result->block = blockForPtr(fsa);
                     return;
                 }
                 ptrInFSA = true;
@@ -190,13 +253,15 @@ void MemMan::request() {
 
             // to FSA
             void * ptr = nullptr;
-            if (_fsa && (ptr = _fsa->alloc(_request->size))) {
+            FSA * newFSA;
+            if (_request->align == 0 && (ptr = fsaAlloc(_request->size, &newFSA))) {
                 // fsa to fsa
                 if (ptrInFSA) {
                     memcpy(ptr, _request->ptr, fsaCurrentSize);
+                    fsaFree(_request->ptr);
                     _result->ptr = ptr;
                     _result->size = _request->size;
-                    _result->block = _fsaBlock;
+                    _result->block = blockForPtr(newFSA);
                     updateAutoRelease();
                     return;
                 }
@@ -206,9 +271,10 @@ void MemMan::request() {
                         block->_dataSize :
                         _request->size;
                     memcpy(ptr, block->data(), smallerSize);
+                    releaseBlock(block);
                     _result->ptr = ptr;
                     _result->size = _request->size;
-                    _result->block = _fsaBlock;
+                    _result->block = blockForPtr(newFSA);
                     updateAutoRelease();
                     return;
                 }
@@ -224,6 +290,7 @@ void MemMan::request() {
                     assert(_result->block && "Could not reallocate memory.");
 
                     memcpy(_result->block->data(), _request->ptr, fsaCurrentSize);
+                    fsaFree(_request->ptr);
                     _result->size = _result->block->_dataSize;
                     _result->align = _request->align;
                     _result->ptr = _result->block->data();
@@ -247,7 +314,10 @@ void MemMan::request() {
     }
     // free
     else if (_request->ptr) {
-        if (_fsa->destroy(_request->ptr)) {
+        if (_frameRing && _frameRing->containsPtr(_request->ptr)) {
+            // released with its bucket
+        }
+        else if (fsaFree(_request->ptr)) {
             // ptr was in fsa
             removeAutoRelease();
         }
@@ -279,13 +349,22 @@ size_t MemMan::sizeOfPtr(void * ptr, MemMan::BlockInfo const ** block) const {
     // is it in the FSA?
     uint16_t fsaGroupIndex;
     uint16_t fsaSubBlockIndex;
-    if (_fsa && _fsa->indicesForPtr(ptr, &fsaGroupIndex, &fsaSubBlockIndex)) {
+    FSA const * fsa = fsaForPtr(ptr);
+    if (fsa && fsa->indicesForPtr(ptr, &fsaGroupIndex, &fsaSubBlockIndex)) {
         if (block) {
-            *block = _fsaBlock;
+            *block = blockForPtr((void *)fsa);
         }
         return 2 << fsaGroupIndex;
     }
 
+    // in a thread arena?
+    if (ThreadArena * arena = threadArenaForPtr(ptr)) {
+        if (block) {
+            *block = blockForPtr(arena);
+        }
+        return arena->sizeForPtr(ptr);
+    }
+
     // no? must be in a block
     *block = blockForPtr(ptr);
     if (*block) {
@@ -360,14 +439,14 @@ void MemMan::copy(void * dst, void * src) {
     BlockInfo * srcBlock = nullptr;
 
     // where is destination?
-    if (_fsa->containsPtr(dst)) {
+    if (isPtrInFSA(dst)) {
         dstLoc = FSA;
     }
     else if ((dstBlock = blockForPtr(dst))) {
         dstLoc = BLOCK;
     }
     // where is source?
-    if (_fsa->containsPtr(src)) {
+    if (isPtrInFSA(src)) {
         srcLoc = FSA;
     }
     else if ((srcBlock = blockForPtr(src))) {
@@ -389,13 +468,13 @@ void MemMan::copy(void * dst, void * src) {
         return;
     }
     // everything else just needs a size for simple memcpy
-    else if (dstLoc == EXTERNAL && srcLoc == FSA     ) { size = _fsa->sizeForPtr(src); }
+    else if (dstLoc == EXTERNAL && srcLoc == FSA     ) { size = sizeOfPtr(src); }
     else if (dstLoc == EXTERNAL && srcLoc == BLOCK   ) { size = srcBlock->dataSize(); }
-    else if (dstLoc == FSA      && srcLoc == EXTERNAL) { size = _fsa->sizeForPtr(dst); }
-    else if (dstLoc == FSA      && srcLoc == FSA     ) { size = _fsa->sizeForPtr(src); }
+    else if (dstLoc == FSA      && srcLoc == EXTERNAL) { size = sizeOfPtr(dst); }
+    else if (dstLoc == FSA      && srcLoc == FSA     ) { size = sizeOfPtr(src); }
     else if (dstLoc == FSA      && srcLoc == BLOCK   ) { size = srcBlock->dataSize(); }
     else if (dstLoc == BLOCK    && srcLoc == EXTERNAL) { size = dstBlock->dataSize(); }
-    else if (dstLoc == BLOCK    && srcLoc == FSA     ) { size = _fsa->sizeForPtr(src); }
+    else if (dstLoc == BLOCK    && srcLoc == FSA     ) { size = sizeOfPtr(src); }
     memcpy(dst, src, size);
 }
 
@@ -439,11 +518,18 @@ void MemMan::validateAllBlocks() {
     size_t i = 0;
     BlockInfo * checkFirstFree = nullptr;
     size_t totalMemManSize = 0;
+    size_t nFreeBlocks = 0;
     BlockInfo * lastBlock;
     for (BlockInfo * bi = _head; bi; bi = bi->_next) {
         bi->_debug_index = i;
         assert(bi->isValid() && "Block invalid.");
 
+        if (bi->_type == MEM_BLOCK_FREE) {
+            ++nFreeBlocks;
+            assert((bi->_next == nullptr || bi->_next->_type != MEM_BLOCK_FREE) &&
+                "Adjacent free blocks not merged.");
+        }
+
         // check first free is correct
         if (bi->_type == MEM_BLOCK_FREE && checkFirstFree == nullptr) {
             checkFirstFree = bi;
@@ -480,6 +566,8 @@ void MemMan::validateAllBlocks() {
     // assert the last block encountered is the tail
     assert(lastBlock == _tail && "Block list did not reach _tail.");
 
+    assert(i == _blockCount && "_blockCount out of sync.");
+
     // if checkFirstFree is nullptr, then no free blocks were found.
     // in that case, check that _firstFree is also nullptr
     if (checkFirstFree == nullptr) {
@@ -498,6 +586,20 @@ void MemMan::validateAllBlocks() {
 
     // assert the last block encountered is the tail
     assert(lastBlock == _head && "Reverse block list did not reach _head.");
+
+    // every free block should be in the bin for its size, and nothing else
+    size_t nBinnedBlocks = 0;
+    for (uint8_t bin = 0; bin < NumFreeBins; ++bin) {
+        assert((_freeBins[bin] != nullptr) == (bool)(_freeBinMask & ((uint64_t)1 << bin)) &&
+            "Free bin mask out of sync.");
+        for (BlockInfo * bi = _freeBins[bin]; bi; bi = bi->_nextFree) {
+            assert(bi->_type == MEM_BLOCK_FREE && "Non-free block in free bin.");
+            assert(FreeBinForSize(bi->_dataSize) == bin && "Free block in wrong bin.");
+            assert((bi->_nextFree == nullptr || bi->_nextFree->_prevFree == bi) && "Free bin linkage broken.");
+            ++nBinnedBlocks;
+        }
+    }
+    assert(nBinnedBlocks == nFreeBlocks && "Free block count doesn't match binned block count.");
 }
 #endif // DEBUG
 
@@ -596,6 +698,16 @@ void * BXAllocator::realloc(void * ptr, size_t size, size_t align, char const *
         #endif // DEBUG
     }
 
+    // small requests from threads with an arena skip the lock
+    void * arenaPtr;
+    if (memMan->threadArenaRequest({.size = size, .align = align, .ptr = ptr, .type = MEM_BLOCK_BGFX}, &arenaPtr)) {
+        return arenaPtr;
+    }
+    void * fsaPtr;
+    if (memMan->fsaRequest({.size = size, .align = align, .ptr = ptr, .type = MEM_BLOCK_BGFX}, &fsaPtr)) {
+        return fsaPtr;
+    }
+
     MemMan::guard_t guard{memMan->_mainMutex};
 
     // #if DEBUG
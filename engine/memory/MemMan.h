@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <mutex>
 #include <bx/allocator.h>
 #include "../engine.h"
@@ -26,8 +27,12 @@ _padding   BlockInfo      BlockInfo->data()            _padding
 class CharKeys;
 class FSA;
 class File;
+class FrameRing;
 class FrameStack;
 class FreeList;
+class GLTFLoader;
+class JobSystem;
+class ThreadArena;
 
 class MemMan {
 // FRIENDS ------------------------------------------------------------------ //
@@ -68,6 +73,9 @@ public:
         BlockInfo * _prev;
         uint32_t _padding = 0;
         MemBlockType _type = MEM_BLOCK_FREE;
+        // links within size-class free bin. only valid while free and binned.
+        BlockInfo * _nextFree = nullptr;
+        BlockInfo * _prevFree = nullptr;
 
         #if DEBUG
         constexpr static uint16_t DebugNameMax = 16;
@@ -101,6 +109,13 @@ public:
     };
     constexpr static size_t BlockInfoSize = sizeof(BlockInfo);
 
+    // free blocks are binned by power-of-two data size. bin i holds blocks
+    // with _dataSize in [2^i, 2^(i+1)). (bin 0 also holds _dataSize 0.)
+    constexpr static uint8_t NumFreeBins = 64;
+    static uint8_t FreeBinForSize(size_t dataSize) {
+        return (dataSize) ? (uint8_t)(63 - __builtin_clzll(dataSize)) : 0;
+    }
+
     class Request {
     public:
         size_t size = 0;
@@ -110,6 +125,8 @@ public:
 
         // number of frames allocation should last. -1 == forever (until manual release)
         // common usage: set to 0 for auto-release at end of current frame
+        // lifetimes up to FrameRing::MaxLifetime are bumped into the frame ring
+        // when possible. manual release of those is a no-op.
         int lifetime = -1;
 
         // request from tail of block
@@ -162,6 +179,9 @@ public:
     CharKeys * createCharKeys(size_t max);
     // MEM_BLOCK_FILE
     File * createFileHandle(char const * path, bool loadNow, Request const & addlRequest);
+    // block holds only the File. contents are memory-mapped, and unmapped
+    // when the block is released.
+    File * createFileMapping(char const * path);
     // MEM_BLOCK_FRAMESTACK
     FrameStack * createFrameStack(size_t size);
     // MEM_BLOCK_FREELIST
@@ -170,6 +190,16 @@ public:
     Gobj * createGobj(char const * gltfPath, Gobj::Counts additionalCounts = {});
     Gobj * createGobj(Gobj::Counts const & counts, int lifetime = -1);
     Gobj * updateGobj(Gobj * oldGobj, Gobj::Counts additionalCounts);
+    // load many at once. files are read, counted and filled in parallel on
+    // jobs, and their blocks are reserved together, adjacent if there's room.
+    // blocks until done. gobjs[i] is nullptr if gltfPaths[i] failed. returns
+    // number loaded.
+    uint16_t createGobjs(char const * const * gltfPaths, uint16_t nPaths, Gobj ** gobjs, JobSystem & jobs);
+    // baked image of gltfPath from the Gobj cache dir. nullptr if there is
+    // none, or it is stale. disk reads happen outside the lock.
+    Gobj * createBakedGobj(char const * gltfPath);
+    // write gobj to the Gobj cache dir, keyed by gltfPath. doesn't lock.
+    bool bakeGobj(Gobj const * gobj, char const * gltfPath);
     // MEM_BLOCK_POOL
     template<typename T>
     Pool<T> * createPool(size_t max);
@@ -178,6 +208,14 @@ public:
     void setDebugName(void * ptr, char const * name);
     #endif // DEBUG
 
+    // THREAD ARENAS
+    // give calling thread its own arena. small allocations requested from this
+    // thread are then served from the arena without locking _mainMutex.
+    void attachThreadArena();
+    // retire calling thread's arena. its block is released once every
+    // allocation in it has been freed (from any thread).
+    void detachThreadArena();
+
 
 // SPECIAL INIT BLOCK OBJ CREATION ------------------------------------------ //
 private:
@@ -185,8 +223,14 @@ private:
     void createRequestResult();
     // create fsa block on init
     FSA * createFSA(MemManFSASetup const & setup);
+    // create growth slab for full fsa group, chained off _fsa
+    FSA * createFSASlab(uint8_t groupIndex);
+    // create multi-frame ring for short lifetime allocations on init
+    FrameRing * createFrameRing(size_t size);
     // create auto-release buffer on init
     Array<MemMan::AutoRelease> * createAutoReleaseBuffer(size_t size);
+    // create arena for calling thread
+    ThreadArena * createThreadArena(size_t size);
 
 
 // STORAGE ------------------------------------------------------------------ //
@@ -197,15 +241,24 @@ private:
     BlockInfo * _head = nullptr;
     BlockInfo * _tail = nullptr;
     BlockInfo * _firstFree = nullptr;
+    BlockInfo * _freeBins[NumFreeBins] = {nullptr};
+    uint64_t _freeBinMask = 0; // bit i set if _freeBins[i] not empty
     Request * _request = nullptr;
     Result * _result = nullptr;
     FSA * _fsa = nullptr;
     BlockInfo * _fsaBlock = nullptr;
+    FrameRing * _frameRing = nullptr;
     Array<AutoRelease> * _autoReleaseBuffer = nullptr;
     #if DEBUG
     size_t _frame = 0;
     #endif // DEBUG
-    size_t _blockCount = 0; // updated during end frame, for display purposes only
+    size_t _blockCount = 0; // updated as blocks are split and merged
+    size_t _threadArenaSize = 0;
+    size_t _mapGLBMinSize = 0;
+    char const * _gobjCacheDir = nullptr;
+    bool _firstFitLookup = false; // claimFirstFitBlock instead of bins
+    std::atomic<uint16_t> _nThreadArenas{0}; // live arena blocks, retired included
+    static thread_local ThreadArena * _threadArena; // assumes one MemMan per thread
     mutable std::recursive_mutex _mainMutex;
 
 
@@ -216,7 +269,13 @@ private:
     // explicitly finds/creates free block of size. reads params from most recent Request object.
     BlockInfo * createBlock();
     BlockInfo * createBlock(Request const & request);
-    // explicitly releases block. set type to free and reset padding
+    // claim block for most recent Request, found through the free bins
+    BlockInfo * claimBinnedBlock();
+    // same, walking the block list and taking the first that fits. kept to
+    // compare against bins (see editorBlockLookupBenchmark).
+    BlockInfo * claimFirstFitBlock();
+    // explicitly releases block. set type to free, reset padding, and merge
+    // with free neighbours
     void releaseBlock(BlockInfo * block);
     // alters _padding and _dataSize to align data() to alignment, reads params from most recent Request object.
     BlockInfo * claimBlock(BlockInfo * block);
@@ -237,12 +296,19 @@ private:
     BlockInfo * growBlock(BlockInfo * block, size_t biggerSize, size_t align = 0);
     // shortcut to grow/shrink
     BlockInfo * resizeBlock(BlockInfo * block);
+    // consecutive blocks carved from one free block, so they sit together
+    // in memory. all or none.
+    bool createAdjacentBlocks(size_t const * sizes, uint16_t nBlocks, size_t align, MemBlockType type, BlockInfo ** blocks);
     // copy data from any block/FSA location to another block/FSA location
     void copy(void * dst, void * src);
-    // combine adjacent free blocks
-    void mergeAllAdjacentFreeBlocks();
     // scan forward to find first free
     void findFirstFreeBlock(BlockInfo * block);
+    // find binned free block able to hold size at align. best fit within the
+    // smallest candidate bin, otherwise first fit in next non-empty bin.
+    BlockInfo * findFreeBlock(size_t size, size_t align) const;
+    // add/remove free block to/from its size-class bin
+    void binFreeBlock(BlockInfo * block);
+    void unbinFreeBlock(BlockInfo * block);
     // BlockInfo for raw ptr pointing to data.
     BlockInfo * blockForPtr(void * ptr);
     BlockInfo const * blockForPtr(void * ptr) const;
@@ -258,6 +324,46 @@ private:
     void updateAutoRelease();
     // conditionally remove auto-release
     void removeAutoRelease();
+    // handle small alloc/free/in-place realloc in the FSA without locking.
+    // returns false if request must go through main path.
+    bool fsaRequest(Request const & request, void ** ptr);
+    // claim sub-block from _fsa, or its slabs, growing if needed. returns
+    // nullptr if size not handled by FSA. sets containing FSA if found.
+    void * fsaAlloc(size_t size, FSA ** foundFSA = nullptr);
+    // release sub-block in _fsa or its slabs. empty slabs are released.
+    // returns false if ptr not in FSA.
+    bool fsaFree(void * ptr);
+    // _fsa or slab containing ptr, or nullptr
+    FSA * fsaForPtr(void * ptr) const;
+    // unlink empty slab and release its block
+    void releaseFSASlab(FSA * slab);
+    // handle request in calling thread's arena without locking. returns false
+    // if request must go through main path.
+    bool threadArenaRequest(Request const & request, void ** ptr);
+    // arena containing ptr, or nullptr. does not lock.
+    ThreadArena * threadArenaForPtr(void * ptr) const;
+    // retire full arena and attach a new one
+    bool refillThreadArena();
+    // release block of arena with no references left
+    void releaseThreadArena(ThreadArena * arena);
+    // GLTF load in progress, from reserve to commit. fields are scratch,
+    // allocated with manual lifetime so they outlive frames ending mid-load.
+    class GobjLoad {
+    public:
+        File * gltf = nullptr;
+        char * dirName = nullptr;
+        uint32_t dirNameLen = 0;
+        GLTFLoader * loader = nullptr;
+        void * tape = nullptr;
+    };
+    // reserve scratch, read file, tokenize and count. lock is only taken for
+    // allocations. on failure, scratch is already released.
+    bool beginGobjLoad(GobjLoad * load, char const * gltfPath);
+    // fill gobj, created at least as big as load->loader->counts(). unlocked.
+    // a mapped file belongs to gobj from here, and is released with it.
+    bool fillGobj(GobjLoad * load, Gobj * gobj);
+    // release scratch, keeping a mapped file if it was handed to a gobj
+    void endGobjLoad(GobjLoad * load, bool keepMapping);
 
 
 // DEV INTERFACE ------------------------------------------------------------ //
@@ -271,7 +377,22 @@ public:
 
     static constexpr size_t MaxTestAllocs = 128;
 
+    // createBlock and releaseBlock call, recorded for replay
+    struct TraceEvent {
+        BlockInfo const * block;
+        size_t size;
+        size_t align;
+        bool high;
+        bool release;
+    };
+
     void editor();
+    void editorThreadArenaBenchmark();
+    void editorBlockLookupBenchmark();
+    void editorGLTFLoadBenchmark();
+    #if DEBUG
+    void editorFrameStackTest();
+    #endif // DEBUG
     void addTestAlloc(void * ptr, char const * formatString = NULL, ...);
     void removeAlloc(uint16_t i);
     void removeAllAllocs();
@@ -279,13 +400,19 @@ public:
     TestAlloc testAllocs[MaxTestAllocs] = {};
     uint16_t nTestAllocs = 0;
 
+    // calls are recorded while traceLength < traceCapacity. set under lock.
+    TraceEvent * trace = nullptr;
+    uint32_t traceLength = 0;
+    uint32_t traceCapacity = 0;
+
 #endif // DEV_INTERFACE
 
 
 // DEBUG ONLY --------------------------------------------------------------- //
 public:
     #if DEBUG
-    // validate all blocks, update debug info like _debug_index
+    // validate all blocks, update debug info like _debug_index. also checks
+    // free blocks were coalesced and _blockCount is correct.
     void validateAllBlocks();
     // print all blocks
     void printAllBlocks() const;
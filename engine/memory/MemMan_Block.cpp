@@ -1,30 +1,13 @@
 #include "MemMan.h"
+#include "File.h"
+#include "Gobj.h"
 #include "mem_utils.h"
 
 MemMan::BlockInfo * MemMan::createBlock() {
     guard_t guard{_mainMutex};
     assert(_request && "Request object not set.");
 
-    BlockInfo * found = nullptr;
-
-    if (_request->high) {
-        // start from tail
-        for (BlockInfo * bi = _tail; bi; bi = bi->_prev) {
-            if (bi->_type == MEM_BLOCK_FREE && bi->_dataSize >= _request->size) {
-                found = claimBlockBack(bi);
-                if (found) break;
-            }
-        }
-    }
-    else {
-        // start from head
-        for (BlockInfo * bi = _firstFree; bi; bi = bi->_next) {
-            if (bi->_type == MEM_BLOCK_FREE && bi->_dataSize >= _request->size) {
-                found = claimBlock(bi);
-                if (found) break;
-            }
-        }
-    }
+    BlockInfo * found = (_firstFitLookup) ? claimFirstFitBlock() : claimBinnedBlock();
 
     if (found == nullptr) {
         fprintf(stderr,
@@ -36,6 +19,12 @@ MemMan::BlockInfo * MemMan::createBlock() {
         found->_type = _request->type;
     }
 
+    #if DEV_INTERFACE
+    if (found && traceLength < traceCapacity) {
+        trace[traceLength++] = {found, _request->size, _request->align, _request->high, false};
+    }
+    #endif // DEV_INTERFACE
+
     #if DEBUG
     validateAllBlocks();
     #endif // DEBUG
@@ -43,6 +32,47 @@ MemMan::BlockInfo * MemMan::createBlock() {
     return found;
 }
 
+MemMan::BlockInfo * MemMan::claimBinnedBlock() {
+    if (_request->high) {
+        // new block is split off the back, so needs room for its own BlockInfo
+        // and worst-case alignment within the free block.
+        size_t backSize = _request->size + _request->align + BlockInfoSize;
+        // tail is usually the big free block at the end. try it first.
+        if (_tail->_type == MEM_BLOCK_FREE && _tail->_dataSize >= backSize) {
+            BlockInfo * found = claimBlockBack(_tail);
+            if (found) return found;
+        }
+        BlockInfo * bi = findFreeBlock(backSize, 0);
+        return (bi) ? claimBlockBack(bi) : nullptr;
+    }
+
+    BlockInfo * bi = findFreeBlock(_request->size, _request->align);
+    return (bi) ? claimBlock(bi) : nullptr;
+}
+
+MemMan::BlockInfo * MemMan::claimFirstFitBlock() {
+    if (_request->high) {
+        // start from tail, with room for the split as in claimBinnedBlock
+        size_t backSize = _request->size + _request->align + BlockInfoSize;
+        for (BlockInfo * bi = _tail; bi; bi = bi->_prev) {
+            if (bi->_type == MEM_BLOCK_FREE && bi->_dataSize >= backSize) {
+                BlockInfo * found = claimBlockBack(bi);
+                if (found) return found;
+            }
+        }
+        return nullptr;
+    }
+
+    // start from head
+    for (BlockInfo * bi = _firstFree; bi; bi = bi->_next) {
+        if (bi->_type == MEM_BLOCK_FREE && bi->_dataSize >= _request->size) {
+            BlockInfo * found = claimBlock(bi);
+            if (found) return found;
+        }
+    }
+    return nullptr;
+}
+
 MemMan::BlockInfo * MemMan::createBlock(MemMan::Request const & request) {
     guard_t guard{_mainMutex};
     assert(_request && "Request object not set.");
@@ -64,6 +94,24 @@ void MemMan::releaseBlock(BlockInfo * block) {
     assert(block->isValid() && "Block not valid.");
     #endif // DEBUG
 
+    #if DEV_INTERFACE
+    if (traceLength < traceCapacity) {
+        trace[traceLength++] = {block, 0, 0, false, true};
+    }
+    #endif // DEV_INTERFACE
+
+    // release what lives outside the block
+    if (block->_type == MEM_BLOCK_FILE) {
+        ((File *)block->data())->unmap();
+    }
+    else if (block->_type == MEM_BLOCK_GOBJ) {
+        Gobj * gobj = (Gobj *)block->data();
+        if (gobj->mappedFile) {
+            releaseBlock(blockForPtr(gobj->mappedFile));
+            gobj->mappedFile = nullptr;
+        }
+    }
+
     // get some block info
     size_t blockSize = block->blockSize();
 
@@ -85,6 +133,13 @@ void MemMan::releaseBlock(BlockInfo * block) {
     #endif // DEBUG
 
     linkBlocks(block->_prev, block, block->_next);
+    binFreeBlock(block);
+
+    // coalesce with free neighbours
+    mergeWithNextBlock(block);
+    if (block->_prev && block->_prev->_type == MEM_BLOCK_FREE) {
+        mergeWithNextBlock(block->_prev);
+    }
 
     #if DEBUG
     validateAllBlocks();
@@ -101,6 +156,9 @@ MemMan::BlockInfo * MemMan::claimBlock(BlockInfo * block) {
     // ensure sufficient size even if realignment happens
     if (block->calcAlignDataSize(_request->align) < _request->size) return nullptr;
 
+    // out of bin before realign moves the BlockInfo
+    unbinFreeBlock(block);
+
     // re-align if necessary
     size_t newPadding = block->calcAlignPaddingSize(_request->align);
     if (_request->align > 0 && block->_padding != newPadding) {
@@ -108,12 +166,12 @@ MemMan::BlockInfo * MemMan::claimBlock(BlockInfo * block) {
     }
 
     block->_type = MEM_BLOCK_CLAIMED;
+    _freeBlockSize -= block->blockSize();
+
     // create free block, leaving this block at requested size
     // (might fail but that's ok)
     shrinkBlock(block, _request->size);
 
-    _freeBlockSize -= block->blockSize();
-
     #if DEBUG
     // zero out data in newly claimed block
     memset(block->data(), 0, block->_dataSize);
@@ -143,8 +201,8 @@ MemMan::BlockInfo * MemMan::claimBlockBack(BlockInfo * block) {
     // if needs alignment, will be forward slightly, but should still be able
     // to accomodate `size`.
     byte_t * newBlockPtr = block->data() + block->_dataSize - (_request->size + _request->align + BlockInfoSize);
-    // get padding
-    size_t newBlockPadding = alignPadding((size_t)newBlockPtr, _request->align);
+    // get padding. data() follows BlockInfo, so align from there.
+    size_t newBlockPadding = alignPadding((size_t)newBlockPtr + BlockInfoSize, _request->align);
     // actual block location
     byte_t * newBlockAlignedPtr = newBlockPtr + newBlockPadding;
 
@@ -164,8 +222,10 @@ MemMan::BlockInfo * MemMan::claimBlockBack(BlockInfo * block) {
     assert(newBlock->_dataSize >= _request->size && "New block's data size is not big enough.");
     #endif // DEBUG
 
-    // update old block info
+    // update old block info (stays free, but may change bin)
+    unbinFreeBlock(block);
     block->_dataSize = newBlock->basePtr() - block->data();
+    binFreeBlock(block);
     _freeBlockSize -= newBlock->blockSize();
 
     // set data bytes to 0
@@ -175,6 +235,7 @@ MemMan::BlockInfo * MemMan::claimBlockBack(BlockInfo * block) {
 
     // block never realigns, so block->_prev not necessary
     linkBlocks(block, newBlock, block->_next);
+    ++_blockCount;
 
     return newBlock;
 }
@@ -197,9 +258,19 @@ MemMan::BlockInfo * MemMan::mergeWithNextBlock(BlockInfo * block) {
     if (block->_next == _tail) {
         _tail = block;
     }
-    block->_dataSize += block->_next->blockSize();
+    BlockInfo * next = block->_next;
+    unbinFreeBlock(next);
+    unbinFreeBlock(block);
+    block->_dataSize += next->blockSize();
+    binFreeBlock(block);
+    --_blockCount;
 
-    linkBlocks(block, block->_next->_next);
+    linkBlocks(block, next->_next);
+
+    // clear consumed BlockInfo
+    #if DEBUG
+    memset((void *)next, 0, BlockInfoSize);
+    #endif // DEBUG
 
     return block;
 }
@@ -257,6 +328,9 @@ MemMan::BlockInfo * MemMan::realignBlock(BlockInfo * block, size_t padding) {
     guard_t guard{_mainMutex};
 
     assert(block->_type == MEM_BLOCK_FREE && "Block must be free to realign.");
+    assert(block->_nextFree == nullptr && block->_prevFree == nullptr &&
+        _freeBins[FreeBinForSize(block->_dataSize)] != block &&
+        "Block must be unbinned before realign.");
 
     bool isFirstFree = (block == _firstFree);
     bool isHead = (block == _head);
@@ -303,6 +377,12 @@ MemMan::BlockInfo * MemMan::shrinkBlock(BlockInfo * block, size_t smallerSize) {
     block->_dataSize = smallerSize;
 
     linkBlocks(block->_prev, block, newBlock, block->_next);
+    binFreeBlock(newBlock);
+    _freeBlockSize += newBlock->blockSize();
+    ++_blockCount;
+
+    // new free space might be next to existing free block
+    mergeWithNextBlock(newBlock);
 
     return block;
 }
@@ -343,19 +423,45 @@ MemMan::BlockInfo * MemMan::resizeBlock(BlockInfo * block) {
     return block;
 }
 
-void MemMan::mergeAllAdjacentFreeBlocks() {
+bool MemMan::createAdjacentBlocks(size_t const * sizes, uint16_t nBlocks, size_t align, MemBlockType type, BlockInfo ** blocks) {
     guard_t guard{_mainMutex};
 
-    _blockCount = 0;
-    for (BlockInfo * bi = _head; bi; bi = bi->_next) {
-        BlockInfo * newBi = mergeWithNextBlock(bi);
-        if (newBi) bi = newBi;
-        ++_blockCount;
+    assert(nBlocks && "No blocks requested.");
+
+    // one block for all. each after the first also needs room for its
+    // BlockInfo and worst-case alignment.
+    size_t totalSize = 0;
+    for (uint16_t i = 0; i < nBlocks; ++i) {
+        totalSize += alignSize(sizes[i], align);
+        if (i > 0) totalSize += BlockInfoSize + align;
+    }
+    BlockInfo * block = createBlock({
+        .size = totalSize,
+        .align = align,
+        .type = type,
+    });
+    if (block == nullptr) return false;
+
+    // split the rest off the first, then claim from the front of what's left
+    // for each next one. each claim splits off the rest again.
+    blocks[0] = shrinkBlock(block, alignSize(sizes[0], align));
+    if (blocks[0] == nullptr) blocks[0] = block;
+    for (uint16_t i = 1; i < nBlocks; ++i) {
+        *_request = {
+            .size = alignSize(sizes[i], align),
+            .align = align,
+            .type = type,
+        };
+        blocks[i] = claimBlock(blocks[i-1]->_next);
+        assert(blocks[i] && "Adjacent block should fit in reserved run.");
+        blocks[i]->_type = type;
     }
 
     #if DEBUG
     validateAllBlocks();
     #endif // DEBUG
+
+    return true;
 }
 
 void MemMan::findFirstFreeBlock(BlockInfo * block) {
@@ -377,3 +483,65 @@ void MemMan::findFirstFreeBlock(BlockInfo * block) {
     // should only happen if no free blocks exist
     _firstFree = nullptr;
 }
+
+MemMan::BlockInfo * MemMan::findFreeBlock(size_t size, size_t align) const {
+    guard_t guard{_mainMutex};
+
+    // blocks in size's own bin might be too small, so check each, keeping best
+    uint8_t bin = FreeBinForSize(size);
+    BlockInfo * best = nullptr;
+    for (BlockInfo * bi = _freeBins[bin]; bi; bi = bi->_nextFree) {
+        if (bi->calcAlignDataSize(align) >= size &&
+            (best == nullptr || bi->_dataSize < best->_dataSize)) {
+            best = bi;
+        }
+    }
+    if (best) {
+        return best;
+    }
+
+    // every block in a higher bin is big enough, alignment aside
+    uint64_t mask = (bin < NumFreeBins - 1) ? _freeBinMask & (UINT64_MAX << (bin + 1)) : 0;
+    while (mask) {
+        for (BlockInfo * bi = _freeBins[__builtin_ctzll(mask)]; bi; bi = bi->_nextFree) {
+            if (bi->calcAlignDataSize(align) >= size) {
+                return bi;
+            }
+        }
+        // clear lowest set bit
+        mask &= mask - 1;
+    }
+
+    return nullptr;
+}
+
+void MemMan::binFreeBlock(BlockInfo * block) {
+    assert(block->_type == MEM_BLOCK_FREE && "Only free blocks can be binned.");
+    uint8_t bin = FreeBinForSize(block->_dataSize);
+    block->_prevFree = nullptr;
+    block->_nextFree = _freeBins[bin];
+    if (block->_nextFree) {
+        block->_nextFree->_prevFree = block;
+    }
+    _freeBins[bin] = block;
+    _freeBinMask |= (uint64_t)1 << bin;
+}
+
+void MemMan::unbinFreeBlock(BlockInfo * block) {
+    uint8_t bin = FreeBinForSize(block->_dataSize);
+    if (block->_prevFree) {
+        block->_prevFree->_nextFree = block->_nextFree;
+    }
+    else {
+        assert(_freeBins[bin] == block && "Block not in expected bin.");
+        _freeBins[bin] = block->_nextFree;
+        if (_freeBins[bin] == nullptr) {
+            _freeBinMask &= ~((uint64_t)1 << bin);
+        }
+    }
+    if (block->_nextFree) {
+        block->_nextFree->_prevFree = block->_prevFree;
+    }
+    block->_nextFree = nullptr;
+    block->_prevFree = nullptr;
+}
@@ -47,7 +47,10 @@ size_t MemMan::BlockInfo::calcAlignPaddingSize(size_t align) const {
 size_t MemMan::BlockInfo::calcAlignDataSize(size_t align) const {
     // there may be padding already set, but this should return what the value
     // would be if re-aligned to parameter align
-    return (_padding + _dataSize) - calcAlignPaddingSize(align);
+    size_t available = _padding + _dataSize;
+    size_t newPadding = calcAlignPaddingSize(align);
+    // small blocks might not even fit the padding
+    return (available > newPadding) ? available - newPadding : 0;
 }
 
 bool MemMan::BlockInfo::isAligned(size_t align) const {
@@ -1,7 +1,10 @@
 #include "MemMan.h"
 #include <new>
+#include <sys/stat.h>
 #include "../common/file_utils.h"
+#include "../common/string_utils.h"
 #include "Pool.h"
+#include "FrameRing.h"
 #include "FrameStack.h"
 #include "File.h"
 #include "Gobj.h"
@@ -10,6 +13,8 @@
 #include "FreeList.h"
 #include "CharKeys.h"
 #include "GLTFLoader.h"
+#include "ThreadArena.h"
+#include "../worker/JobSystem.h"
 #if DEBUG
 #include "../common/codetimer.h"
 #endif // DEBUG
@@ -25,6 +30,17 @@ FrameStack * MemMan::createFrameStack(size_t size) {
     return new (block->data()) FrameStack{size};
 }
 
+FrameRing * MemMan::createFrameRing(size_t size) {
+    guard_t guard{_mainMutex};
+
+    BlockInfo * block = createBlock({
+        .size = sizeof(FrameRing) + size,
+        .type = MEM_BLOCK_FRAMERING
+    });
+    if (!block) return nullptr;
+    return new (block->data()) FrameRing{size};
+}
+
 File * MemMan::createFileHandle(char const * path, bool loadNow, Request const & addlRequest) {
     guard_t guard{_mainMutex};
 
@@ -44,9 +60,25 @@ File * MemMan::createFileHandle(char const * path, bool loadNow, Request const &
     // make size one bigger. load process will write 0x00 in the last byte
     // after file contents so contents can be printed as string in place.
     size_t size = (size_t)fileSize + 1;
+    size_t totalSize = size + alignSize(sizeof(File), addlRequest.align);
+
+    // short lifetimes go in the frame ring if they fit
+    void * ringPtr = nullptr;
+    if (_frameRing) {
+        size_t align = (addlRequest.align > alignof(File)) ? addlRequest.align : alignof(File);
+        ringPtr = _frameRing->alloc(totalSize, align, addlRequest.lifetime);
+    }
+    if (ringPtr) {
+        File * f = new (ringPtr) File{size, path, addlRequest.align};
+        if (loadNow) {
+            f->load(fp);
+        }
+        fclose(fp);
+        return f;
+    }
 
     BlockInfo * block = createBlock({
-        .size = size + alignSize(sizeof(File), addlRequest.align),
+        .size = totalSize,
         .type = MEM_BLOCK_FILE,
         .high = addlRequest.high,
         .align = addlRequest.align,
@@ -71,6 +103,22 @@ File * MemMan::createFileHandle(char const * path, bool loadNow, Request const &
     return f;
 }
 
+File * MemMan::createFileMapping(char const * path) {
+    guard_t guard{_mainMutex};
+
+    BlockInfo * block = createBlock({
+        .size = sizeof(File),
+        .type = MEM_BLOCK_FILE,
+    });
+    if (!block) return nullptr;
+    File * f = new (block->data()) File{0, path};
+    if (!f->map()) {
+        releaseBlock(block);
+        return nullptr;
+    }
+    return f;
+}
+
 FreeList * MemMan::createFreeList(size_t max) {
     guard_t guard{_mainMutex};
 
@@ -93,108 +141,465 @@ CharKeys * MemMan::createCharKeys(size_t max) {
     return new (block->data()) CharKeys{max};
 }
 
+/*
+Loads in three phases, so a background load doesn't stall every other thread's
+allocations for its whole length:
+    • reserve/parse, unlocked but for allocations: beginGobjLoad
+    • fill, unlocked: only touches the scratch and the reserved block
+    • commit, locked: release scratch, then mark the Gobj loaded
+*/
 Gobj * MemMan::createGobj(char const * gltfPath, Gobj::Counts additionalCounts) {
-    guard_t guard{_mainMutex};
+    // baked image skips the GLTF entirely
+    Gobj * baked = createBakedGobj(gltfPath);
+    if (baked) {
+        if (!baked->hasMemoryFor(additionalCounts)) {
+            guard_t guard{_mainMutex};
+            baked = updateGobj(baked, additionalCounts);
+        }
+        return baked;
+    }
 
     #if DEBUG
     codetimer::start();
     #endif // DEBUG
 
-    // load gltf into high memory
-    File * gltf = createFileHandle(
-        gltfPath,
-        true, // load now
-        {
-            .align = 4,
-            .high = true,
-            .lifetime = 0
+    GobjLoad load;
+    if (beginGobjLoad(&load, gltfPath) == false) {
+        return nullptr;
+    }
+    #if DEBUG
+    long parseTime = codetimer::delta();
+    #endif // DEBUG
+
+    // create gobj block. marked loading before anyone else can see it.
+    Gobj * gobj;
+    BlockInfo * block;
+    {
+        guard_t guard{_mainMutex};
+        gobj = createGobj(load.loader->counts() + additionalCounts);
+        block = blockForPtr(gobj);
+        if (block) {
+            gobj->setStatus(Gobj::STATUS_LOADING);
         }
+    }
+    if (block == nullptr) {
+        fprintf(stderr, "Error getting Gobj block.\n");
+        endGobjLoad(&load, false);
+        return nullptr;
+    }
+
+    // load into gobj
+    #if DEBUG
+    long createTime = codetimer::delta();
+    #endif // DEBUG
+    bool success = fillGobj(&load, gobj);
+    #if DEBUG
+    long loadTime = codetimer::delta();
+    #endif // DEBUG
+
+    // early return if load failed
+    if (!success) {
+        gobj->setStatus(Gobj::STATUS_ERROR);
+        fprintf(stderr, "Error loading GLTF data into game object.\n");
+        releaseBlock(block);
+        endGobjLoad(&load, true);
+        return nullptr;
+    }
+
+    // check for exepected size
+    #if DEBUG
+    if (load.loader->isBinary()) {
+        size_t binSize = (load.gltf->mapped()) ? 0 : alignSize(load.loader->binDataSize(), Gobj::Align);
+        assert(
+            gobj->rawData + binSize ==
+            block->data() + block->dataSize() &&
+            "Gobj block unexpected size."
+        );
+    }
+    #endif // DEBUG
+
+    endGobjLoad(&load, true);
+    gobj->setStatus(Gobj::STATUS_LOADED);
+
+    // next load can skip parsing
+    if (_gobjCacheDir) {
+        bakeGobj(gobj, gltfPath);
+    }
+
+    // debug output
+    #if DEBUG
+    printl("LOADED GOBJ:");
+    // printl(gobj->jsonStr);
+    gobj->print();
+    printl("Time to load from disk: %ldµs (read and count %ldµs, load %ldµs)",
+        codetimer::delta(),
+        parseTime,
+        loadTime - createTime
     );
-    if (gltf == nullptr) {
+    #endif // DEBUG
+
+    return gobj;
+}
+
+/*
+Same phases as createGobj, each run across jobs for the whole batch. Between
+counting and filling, every block is reserved under one lock, as one run of
+adjacent blocks if a free block can hold them all.
+*/
+uint16_t MemMan::createGobjs(char const * const * gltfPaths, uint16_t nPaths, Gobj ** gobjs, JobSystem & jobs) {
+    if (nPaths == 0) return 0;
+
+    // scratch for whole batch
+    size_t loadsSize = alignSize(sizeof(GobjLoad) * nPaths, alignof(size_t));
+    size_t scratchSize = loadsSize + (sizeof(size_t) + sizeof(BlockInfo *)) * nPaths;
+    byte_t * scratch = (byte_t *)request({
+        .size = scratchSize,
+        .align = alignof(GobjLoad),
+        .high = true
+    });
+    if (scratch == nullptr) {
+        fprintf(stderr, "Error creating Gobj batch scratch\n");
+        return 0;
+    }
+    GobjLoad * loads = (GobjLoad *)scratch;
+    size_t * sizes = (size_t *)(scratch + loadsSize);
+    BlockInfo ** blocks = (BlockInfo **)(sizes + nPaths);
+    for (uint16_t i = 0; i < nPaths; ++i) {
+        new (loads + i) GobjLoad{};
+        gobjs[i] = nullptr;
+    }
+
+    // RESERVE/PARSE
+    // baked ones are done here. the rest are counted, or left without a loader.
+    jobs.parallelFor(0, nPaths, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            gobjs[i] = createBakedGobj(gltfPaths[i]);
+            if (gobjs[i] == nullptr) {
+                beginGobjLoad(loads + i, gltfPaths[i]);
+            }
+        }
+    });
+
+    // BLOCKS
+    // together, so a level's assets don't interleave with everything else
+    {
+        guard_t guard{_mainMutex};
+
+        uint16_t nBlocks = 0;
+        for (uint16_t i = 0; i < nPaths; ++i) {
+            if (loads[i].loader) {
+                sizes[nBlocks++] = loads[i].loader->counts().totalSize();
+            }
+        }
+        bool adjacent = nBlocks && createAdjacentBlocks(sizes, nBlocks, Gobj::Align, MEM_BLOCK_GOBJ, blocks);
+
+        uint16_t b = 0;
+        for (uint16_t i = 0; i < nPaths; ++i) {
+            if (loads[i].loader == nullptr) continue;
+            if (adjacent) {
+                gobjs[i] = new (blocks[b++]->data()) Gobj{loads[i].loader->counts()};
+            }
+            else {
+                gobjs[i] = createGobj(loads[i].loader->counts());
+            }
+            if (gobjs[i]) {
+                gobjs[i]->setStatus(Gobj::STATUS_LOADING);
+            }
+            else {
+                endGobjLoad(loads + i, false);
+            }
+        }
+    }
+
+    // FILL
+    // failures are marked, and left for commit to release
+    jobs.parallelFor(0, nPaths, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            if (loads[i].loader == nullptr) continue;
+            if (fillGobj(loads + i, gobjs[i]) == false) {
+                fprintf(stderr, "Error loading GLTF data into game object \"%s\".\n", gltfPaths[i]);
+                gobjs[i]->setStatus(Gobj::STATUS_ERROR);
+            }
+            else if (_gobjCacheDir) {
+                bakeGobj(gobjs[i], gltfPaths[i]);
+            }
+        }
+    });
+
+    // COMMIT
+    uint16_t nLoaded = 0;
+    {
+        guard_t guard{_mainMutex};
+
+        for (uint16_t i = 0; i < nPaths; ++i) {
+            if (loads[i].loader) {
+                endGobjLoad(loads + i, true);
+                if (gobjs[i]->isLoading()) {
+                    gobjs[i]->setStatus(Gobj::STATUS_LOADED);
+                }
+                else {
+                    releaseBlock(blockForPtr(gobjs[i]));
+                    gobjs[i] = nullptr;
+                }
+            }
+            if (gobjs[i]) ++nLoaded;
+        }
+        request({.ptr = scratch});
+    }
+
+    #if DEBUG
+    printl("Loaded %u of %u Gobjs", nLoaded, nPaths);
+    #endif // DEBUG
+
+    return nLoaded;
+}
+
+bool MemMan::beginGobjLoad(GobjLoad * load, char const * gltfPath) {
+    // map large GLBs, so the BIN chunk can be used in place. mapping is
+    // handed to the Gobj, and released with it.
+    size_t pathLen = strlen(gltfPath);
+    struct stat st;
+    if (_mapGLBMinSize &&
+        pathLen > 4 &&
+        strEqu(gltfPath + pathLen - 4, ".glb") &&
+        stat(gltfPath, &st) == 0 &&
+        (size_t)st.st_size >= _mapGLBMinSize
+    ) {
+        load->gltf = createFileMapping(gltfPath);
+    }
+    // otherwise reserve room in high memory, and read outside the lock
+    if (load->gltf == nullptr) {
+        load->gltf = createFileHandle(
+            gltfPath,
+            false, // load later
+            {
+                .align = 4,
+                .high = true,
+            }
+        );
+        if (load->gltf && load->gltf->load() == false) {
+            endGobjLoad(load, false);
+            return false;
+        }
+    }
+    if (load->gltf == nullptr) {
         fprintf(stderr, "Error creating File block\n");
-        return nullptr;
+        return false;
     }
 
     // base path of gltf
-    uint32_t gltfPathLen = strlen(gltfPath);
-    BlockInfo * dirNameBlock = createBlock({
-        .size = gltfPathLen,
-        .lifetime = 0,
+    load->dirName = (char *)request({
+        .size = pathLen,
         .high = true
     });
-    char * dirName = (char *)dirNameBlock->data();
-    uint32_t dirNameLen = (uint32_t)copyDirName(dirName, gltfPath);
-
-    // LOADER
-    BlockInfo * loaderBlock = createBlock({
+    void * loaderPtr = request({
         .size = sizeof(GLTFLoader),
-        .lifetime = 0,
+        .align = alignof(GLTFLoader),
         .high = true
     });
-    GLTFLoader * loader = new (loaderBlock->data()) GLTFLoader{gltf->data(), dirName};
+    if (load->dirName == nullptr || loaderPtr == nullptr) {
+        fprintf(stderr, "Error creating loader block\n");
+        if (loaderPtr) request({.ptr = loaderPtr});
+        endGobjLoad(load, false);
+        return false;
+    }
+    load->dirNameLen = (uint32_t)copyDirName(load->dirName, gltfPath);
+
+    // LOADER
+    GLTFLoader * loader = new (loaderPtr) GLTFLoader{load->gltf->data(), load->dirName};
+    load->loader = loader;
     if (loader->validData() == false) {
         fprintf(stderr, "Error creating loader block\n");
-        return nullptr;
+        endGobjLoad(load, false);
+        return false;
     }
+    loader->setBinInPlace(load->gltf->mapped());
 
     // create room to save the loadedDirName string
     loader->setCounts({
-        .allStrLen = dirNameLen + 1,
+        .allStrLen = load->dirNameLen + 1,
+    });
+
+    // TAPE
+    // parse JSON once. counting and loading both replay the tape. without
+    // room for it, falls back to parsing the text for each.
+    load->tape = request({
+        .size = loader->tapeSize(),
+        .align = alignof(GLTFLoader::Token),
+        .high = true
     });
+    if (load->tape == nullptr) {
+        fprintf(stderr, "No room for GLTF tape, parsing JSON text twice.\n");
+    }
+    else if (loader->tokenize(load->tape) == false) {
+        fprintf(stderr, "Error tokenizing GLTF JSON\n");
+        endGobjLoad(load, false);
+        return false;
+    }
 
     // calc size
     loader->calculateSize();
 
-    // create gobj block
-    Gobj * gobj = createGobj(loader->counts() + additionalCounts);
-    BlockInfo * block = blockForPtr(gobj);
-    if (block == nullptr) {
-        fprintf(stderr, "Error getting Gobj block.\n");
-        return nullptr;
-    }
+    return true;
+}
 
-    // load into gobj
-    gobj->setStatus(Gobj::STATUS_LOADING);
-    bool success = loader->load(gobj);
+bool MemMan::fillGobj(GobjLoad * load, Gobj * gobj) {
+    // from here, mapping is released with the gobj
+    if (load->gltf->mapped()) {
+        gobj->mappedFile = load->gltf;
+    }
 
-    // early return if load failed
-    if (!success) {
-        gobj->setStatus(Gobj::STATUS_ERROR);
-        fprintf(stderr, "Error loading GLTF data into game object.\n");
-        releaseBlock(block);
-        return nullptr;
+    if (load->loader->load(gobj) == false) {
+        return false;
     }
 
     // set loadedDirName
-    gobj->loadedDirName = gobj->strings->copyStr(dirName, dirNameLen);
+    gobj->loadedDirName = gobj->strings->copyStr(load->dirName, load->dirNameLen);
 
     // bytesLeft should be 0 at this point.
     assert(gobj->strings->bytesLeft() == 0 && "Miscalculation in string buffer. Should be full.");
 
-    gobj->setStatus(Gobj::STATUS_LOADED);
+    return true;
+}
 
-    // check for exepected size
-    #if DEBUG
-    if (loader->isBinary()) {
-        assert(
-            gobj->rawData + alignSize(loader->binDataSize(), Gobj::Align) ==
-            block->data() + block->dataSize() &&
-            "Gobj block unexpected size."
-        );
+void MemMan::endGobjLoad(GobjLoad * load, bool keepMapping) {
+    guard_t guard{_mainMutex};
+
+    if (load->tape)     request({.ptr = load->tape});
+    if (load->loader)   request({.ptr = load->loader});
+    if (load->dirName)  request({.ptr = load->dirName});
+    if (load->gltf && !(keepMapping && load->gltf->mapped())) {
+        releaseBlock(blockForPtr(load->gltf));
+    }
+    *load = {};
+}
+
+// baked images are named for a hash of the source path, which is also stored
+// in the header to catch collisions
+static constexpr size_t BakedPathMax = 512;
+static bool bakedPathFor(char * buf, char const * cacheDir, char const * gltfPath) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char const * c = gltfPath; *c; ++c) {
+        hash = (hash ^ (uint8_t)*c) * 0x00000100000001b3ull;
     }
+    size_t dirLen = strlen(cacheDir);
+    char const * sep = (dirLen && cacheDir[dirLen-1] != '/') ? "/" : "";
+    int len = snprintf(buf, BakedPathMax, "%s%s%016llx.gobj", cacheDir, sep, (unsigned long long)hash);
+    return (len > 0 && (size_t)len < BakedPathMax);
+}
+
+/*
+Only the block is created and released under the lock. Header checks, hashing
+and reading the image all happen outside it, with the block typed generic
+until the image is complete, so nothing treats it as a Gobj before then.
+*/
+Gobj * MemMan::createBakedGobj(char const * gltfPath) {
+    if (_gobjCacheDir == nullptr) return nullptr;
+
+    #if DEBUG
+    codetimer::start();
     #endif // DEBUG
 
-    // debug output
+    char path[BakedPathMax];
+    if (!bakedPathFor(path, _gobjCacheDir, gltfPath)) return nullptr;
+    // not baked yet. r+ so the key can be updated in place.
+    FILE * fp = fopen(path, "r+b");
+    if (!fp) return nullptr;
+
+    Gobj::BakeHeader header;
+    Gobj::BakeKey key;
+    bool valid =
+        fread(&header, sizeof(Gobj::BakeHeader), 1, fp) == 1 &&
+        memcmp(header.magic, Gobj::BakeHeader{}.magic, sizeof(header.magic)) == 0 &&
+        header.version == Gobj::BakeVersion &&
+        header.layout == Gobj::bakeLayout() &&
+        strncmp(header.sourcePath, gltfPath, sizeof(header.sourcePath)) == 0 &&
+        Gobj::bakeKeyForFile(gltfPath, &key, false);
+
+    // touched (checkout, copy) but maybe not changed. compare contents, and
+    // keep the new mtime if they match so they aren't hashed next time.
+    if (valid && (key.mtime != header.key.mtime || key.size != header.key.size)) {
+        valid =
+            key.size == header.key.size &&
+            Gobj::bakeKeyForFile(gltfPath, &key, true) &&
+            key.hash == header.key.hash;
+        if (valid) {
+            header.key = key;
+            fseek(fp, 0L, SEEK_SET);
+            fwrite(&header, sizeof(Gobj::BakeHeader), 1, fp);
+            fseek(fp, (long)sizeof(Gobj::BakeHeader), SEEK_SET);
+        }
+    }
+    if (!valid) {
+        fclose(fp);
+        return nullptr;
+    }
+
+    BlockInfo * block;
+    {
+        guard_t guard{_mainMutex};
+        block = createBlock({
+            .size = header.imageSize,
+            .align = Gobj::Align,
+        });
+    }
+    if (block == nullptr) {
+        fprintf(stderr, "Error creating Gobj block for baked \"%s\"\n", gltfPath);
+        fclose(fp);
+        return nullptr;
+    }
+    size_t readSize = fread(block->data(), 1, header.imageSize, fp);
+    fclose(fp);
+    Gobj * gobj = (Gobj *)block->data();
+    if (readSize != header.imageSize || gobj->maxCounts.totalSize() != header.imageSize) {
+        fprintf(stderr, "Baked Gobj \"%s\" is incomplete, rebaking.\n", path);
+        guard_t guard{_mainMutex};
+        releaseBlock(block);
+        return nullptr;
+    }
+    gobj->unbake();
+    {
+        guard_t guard{_mainMutex};
+        block->_type = MEM_BLOCK_GOBJ;
+    }
+
     #if DEBUG
-    printl("LOADED GOBJ:");
-    // printl(gobj->jsonStr);
-    gobj->print();
-    printl("Time to load from disk: %ldµs", codetimer::delta());
+    printl("Time to load baked gobj: %ldµs (%s)", codetimer::delta(), gltfPath);
     #endif // DEBUG
 
     return gobj;
 }
 
+// no lock: only reads gobj, which the caller is still loading
+bool MemMan::bakeGobj(Gobj const * gobj, char const * gltfPath) {
+    if (_gobjCacheDir == nullptr) return false;
+
+    char path[BakedPathMax];
+    char tempPath[BakedPathMax + 4];
+    Gobj::BakeKey key;
+    if (!bakedPathFor(path, _gobjCacheDir, gltfPath) ||
+        !Gobj::bakeKeyForFile(gltfPath, &key, true)
+    ) {
+        return false;
+    }
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+
+    // written aside and renamed, so a partial image is never read
+    mkdir(_gobjCacheDir, 0755);
+    FILE * fp = fopen(tempPath, "wb");
+    if (!fp) {
+        fprintf(stderr, "Error creating baked Gobj \"%s\": %d\n", tempPath, errno);
+        return false;
+    }
+    bool success = gobj->bake(fp, key, gltfPath);
+    success = (fclose(fp) == 0) && success;
+    if (success && rename(tempPath, path) == 0) {
+        return true;
+    }
+    remove(tempPath);
+    return false;
+}
+
 Gobj * MemMan::createGobj(Gobj::Counts const & counts, int lifetime) {
     // create block
     BlockInfo * block = createBlock({
@@ -243,10 +648,11 @@ FSA * MemMan::createFSA(MemManFSASetup const & setup) {
     // solution to specifically align both FSA and containing block here, as it
     // makes size calculatable beforehand. otherwise differnce between FSA-base
     // and FSA-data might be unpredictable, resulting in
-    size_t blockDataSize = alignSize(sizeof(FSA), setup.align) + dataSize;
+    size_t align = FSA::GroupAlign(setup.align);
+    size_t blockDataSize = alignSize(sizeof(FSA), align) + dataSize;
     BlockInfo * block = createBlock({
         .size = blockDataSize,
-        .align = setup.align,
+        .align = align,
         .type = MEM_BLOCK_FSA,
     });
     if (!block) return nullptr;
@@ -263,6 +669,37 @@ FSA * MemMan::createFSA(MemManFSASetup const & setup) {
     return fsa;
 }
 
+FSA * MemMan::createFSASlab(uint8_t groupIndex) {
+    guard_t guard{_mainMutex};
+
+    assert(_fsa && "FSA not created.");
+    assert(groupIndex < FSA::Max && "Index out of range.");
+
+    // only grow groups that were configured
+    if (_fsa->_slabSize == 0 || _fsa->_nSubBlocks[groupIndex] == 0) {
+        return nullptr;
+    }
+
+    MemManFSASetup setup;
+    setup.nSubBlocks[groupIndex] = FSA::SlabSubBlockCount(_fsa->_slabSize, groupIndex);
+    setup.align = _fsa->_align;
+    // slabs are created mid-request, and createFSA overwrites
+    // _request/_result. keep them intact for the caller.
+    Request request = *_request;
+    Result result = *_result;
+    FSA * slab = createFSA(setup);
+    *_request = request;
+    *_result = result;
+    if (!slab) return nullptr;
+
+    // newest first, as it is the one with room
+    slab->_primary = _fsa;
+    slab->_nextSlab = _fsa->_slabs[groupIndex];
+    _fsa->_slabs[groupIndex] = slab;
+    ++_fsa->_nSlabs[groupIndex];
+    return slab;
+}
+
 Array<MemMan::AutoRelease> * MemMan::createAutoReleaseBuffer(size_t size) {
     guard_t guard{_mainMutex};
 
@@ -279,3 +716,17 @@ Array<MemMan::AutoRelease> * MemMan::createAutoReleaseBuffer(size_t size) {
 
     return buf;
 }
+
+ThreadArena * MemMan::createThreadArena(size_t size) {
+    guard_t guard{_mainMutex};
+
+    size_t dataSize = ThreadArena::DataSize(size);
+    BlockInfo * block = createBlock({
+        .size = alignSize(sizeof(ThreadArena), ThreadArena::Align) + dataSize,
+        .align = ThreadArena::Align,
+        .type = MEM_BLOCK_THREADARENA,
+    });
+    if (!block) return nullptr;
+    ++_nThreadArenas;
+    return new (block->data()) ThreadArena{dataSize};
+}
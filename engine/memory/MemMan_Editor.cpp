@@ -1,12 +1,20 @@
 #include "MemMan.h"
 #include <stdio.h>
+#include <chrono>
+#include <thread>
+#include <nfd.h>
 #include "../common/imgui_bgfx_glfw/imgui_bgfx_glfw.h"
+#include "../common/file_utils.h"
 #include "../MrManager.h"
 #include "mem_utils.h"
 #include "FSA.h"
 #include "File.h"
+#include "FrameRing.h"
+#include "FrameStack.h"
 #include "FreeList.h"
+#include "GLTFLoader.h"
 #include "CharKeys.h"
+#include "ThreadArena.h"
 
 #if DEV_INTERFACE
 
@@ -168,6 +176,24 @@ void MemMan::editor() {
             }
         }
 
+        // THREAD ARENA BENCHMARK ------------------------------------------- //
+        Dummy(ImVec2(0.0f, 10.0f));
+        editorThreadArenaBenchmark();
+
+        // BLOCK LOOKUP BENCHMARK ------------------------------------------- //
+        Dummy(ImVec2(0.0f, 10.0f));
+        editorBlockLookupBenchmark();
+
+        // GLTF LOAD BENCHMARK ---------------------------------------------- //
+        Dummy(ImVec2(0.0f, 10.0f));
+        editorGLTFLoadBenchmark();
+
+        #if DEBUG
+        // FRAME STACK TEST ------------------------------------------------- //
+        Dummy(ImVec2(0.0f, 10.0f));
+        editorFrameStackTest();
+        #endif // DEBUG
+
         Dummy(ImVec2(0.0f, 10.0f));
         Separator();
     }
@@ -296,6 +322,12 @@ void MemMan::editor() {
                 break;
             }
 
+            // FRAMERING
+            case MEM_BLOCK_FRAMERING: {
+                ((FrameRing *)b->data())->editorEditBlock();
+                break;
+            }
+
             // FREELIST
             case MEM_BLOCK_FREELIST: {
                 ((FreeList *)b->data())->editorEditBlock();
@@ -320,6 +352,12 @@ void MemMan::editor() {
                 break;
             }
 
+            // THREADARENA
+            case MEM_BLOCK_THREADARENA: {
+                ((ThreadArena *)b->data())->editorEditBlock();
+                break;
+            }
+
             // do nothing
             default: {}
             }
@@ -341,6 +379,308 @@ void MemMan::editor() {
     Unindent();
 }
 
+/*
+Compares small allocation throughput of the main locked path against thread
+arenas. Each thread keeps a ring of live allocations of varying small sizes,
+freeing the oldest as it allocates.
+*/
+void MemMan::editorThreadArenaBenchmark() {
+    static constexpr int NThreadCounts = 4;
+    static constexpr int ThreadCounts[NThreadCounts] = {1, 2, 4, 8};
+    static constexpr int Iterations = 20000;
+    static constexpr int RingSize = 64;
+    // allocations per second, [0] main path, [1] thread arenas
+    static double results[NThreadCounts][2] = {};
+    static bool didRun = false;
+
+    TextUnformatted("Thread Arena Benchmark:");
+    SameLine();
+    if (Button("Run##ThreadArenaBenchmark")) {
+        for (int t = 0; t < NThreadCounts; ++t) {
+            for (int useArena = 0; useArena < 2; ++useArena) {
+                int nThreads = ThreadCounts[t];
+                std::thread threads[ThreadCounts[NThreadCounts-1]];
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < nThreads; ++i) {
+                    threads[i] = std::thread{[this, useArena]{
+                        if (useArena) attachThreadArena();
+                        void * ring[RingSize] = {nullptr};
+                        for (int j = 0; j < Iterations; ++j) {
+                            void *& slot = ring[j % RingSize];
+                            if (slot) request({.ptr = slot});
+                            slot = request({.size = (size_t)(16 + (j * 37) % 1000)});
+                        }
+                        for (void * ptr : ring) {
+                            if (ptr) request({.ptr = ptr});
+                        }
+                        if (useArena) detachThreadArena();
+                    }};
+                }
+                for (int i = 0; i < nThreads; ++i) {
+                    threads[i].join();
+                }
+                std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+                results[t][useArena] = (double)(nThreads * Iterations) / seconds.count();
+            }
+        }
+        didRun = true;
+    }
+
+    if (didRun) {
+        for (int t = 0; t < NThreadCounts; ++t) {
+            Text("%d thread(s): main lock %9.0f allocs/s, arenas %9.0f allocs/s (%.1fx)",
+                ThreadCounts[t],
+                results[t][0],
+                results[t][1],
+                results[t][1] / results[t][0]
+            );
+        }
+    }
+}
+
+/*
+Records createBlock and releaseBlock calls on this MemMan, then replays them on
+a scratch MemMan of the same size, once finding blocks through the free bins
+and once walking the block list first-fit. Releases of blocks created before
+recording started are skipped. DEBUG builds validate every block on each call,
+which swamps the lookup, so compare in release.
+*/
+void MemMan::editorBlockLookupBenchmark() {
+    static constexpr uint32_t MaxEvents = 1 << 15;
+    static TraceEvent events[MaxEvents];
+    static uint32_t nEvents = 0;
+    // for releases, index of the event that created the block
+    static uint32_t creates[MaxEvents];
+    // for creates, block claimed during replay
+    static BlockInfo * replayed[MaxEvents];
+    struct Result {
+        double ms;
+        uint32_t failed;
+        size_t freeBlocks;
+        size_t largestFree;
+    };
+    // [0] bins, [1] first-fit
+    static Result results[2] = {};
+    static bool didRun = false;
+
+    TextUnformatted("Block Lookup Benchmark:");
+    SameLine();
+    if (trace == nullptr) {
+        if (Button("Record##BlockLookupBenchmark")) {
+            guard_t guard{_mainMutex};
+            trace = events;
+            traceLength = 0;
+            traceCapacity = MaxEvents;
+            didRun = false;
+        }
+        if (nEvents) {
+            SameLine();
+            if (Button("Replay##BlockLookupBenchmark")) {
+                for (uint32_t i = 0; i < nEvents; ++i) {
+                    creates[i] = UINT32_MAX;
+                    if (events[i].release == false) continue;
+                    for (uint32_t j = i; j-- > 0;) {
+                        if (events[j].block == events[i].block) {
+                            if (events[j].release == false) creates[i] = j;
+                            break;
+                        }
+                    }
+                }
+
+                EngineSetup setup;
+                setup.memManSize = _size;
+                setup.memManFrameStackSize = 0;
+                setup.memManFrameRingSize = 0;
+                setup.memManAutoReleaseBufferSize = 0;
+                setup.memManThreadArenaSize = 0;
+                for (int firstFit = 0; firstFit < 2; ++firstFit) {
+                    MemMan replay;
+                    replay.init(setup);
+                    replay._firstFitLookup = firstFit;
+                    Result & result = results[firstFit];
+                    result = {};
+
+                    auto start = std::chrono::steady_clock::now();
+                    for (uint32_t i = 0; i < nEvents; ++i) {
+                        TraceEvent const & e = events[i];
+                        if (e.release == false) {
+                            replayed[i] = replay.createBlock({
+                                .size = e.size,
+                                .align = e.align,
+                                .high = e.high
+                            });
+                            if (replayed[i] == nullptr) ++result.failed;
+                        }
+                        else if (creates[i] != UINT32_MAX && replayed[creates[i]]) {
+                            replay.releaseBlock(replayed[creates[i]]);
+                        }
+                    }
+                    std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+                    result.ms = ms.count();
+
+                    for (BlockInfo * bi = replay.firstBlock(); bi; bi = bi->_next) {
+                        if (bi->_type != MEM_BLOCK_FREE) continue;
+                        ++result.freeBlocks;
+                        if (bi->_dataSize > result.largestFree) result.largestFree = bi->_dataSize;
+                    }
+                    replay.shutdown();
+                }
+                didRun = true;
+            }
+        }
+    }
+    else {
+        Text("%u events", traceLength);
+        SameLine();
+        if (Button("Stop##BlockLookupBenchmark")) {
+            guard_t guard{_mainMutex};
+            nEvents = traceLength;
+            trace = nullptr;
+            traceLength = 0;
+            traceCapacity = 0;
+        }
+    }
+
+    if (didRun) {
+        for (int firstFit = 0; firstFit < 2; ++firstFit) {
+            Result const & result = results[firstFit];
+            Text("%s %u events %.2fms, %u failed, %zu free blocks, largest %s",
+                (firstFit) ? "first-fit:" : "bins:     ",
+                nEvents,
+                result.ms,
+                result.failed,
+                result.freeBlocks,
+                mm.frameByteSizeStr(result.largestFree)
+            );
+        }
+    }
+}
+
+/*
+Times loading a chosen glTF file into a Gobj, parsing the JSON text for each
+pass against tokenizing it once and replaying the tape. Every run loads a fresh
+copy of the file, since tokenizing modifies it. Copying isn't timed.
+*/
+void MemMan::editorGLTFLoadBenchmark() {
+    static constexpr int Runs = 5;
+    // average milliseconds per load, [0] text, [1] tape
+    static double results[2] = {};
+    static size_t fileSize = 0;
+    static size_t tapeSize = 0;
+    static char const * error = nullptr;
+    static bool didRun = false;
+
+    TextUnformatted("GLTF Load Benchmark:");
+    SameLine();
+    nfdchar_t * path = NULL;
+    if (Button("Run##GLTFLoadBenchmark") && NFD_OpenDialog(NULL, ".", &path) == NFD_OKAY) {
+        didRun = false;
+        error = nullptr;
+
+        char dirName[File::Path::MAX];
+        copyDirName(dirName, path);
+        File * file = createFileHandle(path, true, {.align = 4, .high = true});
+        byte_t * copy = nullptr;
+        if (file) {
+            copy = (byte_t *)request({.size = file->size(), .align = 4, .high = true});
+            fileSize = file->fileSize();
+        }
+        if (copy == nullptr) {
+            error = "could not read file";
+        }
+
+        for (int useTape = 0; useTape < 2 && error == nullptr; ++useTape) {
+            std::chrono::duration<double, std::milli> elapsed{0};
+            for (int r = 0; r < Runs && error == nullptr; ++r) {
+                memcpy(copy, file->data(), file->size());
+                auto start = std::chrono::steady_clock::now();
+
+                GLTFLoader loader{copy, dirName};
+                void * tape = nullptr;
+                if (useTape) {
+                    tapeSize = loader.tapeSize();
+                    tape = request({
+                        .size = tapeSize,
+                        .align = alignof(GLTFLoader::Token),
+                        .high = true
+                    });
+                    if (tape == nullptr || loader.tokenize(tape) == false) {
+                        error = "could not tokenize";
+                    }
+                }
+                if (error == nullptr) {
+                    loader.calculateSize();
+                    Gobj * gobj = nullptr;
+                    {
+                        guard_t guard{_mainMutex};
+                        gobj = createGobj(loader.counts());
+                    }
+                    if (gobj == nullptr || loader.load(gobj) == false) {
+                        error = "could not load";
+                    }
+                    if (gobj) request({.ptr = gobj});
+                }
+                if (tape) request({.ptr = tape});
+
+                elapsed += std::chrono::steady_clock::now() - start;
+            }
+            results[useTape] = elapsed.count() / Runs;
+        }
+
+        if (copy) request({.ptr = copy});
+        if (file) {
+            guard_t guard{_mainMutex};
+            releaseBlock(blockForPtr(file));
+        }
+        free(path);
+        didRun = (error == nullptr);
+    }
+
+    if (error) {
+        SameLine();
+        TextUnformatted(error);
+    }
+    if (didRun) {
+        Text("file %s, text %.2fms, tape %.2fms (%.1fx), tape size %s",
+            mm.frameByteSizeStr(fileSize),
+            results[0],
+            results[1],
+            results[0] / results[1],
+            mm.frameByteSizeStr(tapeSize)
+        );
+    }
+}
+
+#if DEBUG
+/*
+Runs FrameStack::test on a temporary frame-stack with the same pen size as the
+main one, from 1 and 8 threads at once.
+*/
+void MemMan::editorFrameStackTest() {
+    static char const * result = nullptr;
+
+    TextUnformatted("Frame Stack Thread Test:");
+    SameLine();
+    if (Button("Run##FrameStackTest")) {
+        FrameStack * fs = createFrameStack(1024*1024*4);
+        if (fs == nullptr) {
+            result = "could not create frame-stack";
+        }
+        else {
+            fs->setThreadPenSize(mm.frameStack ? mm.frameStack->threadPenSize() : 1024*64);
+            bool success = fs->test(1, 20000) && fs->test(8, 5000);
+            result = success ? "passed" : "FAILED (see log)";
+            guard_t guard{_mainMutex};
+            releaseBlock(blockForPtr(fs));
+        }
+    }
+    if (result) {
+        SameLine();
+        TextUnformatted(result);
+    }
+}
+#endif // DEBUG
+
 void MemMan::addTestAlloc(void * ptr, char const * formatString, ...) {
     testAllocs[nTestAllocs++] = {.ptr=ptr};
 
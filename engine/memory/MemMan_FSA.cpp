@@ -0,0 +1,148 @@
+#include "MemMan.h"
+#include <assert.h>
+#include "FSA.h"
+
+/*
+Mirrors the FSA parts of request(). FSA claim and release are atomic, so these
+never touch _mainMutex. Anything needing auto-release bookkeeping, alignment,
+or a move between FSA and blocks is left to the main path.
+*/
+bool MemMan::fsaRequest(Request const & request, void ** ptr) {
+    if (_fsa == nullptr ||
+        request.lifetime >= 0) { // auto-release buffer is not thread-safe
+        return false;
+    }
+
+    // alloc
+    if (request.size && request.ptr == nullptr) {
+        if (request.align != 0 || request.high) {
+            return false;
+        }
+        *ptr = _fsa->alloc(request.size);
+        return (*ptr != nullptr);
+    }
+
+    // free
+    if (request.size == 0) {
+        if (request.ptr == nullptr || _fsa->destroy(request.ptr) == false) {
+            return false;
+        }
+        *ptr = nullptr;
+        return true;
+    }
+
+    // realloc, current group is big enough
+    uint16_t groupIndex;
+    if (_fsa->indicesForPtr(request.ptr, &groupIndex, nullptr) &&
+        FSA::SubBlockByteSize(groupIndex) >= request.size) {
+        *ptr = request.ptr;
+        return true;
+    }
+
+    return false;
+}
+
+void * MemMan::fsaAlloc(size_t size, FSA ** foundFSA) {
+    if (_fsa == nullptr || size < FSA::MinBytes || size > FSA::MaxBytes) {
+        return nullptr;
+    }
+
+    // primary first, no lock needed
+    void * ptr = _fsa->alloc(size);
+    if (ptr) {
+        if (foundFSA) *foundFSA = _fsa;
+        return ptr;
+    }
+
+    guard_t guard{_mainMutex};
+
+    // existing slabs of this group
+    uint8_t groupIndex = FSA::IndexForByteSize(size);
+    for (FSA * slab = _fsa->_slabs[groupIndex]; slab; slab = slab->_nextSlab) {
+        if ((ptr = slab->alloc(size))) {
+            if (foundFSA) *foundFSA = slab;
+            return ptr;
+        }
+    }
+
+    // grow
+    FSA * slab = createFSASlab(groupIndex);
+    if (slab == nullptr) {
+        return nullptr;
+    }
+    ptr = slab->alloc(size);
+    assert(ptr && "New FSA slab could not alloc.");
+    if (foundFSA) *foundFSA = slab;
+    return ptr;
+}
+
+bool MemMan::fsaFree(void * ptr) {
+    if (_fsa == nullptr) {
+        return false;
+    }
+
+    // primary first, no lock needed
+    if (_fsa->destroy(ptr)) {
+        return true;
+    }
+
+    guard_t guard{_mainMutex};
+
+    FSA * slab = fsaForPtr(ptr);
+    if (slab == nullptr) {
+        return false;
+    }
+    assert(slab->isSlab() && "Expected slab.");
+
+    uint16_t groupIndex;
+    slab->indicesForPtr(ptr, &groupIndex, nullptr);
+    slab->destroy(ptr);
+    if (slab->_nLive[groupIndex] == 0) {
+        releaseFSASlab(slab);
+    }
+    return true;
+}
+
+FSA * MemMan::fsaForPtr(void * ptr) const {
+    if (_fsa == nullptr) {
+        return nullptr;
+    }
+    if (_fsa->containsPtr(ptr)) {
+        return _fsa;
+    }
+    if (containsPtr(ptr) == false) {
+        return nullptr;
+    }
+
+    guard_t guard{_mainMutex};
+    for (uint16_t groupIndex = 0; groupIndex < FSA::Max; ++groupIndex) {
+        for (FSA * slab = _fsa->_slabs[groupIndex]; slab; slab = slab->_nextSlab) {
+            if (slab->containsPtr(ptr)) {
+                return slab;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void MemMan::releaseFSASlab(FSA * slab) {
+    guard_t guard{_mainMutex};
+
+    // find group of slab; it only has one
+    uint16_t groupIndex = 0;
+    while (groupIndex < FSA::Max && slab->_nSubBlocks[groupIndex] == 0) ++groupIndex;
+    assert(groupIndex < FSA::Max && "Slab has no group.");
+
+    // unlink
+    FSA ** link = &_fsa->_slabs[groupIndex];
+    while (*link != slab) {
+        assert(*link && "Slab not in chain.");
+        link = &(*link)->_nextSlab;
+    }
+    *link = slab->_nextSlab;
+    --_fsa->_nSlabs[groupIndex];
+
+    BlockInfo * block = blockForPtr(slab);
+    assert(block && block->_type == MEM_BLOCK_FSA && "Invalid slab block.");
+    releaseBlock(block);
+}
@@ -0,0 +1,117 @@
+#include "MemMan.h"
+#include <assert.h>
+#include <string.h>
+#include "FSA.h"
+#include "ThreadArena.h"
+
+thread_local ThreadArena * MemMan::_threadArena = nullptr;
+
+void MemMan::attachThreadArena() {
+    if (_threadArena || _threadArenaSize == 0) {
+        return;
+    }
+    _threadArena = createThreadArena(_threadArenaSize);
+}
+
+void MemMan::detachThreadArena() {
+    if (_threadArena == nullptr) {
+        return;
+    }
+    ThreadArena * arena = _threadArena;
+    _threadArena = nullptr;
+    if (arena->retire()) {
+        releaseThreadArena(arena);
+    }
+}
+
+/*
+Mirrors request() for allocations that can live in, or already live in, a
+thread arena. Only the refill and final release of an arena take the lock.
+*/
+bool MemMan::threadArenaRequest(Request const & request, void ** ptr) {
+    // alloc
+    if (request.size && request.ptr == nullptr) {
+        if (_threadArena == nullptr ||
+            request.size > ThreadArena::MaxBytes ||
+            request.align > ThreadArena::Align ||
+            request.lifetime >= 0 || // auto-release buffer is not thread-safe
+            request.high ||
+            (request.type != MEM_BLOCK_GENERIC && request.type != MEM_BLOCK_BGFX)) {
+            return false;
+        }
+        *ptr = _threadArena->alloc(request.size);
+        // arena full. swap in a fresh one and try again
+        if (*ptr == nullptr && refillThreadArena()) {
+            *ptr = _threadArena->alloc(request.size);
+        }
+        return (*ptr != nullptr);
+    }
+
+    // realloc and free only handled here if ptr is already in an arena
+    ThreadArena * arena = threadArenaForPtr(request.ptr);
+    if (arena == nullptr) {
+        return false;
+    }
+
+    // free
+    if (request.size == 0) {
+        if (arena->destroy(request.ptr, arena == _threadArena)) {
+            releaseThreadArena(arena);
+        }
+        *ptr = nullptr;
+        return true;
+    }
+
+    // realloc, current size class is big enough
+    size_t currentSize = arena->sizeForPtr(request.ptr);
+    if (request.size <= currentSize && request.align <= ThreadArena::Align) {
+        *ptr = request.ptr;
+        return true;
+    }
+
+    // realloc, move to new location (might be another arena or main path).
+    // can be smaller, when moved only for alignment.
+    Request moveRequest = request;
+    moveRequest.ptr = nullptr;
+    *ptr = this->request(moveRequest);
+    if (*ptr) {
+        memcpy(*ptr, request.ptr, (currentSize < request.size) ? currentSize : request.size);
+        this->request({.ptr = request.ptr});
+    }
+    return true;
+}
+
+ThreadArena * MemMan::threadArenaForPtr(void * ptr) const {
+    if (ptr == nullptr ||
+        _nThreadArenas.load(std::memory_order_relaxed) == 0 ||
+        containsPtr(ptr) == false ||
+        (_fsa && _fsa->containsPtr(ptr))) {
+        return nullptr;
+    }
+
+    // header is only a claim. make sure claimed arena is in our memory before
+    // reading from it.
+    ThreadArena * arena = ThreadArena::ArenaForPtr(ptr);
+    if (arena == nullptr ||
+        containsPtr(arena) == false ||
+        arena->isValidForPtr(ptr) == false) {
+        return nullptr;
+    }
+
+    return arena;
+}
+
+bool MemMan::refillThreadArena() {
+    guard_t guard{_mainMutex};
+    detachThreadArena();
+    attachThreadArena();
+    return (_threadArena != nullptr);
+}
+
+void MemMan::releaseThreadArena(ThreadArena * arena) {
+    guard_t guard{_mainMutex};
+    BlockInfo * block = blockForPtr(arena);
+    assert(block && block->_type == MEM_BLOCK_THREADARENA && "Invalid arena block.");
+    releaseBlock(block);
+    --_nThreadArenas;
+}
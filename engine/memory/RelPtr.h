@@ -0,0 +1,48 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Self-relative pointer.
+Stores the distance from its own address to its target instead of the target's
+address. A block that only links to itself through RelPtrs (Gobj) can be moved,
+memcpy'd, or written to disk and read back without any pointer fix-up.
+
+Converts to T * implicitly, so ->, [], arithmetic and comparisons work as they
+do on plain pointers, at the cost of one add (and a null check) per access.
+
+Copy construction and assignment point the new RelPtr at the same target, they
+do not copy the offset. Only memcpy of the whole containing block keeps offsets
+as they are.
+
+Offset 0 is null, so a RelPtr can't point at itself.
+Not trivially copyable: pass get() to varargs (printf, etc).
+*/
+
+template <typename T>
+class RelPtr {
+public:
+    RelPtr() = default;
+    RelPtr(T * ptr) { set(ptr); }
+    RelPtr(RelPtr const & other) { set(other.get()); }
+
+    RelPtr & operator=(T * ptr) { set(ptr); return *this; }
+    RelPtr & operator=(RelPtr const & other) { set(other.get()); return *this; }
+
+    T * get() const {
+        return (_offset) ? (T *)((intptr_t)this + _offset) : nullptr;
+    }
+    operator T * () const { return get(); }
+    T * operator->() const { return get(); }
+
+    // raw distance from this to target, for code that moves whole blocks
+    intptr_t offset() const { return _offset; }
+    void setOffset(intptr_t offset) { _offset = offset; }
+
+private:
+    intptr_t _offset = 0;
+
+    void set(T * ptr) {
+        _offset = (ptr) ? (intptr_t)ptr - (intptr_t)this : 0;
+    }
+};
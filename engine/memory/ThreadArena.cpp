@@ -0,0 +1,115 @@
+#include "ThreadArena.h"
+#include <assert.h>
+#include <string.h>
+
+ThreadArena::ThreadArena(size_t size) :
+    _size(size) {
+}
+
+size_t ThreadArena::size() const { return _size; }
+size_t ThreadArena::head() const { return _head; }
+size_t ThreadArena::bytesLeft() const { return _size - _head; }
+uint32_t ThreadArena::liveCount() const { return _refCount.load(std::memory_order_relaxed) - !_retired; }
+bool ThreadArena::isRetired() const { return _retired; }
+
+byte_t       * ThreadArena::data()       { return (byte_t *)this + alignSize(sizeof(ThreadArena), Align); }
+byte_t const * ThreadArena::data() const { return (byte_t *)this + alignSize(sizeof(ThreadArena), Align); }
+
+bool ThreadArena::containsPtr(void * ptr) const {
+    byte_t const * bptr = (byte_t const *)ptr;
+    return (bptr >= data() + sizeof(Header) && bptr < data() + _head);
+}
+
+size_t ThreadArena::sizeForPtr(void * ptr) const {
+    Header const * header = (Header const *)ptr - 1;
+    return SizeClassByteSize(header->sizeClass);
+}
+
+bool ThreadArena::isValidForPtr(void * ptr) const {
+    return (
+        _magic == HeaderMagic &&
+        containsPtr(ptr) &&
+        ((Header const *)ptr - 1)->sizeClass < NumSizeClasses
+    );
+}
+
+ThreadArena * ThreadArena::ArenaForPtr(void * ptr) {
+    Header const * header = (Header const *)ptr - 1;
+    if (header->magic != HeaderMagic) {
+        return nullptr;
+    }
+    return header->arena;
+}
+
+void * ThreadArena::alloc(size_t size) {
+    if (size > MaxBytes) {
+        return nullptr;
+    }
+    uint8_t sizeClass = SizeClassForByteSize(size);
+
+    // reuse freed slot of same size class
+    if (_freeList[sizeClass] == nullptr &&
+        _remoteFree.load(std::memory_order_relaxed)) {
+        drainRemoteFrees();
+    }
+    if (FreeSlot * slot = _freeList[sizeClass]) {
+        _freeList[sizeClass] = slot->next;
+        _refCount.fetch_add(1, std::memory_order_relaxed);
+        #if DEBUG
+        memset(slot, 0, SizeClassByteSize(sizeClass));
+        #endif // DEBUG
+        return slot;
+    }
+
+    // bump
+    size_t allocSize = sizeof(Header) + SizeClassByteSize(sizeClass);
+    if (_head + allocSize > _size) {
+        return nullptr;
+    }
+    Header * header = (Header *)(data() + _head);
+    header->arena = this;
+    header->sizeClass = sizeClass;
+    header->magic = HeaderMagic;
+    _head += allocSize;
+    _refCount.fetch_add(1, std::memory_order_relaxed);
+    return header + 1;
+}
+
+bool ThreadArena::destroy(void * ptr, bool isOwner) {
+    #if DEBUG
+    assert(isValidForPtr(ptr) && "Pointer not in arena.");
+    #endif // DEBUG
+
+    FreeSlot * slot = (FreeSlot *)ptr;
+    if (isOwner) {
+        uint8_t sizeClass = ((Header *)ptr - 1)->sizeClass;
+        slot->next = _freeList[sizeClass];
+        _freeList[sizeClass] = slot;
+    }
+    else {
+        slot->next = _remoteFree.load(std::memory_order_relaxed);
+        while (!_remoteFree.compare_exchange_weak(
+            slot->next, slot,
+            std::memory_order_release,
+            std::memory_order_relaxed)) {}
+    }
+
+    return (_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1);
+}
+
+bool ThreadArena::retire() {
+    assert(!_retired && "Arena already retired.");
+    _retired = true;
+    return (_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1);
+}
+
+void ThreadArena::drainRemoteFrees() {
+    FreeSlot * slot = _remoteFree.exchange(nullptr, std::memory_order_acquire);
+    while (slot) {
+        FreeSlot * next = slot->next;
+        uint8_t sizeClass = ((Header *)slot - 1)->sizeClass;
+        slot->next = _freeList[sizeClass];
+        _freeList[sizeClass] = slot;
+        slot = next;
+    }
+}
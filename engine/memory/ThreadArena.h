@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include "../common/debug_defines.h"
+#include "../common/types.h"
+#include "mem_utils.h"
+
+/*
+
+Per-thread sub-allocator.
+
+Designed to be used within pre-allocated memory, like inside a MemMan block.
+MemMan carves one of these out for each worker thread so small allocations on
+that thread don't need MemMan's main mutex.
+
+Only the owning thread allocates. Allocation pops a freed slot of the same
+size class, or bumps _head forward. Any thread may free. Frees from the owning
+thread go straight back to the size-class free list; frees from other threads
+are pushed onto an atomic list that the owner drains on its next alloc.
+
+Once detached from its thread (thread finished, or arena full) the arena is
+"retired". The owner holds one reference in _refCount, and every live
+allocation holds one more. Whoever drops the last reference must release the
+containing MemMan block.
+
+ThreadArena data structure (within a MemMan block):
+            data() start
+            v
+|__________||______|____________||______|________________||____...______|
+ThreadArena  Header Allocation    Header Allocation        (unused)
+(class              ^                    ^                 ^
+storage)            aligned to Align     aligned to Align  _head
+*/
+
+class ThreadArena {
+// TYPES AND STATICS
+public:
+    static constexpr size_t Align = 16;
+    static constexpr size_t NumSizeClasses = 9;
+    static constexpr size_t MinBytes = 16;
+    static constexpr size_t MaxBytes = MinBytes << (NumSizeClasses - 1); // 4096
+
+    static constexpr size_t DataSize(size_t size) {
+        return (size + Align - 1) & ~(Align - 1);
+    }
+
+    static constexpr size_t SizeClassByteSize(uint8_t sizeClass) {
+        return MinBytes << sizeClass;
+    }
+
+    static constexpr uint8_t SizeClassForByteSize(size_t byteSize) {
+        uint8_t sizeClass = 0;
+        while (SizeClassByteSize(sizeClass) < byteSize) ++sizeClass;
+        return sizeClass;
+    }
+
+// INIT
+private:
+    friend class MemMan;
+    ThreadArena(size_t size);
+
+// PUBLIC INTERFACE
+public:
+    size_t size() const;
+    size_t head() const;
+    size_t bytesLeft() const;
+    uint32_t liveCount() const;
+    bool isRetired() const;
+    byte_t const * data() const;
+    bool containsPtr(void * ptr) const;
+    size_t sizeForPtr(void * ptr) const;
+    // arena storage intact and ptr within an allocation of this arena
+    bool isValidForPtr(void * ptr) const;
+
+    // arena claimed by ptr's allocation header, or nullptr. the returned arena
+    // is unverified; check it is readable memory before calling
+    // isValidForPtr(). ptr must be preceded by sizeof(Header) readable bytes.
+    static ThreadArena * ArenaForPtr(void * ptr);
+
+// INTERNALS
+private:
+    class Header {
+    public:
+        ThreadArena * arena;
+        uint32_t sizeClass;
+        uint32_t magic;
+    };
+    static_assert(sizeof(Header) == Align, "Header must preserve alignment.");
+    static constexpr uint32_t HeaderMagic = 0x41726e61; // "Arna"
+
+    // intrusive link stored in a freed allocation's data
+    class FreeSlot {
+    public:
+        FreeSlot * next;
+    };
+
+    byte_t * data();
+    // owning thread only. returns nullptr if full or size too big.
+    void * alloc(size_t size);
+    // any thread. returns true if the last reference was dropped, in which
+    // case caller must release the containing block.
+    bool destroy(void * ptr, bool isOwner);
+    // owning thread only. drops owner reference, same return as destroy.
+    bool retire();
+    // move frees made by other threads into size-class free lists
+    void drainRemoteFrees();
+
+// STORAGE
+private:
+    size_t _size = 0;
+    size_t _head = 0;
+    uint32_t _magic = HeaderMagic;
+    bool _retired = false;
+    // owner only
+    FreeSlot * _freeList[NumSizeClasses] = {nullptr};
+    // any thread
+    std::atomic<FreeSlot *> _remoteFree{nullptr};
+    std::atomic<uint32_t> _refCount{1};
+
+// DEV INTERFACE
+private:
+    #if DEV_INTERFACE
+    void editorEditBlock();
+    #endif // DEV_INTERFACE
+};
@@ -0,0 +1,19 @@
+#include "ThreadArena.h"
+#include "../common/imgui_bgfx_glfw/imgui_bgfx_glfw.h"
+#include "../MrManager.h"
+
+#if DEV_INTERFACE
+
+using namespace ImGui;
+
+void ThreadArena::editorEditBlock() {
+    Text("ThreadArena%s, used: %s of %s, live allocations: %u",
+        isRetired() ? " (retired)" : "",
+        mm.frameByteSizeStr(head()),
+        mm.frameByteSizeStr(size()),
+        liveCount()
+    );
+    ProgressBar((float)head() / (float)size());
+}
+
+#endif // DEV_INTERFACE
@@ -10,10 +10,12 @@ inline char const * memBlockTypeStr(MemBlockType type) {
     case MEM_BLOCK_ARRAY:      return "ARRAY";
     case MEM_BLOCK_CHARKEYS:   return "CHARKEYS";
     case MEM_BLOCK_FILE:       return "FILE";
+    case MEM_BLOCK_FRAMERING:  return "FRAMERING";
     case MEM_BLOCK_FRAMESTACK: return "FRAMESTACK";
     case MEM_BLOCK_FREELIST:   return "FREELIST";
     case MEM_BLOCK_GOBJ:       return "GOBJ";
     case MEM_BLOCK_POOL:       return "POOL";
+    case MEM_BLOCK_THREADARENA:return "THREADARENA";
     case MEM_BLOCK_BGFX:       return "BGFX";
     case MEM_BLOCK_GENERIC:    return "GENERIC";
     case MEM_BLOCK_FILTER_ALL: return "ALL";
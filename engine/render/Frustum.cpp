@@ -0,0 +1,191 @@
+#include "Frustum.h"
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FRUSTUM_X86 1
+#else
+#define FRUSTUM_X86 0
+#endif
+
+/*
+Gribb & Hartmann, "Fast Extraction of Viewing Frustum Planes from the
+World-View-Projection Matrix" (2001). A clip space point is inside when
+-w <= x, y, z <= w, and each of those six is a plane in world space: the
+matrix's last row plus or minus one of the others. glm is column major, so
+row i is m[0][i], m[1][i], m[2][i], m[3][i].
+*/
+void Frustum::setFromViewProj(glm::mat4 const & m) {
+    glm::vec4 const row0{m[0][0], m[1][0], m[2][0], m[3][0]};
+    glm::vec4 const row1{m[0][1], m[1][1], m[2][1], m[3][1]};
+    glm::vec4 const row2{m[0][2], m[1][2], m[2][2], m[3][2]};
+    glm::vec4 const row3{m[0][3], m[1][3], m[2][3], m[3][3]};
+    planes[0] = row3 + row0; // left
+    planes[1] = row3 - row0; // right
+    planes[2] = row3 + row1; // bottom
+    planes[3] = row3 - row1; // top
+    planes[4] = row3 + row2; // near
+    planes[5] = row3 - row2; // far
+}
+
+// -------------------------------------------------------------------------- //
+// CULL
+// -------------------------------------------------------------------------- //
+
+/*
+For a box with center c and half extents e, the corner furthest along plane
+normal n is c + sign(n) * e. Its distance is n.c + d + |n|.e, and if even that
+is negative, the whole box is behind the plane.
+*/
+
+static uint32_t cullScalar(glm::vec4 const * planes, float const * lanes, size_t stride, uint32_t n, uint8_t * visible) {
+    float const * cx = lanes;
+    float const * cy = cx + stride;
+    float const * cz = cy + stride;
+    float const * ex = cz + stride;
+    float const * ey = ex + stride;
+    float const * ez = ey + stride;
+    uint32_t nVisible = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        bool inside = true;
+        for (int p = 0; p < Frustum::NPlanes && inside; ++p) {
+            glm::vec4 const & pl = planes[p];
+            float dist =
+                pl.x * cx[i] + pl.y * cy[i] + pl.z * cz[i] + pl.w +
+                fabsf(pl.x) * ex[i] + fabsf(pl.y) * ey[i] + fabsf(pl.z) * ez[i];
+            inside = (dist >= 0.f);
+        }
+        visible[i] = inside;
+        nVisible += inside;
+    }
+    return nVisible;
+}
+
+#if FRUSTUM_X86
+
+// SSE is baseline on x86_64, but not on i386
+__attribute__((target("sse")))
+static uint32_t cullSSE(glm::vec4 const * planes, float const * lanes, size_t stride, uint32_t n, uint8_t * visible) {
+    float const * cx = lanes;
+    float const * cy = cx + stride;
+    float const * cz = cy + stride;
+    float const * ex = cz + stride;
+    float const * ey = ex + stride;
+    float const * ez = ey + stride;
+    __m128 const signBit = _mm_set1_ps(-0.f);
+    __m128 const zero = _mm_setzero_ps();
+    uint32_t nVisible = 0;
+    for (uint32_t i = 0; i < n; i += 4) {
+        __m128 const x = _mm_loadu_ps(cx + i);
+        __m128 const y = _mm_loadu_ps(cy + i);
+        __m128 const z = _mm_loadu_ps(cz + i);
+        __m128 const hx = _mm_loadu_ps(ex + i);
+        __m128 const hy = _mm_loadu_ps(ey + i);
+        __m128 const hz = _mm_loadu_ps(ez + i);
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (int p = 0; p < Frustum::NPlanes; ++p) {
+            __m128 const a = _mm_set1_ps(planes[p].x);
+            __m128 const b = _mm_set1_ps(planes[p].y);
+            __m128 const c = _mm_set1_ps(planes[p].z);
+            __m128 dist = _mm_add_ps(_mm_mul_ps(a, x), _mm_set1_ps(planes[p].w));
+            dist = _mm_add_ps(dist, _mm_mul_ps(b, y));
+            dist = _mm_add_ps(dist, _mm_mul_ps(c, z));
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_andnot_ps(signBit, a), hx));
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_andnot_ps(signBit, b), hy));
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_andnot_ps(signBit, c), hz));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, zero));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (int k = 0; k < 4; ++k) {
+            visible[i + k] = (mask >> k) & 1;
+        }
+        if (i + 4 > n) mask &= (1 << (n - i)) - 1;
+        nVisible += __builtin_popcount(mask);
+    }
+    return nVisible;
+}
+
+__attribute__((target("avx")))
+static uint32_t cullAVX(glm::vec4 const * planes, float const * lanes, size_t stride, uint32_t n, uint8_t * visible) {
+    float const * cx = lanes;
+    float const * cy = cx + stride;
+    float const * cz = cy + stride;
+    float const * ex = cz + stride;
+    float const * ey = ex + stride;
+    float const * ez = ey + stride;
+    __m256 const signBit = _mm256_set1_ps(-0.f);
+    __m256 const zero = _mm256_setzero_ps();
+    uint32_t nVisible = 0;
+    for (uint32_t i = 0; i < n; i += 8) {
+        __m256 const x = _mm256_loadu_ps(cx + i);
+        __m256 const y = _mm256_loadu_ps(cy + i);
+        __m256 const z = _mm256_loadu_ps(cz + i);
+        __m256 const hx = _mm256_loadu_ps(ex + i);
+        __m256 const hy = _mm256_loadu_ps(ey + i);
+        __m256 const hz = _mm256_loadu_ps(ez + i);
+        __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+        for (int p = 0; p < Frustum::NPlanes; ++p) {
+            __m256 const a = _mm256_set1_ps(planes[p].x);
+            __m256 const b = _mm256_set1_ps(planes[p].y);
+            __m256 const c = _mm256_set1_ps(planes[p].z);
+            __m256 dist = _mm256_add_ps(_mm256_mul_ps(a, x), _mm256_set1_ps(planes[p].w));
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(b, y));
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(c, z));
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_andnot_ps(signBit, a), hx));
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_andnot_ps(signBit, b), hy));
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_andnot_ps(signBit, c), hz));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, zero, _CMP_GE_OQ));
+        }
+        int mask = _mm256_movemask_ps(inside);
+        for (int k = 0; k < 8; ++k) {
+            visible[i + k] = (mask >> k) & 1;
+        }
+        if (i + 8 > n) mask &= (1 << (n - i)) - 1;
+        nVisible += __builtin_popcount(mask);
+    }
+    return nVisible;
+}
+
+#endif // FRUSTUM_X86
+
+uint32_t Frustum::cull(float const * lanes, size_t stride, uint32_t n, uint8_t * visible) const {
+    static Impl const impl = bestImpl();
+    return cull(impl, lanes, stride, n, visible);
+}
+
+uint32_t Frustum::cull(Impl impl, float const * lanes, size_t stride, uint32_t n, uint8_t * visible) const {
+    #if FRUSTUM_X86
+    switch (impl) {
+    case IMPL_AVX: { return cullAVX(planes, lanes, stride, n, visible); }
+    case IMPL_SSE: { return cullSSE(planes, lanes, stride, n, visible); }
+    default: {}
+    }
+    #endif // FRUSTUM_X86
+    return cullScalar(planes, lanes, stride, n, visible);
+}
+
+bool Frustum::supports(Impl impl) {
+    switch (impl) {
+    case IMPL_SCALAR: return true;
+    #if FRUSTUM_X86
+    case IMPL_SSE:    return __builtin_cpu_supports("sse");
+    case IMPL_AVX:    return __builtin_cpu_supports("avx");
+    #endif // FRUSTUM_X86
+    default:          return false;
+    }
+}
+
+Frustum::Impl Frustum::bestImpl() {
+    if (supports(IMPL_AVX)) return IMPL_AVX;
+    if (supports(IMPL_SSE)) return IMPL_SSE;
+    return IMPL_SCALAR;
+}
+
+char const * Frustum::implStr(Impl impl) {
+    switch (impl) {
+    case IMPL_SCALAR: return "scalar";
+    case IMPL_SSE:    return "SSE";
+    case IMPL_AVX:    return "AVX";
+    default:          return "unknown";
+    }
+}
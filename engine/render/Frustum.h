@@ -0,0 +1,49 @@
+#pragma once
+#include <stddef.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include "../common/types.h"
+
+/*
+
+View frustum as six planes, for culling axis-aligned boxes.
+
+Boxes come in structure-of-arrays lanes (center x, y, z, then half extents x,
+y, z), the way Gobj keeps node bounds, so they can be tested 4 at a time with
+SSE or 8 at a time with AVX, whichever the CPU has (checked once at runtime).
+Other CPUs test one at a time.
+
+A box is outside if it is entirely behind any one plane. Boxes crossing a
+corner of the frustum can pass without being visible, which only costs a
+draw.
+
+*/
+
+class Frustum {
+public:
+    enum Impl {
+        IMPL_SCALAR,
+        IMPL_SSE,
+        IMPL_AVX,
+    };
+    static constexpr int NPlanes = 6;
+    // cull() works in batches of this many boxes
+    static constexpr size_t Batch = 8;
+
+    // (a, b, c, d), inside where a*x + b*y + c*z + d >= 0. not normalized.
+    glm::vec4 planes[NPlanes];
+
+    // planes from a projection * view matrix. near plane assumes -1..1 depth,
+    // which is also conservative for 0..1.
+    void setFromViewProj(glm::mat4 const & viewProj);
+
+    // test n boxes, in lanes of stride floats each, setting visible[i] to 1
+    // or 0. n is rounded up to Batch, so lanes and visible must have room
+    // for that many. returns number visible, of the first n.
+    uint32_t cull(float const * lanes, size_t stride, uint32_t n, uint8_t * visible) const;
+    uint32_t cull(Impl impl, float const * lanes, size_t stride, uint32_t n, uint8_t * visible) const;
+
+    static bool supports(Impl impl);
+    static Impl bestImpl();
+    static char const * implStr(Impl impl);
+};
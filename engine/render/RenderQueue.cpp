@@ -0,0 +1,118 @@
+#include "RenderQueue.h"
+#include <string.h>
+#include "../MrManager.h"
+
+static constexpr uint32_t InitialCapacity = 1024;
+
+uint64_t RenderQueue::makeKey(uint8_t view, bool translucent, uint8_t program, uint32_t material, float depth) {
+    uint32_t depthBits = 0;
+    if (depth > 0.f) {
+        memcpy(&depthBits, &depth, sizeof(float));
+        depthBits >>= (32 - DepthBits - 1); // sign bit is 0
+    }
+    uint64_t const mat = material & ((1u << MaterialBits) - 1);
+    uint64_t const prog = program & ((1u << ProgramBits) - 1);
+    uint64_t key = (uint64_t)view << 56;
+    if (translucent) {
+        uint64_t const farFirst = ~depthBits & ((1u << DepthBits) - 1);
+        key |= (uint64_t)1 << 55;
+        key |= farFirst << (ProgramBits + MaterialBits);
+        key |= prog << MaterialBits;
+        key |= mat;
+    }
+    else {
+        key |= prog << (MaterialBits + DepthBits);
+        key |= mat << DepthBits;
+        key |= depthBits;
+    }
+    return key;
+}
+
+uint64_t RenderQueue::stateBits(uint64_t key) {
+    bool const translucent = (key >> 55) & 1;
+    uint64_t const progMat = (translucent) ?
+        key & (((uint64_t)1 << (ProgramBits + MaterialBits)) - 1) :
+        (key >> DepthBits) & (((uint64_t)1 << (ProgramBits + MaterialBits)) - 1);
+    return (key >> 55 << (ProgramBits + MaterialBits)) | progMat;
+}
+
+bool RenderQueue::push(uint64_t key, uint32_t value) {
+    if (_size == _capacity && !grow()) {
+        return false;
+    }
+    _items[_size++] = {key, value, 0};
+    return true;
+}
+
+bool RenderQueue::grow() {
+    uint32_t capacity = (_capacity) ? _capacity * 2 : InitialCapacity;
+    Item * items = (Item *)mm.memMan.request({.size = sizeof(Item) * capacity, .align = alignof(Item)});
+    Item * scratch = (Item *)mm.memMan.request({.size = sizeof(Item) * capacity, .align = alignof(Item)});
+    if (items == nullptr || scratch == nullptr) {
+        fprintf(stderr, "Not enough memory for render queue of %u.\n", capacity);
+        if (items) mm.memMan.request({.ptr = items});
+        if (scratch) mm.memMan.request({.ptr = scratch});
+        return false;
+    }
+    if (_items) {
+        memcpy(items, _items, sizeof(Item) * _size);
+        mm.memMan.request({.ptr = _items});
+        mm.memMan.request({.ptr = _scratch});
+    }
+    _items = items;
+    _scratch = scratch;
+    _capacity = capacity;
+    return true;
+}
+
+/*
+LSD radix sort, a byte per pass. All eight histograms are counted in one read
+of the keys, and a pass is skipped when every key has the same byte there,
+which with few views, programs and materials is most of the high bytes.
+*/
+void RenderQueue::sort() {
+    _lastPasses = 0;
+    if (_size < 2) {
+        return;
+    }
+
+    uint32_t counts[8][256];
+    memset(counts, 0, sizeof(counts));
+    for (uint32_t i = 0; i < _size; ++i) {
+        uint64_t key = _items[i].key;
+        for (int b = 0; b < 8; ++b) {
+            ++counts[b][(key >> (b * 8)) & 0xff];
+        }
+    }
+
+    for (int b = 0; b < 8; ++b) {
+        uint32_t * count = counts[b];
+        if (count[(_items[0].key >> (b * 8)) & 0xff] == _size) {
+            continue;
+        }
+        // counts to starting offsets
+        uint32_t offset = 0;
+        for (int d = 0; d < 256; ++d) {
+            uint32_t c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        for (uint32_t i = 0; i < _size; ++i) {
+            Item const & item = _items[i];
+            _scratch[count[(item.key >> (b * 8)) & 0xff]++] = item;
+        }
+        Item * sorted = _scratch;
+        _scratch = _items;
+        _items = sorted;
+        ++_lastPasses;
+    }
+}
+
+void RenderQueue::shutdown() {
+    if (_items) mm.memMan.request({.ptr = _items});
+    if (_scratch) mm.memMan.request({.ptr = _scratch});
+    _items = nullptr;
+    _scratch = nullptr;
+    _size = 0;
+    _capacity = 0;
+}
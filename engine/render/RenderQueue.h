@@ -0,0 +1,62 @@
+#pragma once
+#include "../common/debug_defines.h"
+#include "../common/types.h"
+
+/*
+
+Per-frame list of draws, each with a 64-bit sort key, radix sorted before
+anything is submitted. Keys group draws that share state, so the renderer can
+skip setting what didn't change, and put blended draws last, back to front.
+
+Key bits, most significant first:
+    view            8
+    translucent     1
+    opaque:         program 3, material 24, depth 28 (near to far)
+    translucent:    depth 28 (far to near), program 3, material 24
+
+Depth is view space distance, as the top bits of its float (which sort like
+integers when positive). Anything behind the camera counts as 0.
+
+Each key carries a 32-bit value for the caller to find its draw with.
+
+*/
+
+class RenderQueue {
+public:
+    struct Item {
+        uint64_t key;
+        uint32_t value;
+        uint32_t _pad;
+    };
+    static constexpr uint32_t MaterialBits = 24;
+    static constexpr uint32_t ProgramBits = 3;
+    static constexpr uint32_t DepthBits = 28;
+
+    static uint64_t makeKey(uint8_t view, bool translucent, uint8_t program, uint32_t material, float depth);
+    // the parts of a key that decide state other than the transform
+    static uint64_t stateBits(uint64_t key);
+
+    void reset() { _size = 0; }
+    // false if out of memory
+    bool push(uint64_t key, uint32_t value);
+    // stable, ascending by key
+    void sort();
+    Item const * items() const { return _items; }
+    uint32_t size() const { return _size; }
+
+    void shutdown();
+
+    #if DEV_INTERFACE
+    // passes the last sort needed, of 8
+    uint8_t lastPasses() const { return _lastPasses; }
+    #endif // DEV_INTERFACE
+
+private:
+    Item * _items = nullptr;
+    Item * _scratch = nullptr;
+    uint32_t _size = 0;
+    uint32_t _capacity = 0;
+    uint8_t _lastPasses = 0;
+
+    bool grow();
+};
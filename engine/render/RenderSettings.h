@@ -19,6 +19,7 @@ public:
         bool drawSceneAABB = true;
         std::function<void(bool)> didChangeDrawSceneAABB = nullptr;
         float aabbColor[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+        bool frustumCull = true;
 
         bool operator == (User const & other) {
             return (
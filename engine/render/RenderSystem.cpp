@@ -1,9 +1,11 @@
 #include "RenderSystem.h"
+#include <algorithm>
+#include <string.h>
 #include <bgfx/platform.h>
 #include <bimg/decode.h>
 #include <bx/error.h>
 #include "../MrManager.h"
-#include "../common/modp_b64.h"
+#include "../common/base64.h"
 #include "../common/string_utils.h"
 #include "../render/bgfx_extra.h"
 #include "../memory/CharKeys.h"
@@ -24,6 +26,21 @@
 static bool constexpr ShowRenderDbg = true;
 static bool constexpr ShowRenderDbgTick = ShowRenderDbg && false;
 
+// default images for addMinReqMat. copied into the gobj's strings, as
+// everything a gobj links to has to live inside it.
+static char const white2x2x3PNG[] =
+    "data:image/png;base64,"
+    // 2x2 PNG, filled with 0xffffff (r,g,b) for every 3-byte pixel:
+    "iVBORw0KGgoAAAANSUhEUgAAAAIAAAACCAIAAAD91JpzAAAAE0lEQVR4XmP8//8/AwMDEwMYAA"
+    "AkBgMBTJCz6gAAAABJRU5ErkJggg==";
+
+static char const metalRoughPNG[] =
+    "data:image/png;base64,"
+    //          (g) roughness---v v---metalic (b)
+    // 2x2 PNG, filled with 0xffffffff (r,g,b,a) for every 4-byte pixel:
+    "iVBORw0KGgoAAAANSUhEUgAAAAIAAAACCAYAAABytg0kAAAAEUlEQVR4XmP8DwQMQMDEAAUAPf"
+    "gEAHCr5OoAAAAASUVORK5CYII=";
+
 void RenderSystem::init() {
     // ensure single thread rendering
     bgfx::renderFrame();
@@ -63,6 +80,13 @@ void RenderSystem::draw() {
     bgfx::setUniform(colors.background.handle, (float *)&colors.background.data);
 
     size_t submitCount = 0;
+    stats = {};
+    queue.reset();
+    // draw order is the render queue's
+    bgfx::setViewMode(mm.mainView, bgfx::ViewMode::Sequential);
+
+    Frustum frustum;
+    frustum.setFromViewProj(mm.camera->projMat * mm.camera->viewMat);
 
     // for each renderable
     for (auto node : renderList) {
@@ -81,20 +105,26 @@ void RenderSystem::draw() {
             node->key, gobj
         );
 
-        // if scene present, draw through node structure
-        if (gobj->scene) {
-            // each root node
-            for (uint16_t nodeIndex = 0; nodeIndex < gobj->scene->nNodes; ++nodeIndex) {
-                submitCount += drawNode(gobj, gobj->scene->nodes[nodeIndex]);
-            }
+        PacketList * list = packetListFor(gobj);
+        if (list == nullptr) {
+            continue;
         }
-        // otherwise draw all meshes
-        else {
-            // each mesh
-            for (uint16_t meshIndex = 0; meshIndex < gobj->counts.meshes; ++meshIndex) {
-                submitCount += drawMesh(gobj, gobj->meshes[meshIndex]);
-            }
+
+        gobj->updateWorldMatrices();
+        if (!list->built ||
+            list->scene != gobj->scene ||
+            list->flattenCount != gobj->flattenCount
+        ) {
+            buildPackets(*list);
+        }
+        // every node's box at once, queuePackets skips the ones outside
+        if (settings.user.frustumCull) {
+            frustum.cull(gobj->nodeBounds, gobj->nodeLaneStride(), gobj->nFlatNodes, gobj->nodeVisible);
         }
+        else if (gobj->nFlatNodes) {
+            memset(gobj->nodeVisible, 1, gobj->nFlatNodes);
+        }
+        queuePackets(*list);
 
         if (settings.user.drawSceneAABB) {
             if (!Gobj::isValid(gobj->bounds.renderHandleIndex)) {
@@ -140,7 +170,11 @@ void RenderSystem::draw() {
         }
     }
 
+    queue.sort();
+    submitCount += drawQueue();
+
     // printl("submit count for frame %zu: %d", mm.frame, submitCount);
+    stats.submitted = (uint32_t)submitCount;
     if (!submitCount) {
         bgfx::touch(mm.mainView);
     }
@@ -150,119 +184,98 @@ void RenderSystem::draw() {
     printc(ShowRenderDbgTick, "-------------------------------------------------------------ENDING RENDER FRAME\n");
 }
 
-uint16_t RenderSystem::drawNode(Gobj * gobj, Gobj::Node * node, glm::mat4 const & parentTransform) {
-    uint16_t submitCount = 0;
-    // calc global transform
-    glm::mat4 global = parentTransform * node->matrix;
-    // draw self if present
-    if (node->mesh) {
-        submitCount += drawMesh(gobj, *node->mesh, global);
-    }
-    // draw children
-    for (uint16_t nodeIndex = 0; nodeIndex < node->nChildren; ++nodeIndex) {
-        submitCount += drawNode(gobj, node->children[nodeIndex], global);
+void RenderSystem::queuePackets(PacketList const & list) {
+    Gobj const * gobj = list.gobj;
+    uint32_t const listIndex = (uint32_t)(&list - packetLists);
+    uint8_t const * visible = gobj->nodeVisible;
+    size_t const stride = gobj->nodeLaneStride();
+    float const * cx = gobj->nodeBounds;
+    float const * cy = cx + stride;
+    float const * cz = cy + stride;
+    glm::mat4 const & view = mm.camera->viewMat;
+
+    for (uint32_t i = 0; i < list.nPackets; ++i) {
+        DrawPacket const & p = list.packets[i];
+        float depth = 0.f;
+        if (p.slot != DrawPacket::NoSlot) {
+            if (!visible[p.slot]) {
+                ++stats.culled;
+                continue;
+            }
+            // distance along the camera's forward, -z in view space
+            depth = -(view[0][2] * cx[p.slot] + view[1][2] * cy[p.slot] + view[2][2] * cz[p.slot] + view[3][2]);
+        }
+        uint64_t key = RenderQueue::makeKey(
+            (uint8_t)mm.mainView,
+            (p.state & BGFX_STATE_BLEND_MASK) != 0,
+            PROGRAM_STANDARD,
+            (listIndex << 16) | p.material,
+            depth
+        );
+        if (!queue.push(key, (listIndex << QueuePacketBits) | i)) {
+            return;
+        }
     }
-    return submitCount;
 }
 
-uint16_t RenderSystem::drawMesh(Gobj * gobj, Gobj::Mesh const & mesh, glm::mat4 const & transform) {
-    uint16_t submitCount = 0;
-
-    printc(ShowRenderDbgTick,
-        "----------\n"
-        "mesh %p (%s), %u primitives\n"
-        "----------\n",
-        &mesh, mesh.name, mesh.nPrimitives
-    );
-
-    // each primitive
-    for (int primIndex = 0; primIndex < mesh.nPrimitives; ++primIndex) {
-        Gobj::MeshPrimitive * prim = mesh.primitives + primIndex;
-        Gobj::Material * mat = prim->material;
-
-        printc(ShowRenderDbgTick,
-            "-----\n"
-            "mesh primitive %p\n"
-            "-----\n",
-            prim
-        );
-
-        // set buffers
-        for (int attrIndex = 0; attrIndex < prim->nAttributes; ++attrIndex) {
-            Gobj::Accessor * acc = prim->attributes[attrIndex].accessor;
-            bgfx::setVertexBuffer(attrIndex, bgfx::VertexBufferHandle{acc->renderHandle});
+/*
+bgfx keeps uniform values between draws, so a material's uniforms are only set
+by the first draw that uses it. Texture bindings are dropped after each submit
+unless told otherwise, so they are kept when the next draw has the same
+material.
+*/
+uint32_t RenderSystem::drawQueue() {
+    RenderQueue::Item const * items = queue.items();
+    uint32_t const n = queue.size();
+    uint32_t constexpr packetMask = (1u << QueuePacketBits) - 1;
+    uint64_t prevState = UINT64_MAX;
+
+    for (uint32_t i = 0; i < n; ++i) {
+        PacketList const & list = packetLists[items[i].value >> QueuePacketBits];
+        DrawPacket const & p = list.packets[items[i].value & packetMask];
+        Gobj const * gobj = list.gobj;
+        bool const hasSlot = (p.slot != DrawPacket::NoSlot);
+
+        // set textures and material, if not carried over
+        uint64_t const state = RenderQueue::stateBits(items[i].key);
+        if (state != prevState) {
+            bgfx::setTexture(TEXTURE_SLOT_COLOR, samplerColor, p.color);
+            bgfx::setTexture(TEXTURE_SLOT_NORM,  samplerNorm,  p.normal);
+            bgfx::setTexture(TEXTURE_SLOT_METAL, samplerMetal, p.metallicRoughness);
+            bgfx::setUniform(materialBaseColor, &p.baseColor);
+            bgfx::setUniform(materialPBRValues, &p.pbrValues);
+            ++stats.materialChanges;
+            prevState = state;
         }
-        bgfx::setIndexBuffer(bgfx::IndexBufferHandle{prim->indices->renderHandle});
-
-        uint64_t state = settings.state;
-        uint32_t stateRGBA = 0;
-
-        state |= bgfxPrimitiveType(prim->mode);
-
-        // require material
-        assert(mat                           && "Set minimum material during setup if not in Gobj.");
-        assert(mat->baseColorTexture         && "Set minimum material baseColorTexture during setup if not in Gobj.");
-        assert(mat->normalTexture            && "Set minimum material normalTexture during setup if not in Gobj.");
-        assert(mat->metallicRoughnessTexture && "Set minimum material metallicRoughnessTexture during setup if not in Gobj.");
 
-        // set textures
-        bgfx::setTexture(
-            TEXTURE_SLOT_COLOR,
-            samplerColor,
-            bgfx::TextureHandle{mat->baseColorTexture->renderHandle}
-        );
-        bgfx::setTexture(
-            TEXTURE_SLOT_NORM,
-            samplerNorm,
-            bgfx::TextureHandle{mat->normalTexture->renderHandle}
-        );
-        bgfx::setTexture(
-            TEXTURE_SLOT_METAL,
-            samplerMetal,
-            bgfx::TextureHandle{mat->metallicRoughnessTexture->renderHandle}
-        );
-        bgfx::setUniform(materialBaseColor, mat->baseColorFactor);
-
-        if (mat->alphaMode == Gobj::Material::ALPHA_BLEND ||
-            mat->baseColorFactor[3] < 1.f) {
-            state |= BGFX_STATE_BLEND_ALPHA;
+        // set buffers
+        for (uint8_t stream = 0; stream < p.nVertexBuffers; ++stream) {
+            bgfx::setVertexBuffer(stream, p.vertexBuffers[stream]);
         }
+        bgfx::setIndexBuffer(p.indexBuffer);
 
-        // glm::vec4 pbrValues{
-        //     0.5f, // roughness. 0 smooth, 1 rough
-        //     0.0f, // metallic. 0 plastic, 1 metal
-        //     0.2f, // specular, additional specular adjustment for non-matalic materials
-        //     1.0f  // color intensity
-        // };
-        glm::vec4 pbrValues{
-            mat->roughnessFactor,
-            mat->metallicFactor,
-            0.2f, // unused
-            1.0f, // unused
-        };
-        bgfx::setUniform(materialPBRValues, &pbrValues);
-
-        // set transform
-        bgfx::setTransform(&transform);
-
-        // make a reduced version of the rotation for the shader normals
-        auto nm = glm::transpose(glm::inverse(glm::mat3{transform}));
-        bgfx::setUniform(normModel, (float *)&nm);
+        // set transform, and reduced version of the rotation for the shader normals
+        bgfx::setTransform(hasSlot ? &gobj->nodeWorlds[p.slot] : &Identity);
+        bgfx::setUniform(normModel, (float const *)(hasSlot ? &gobj->nodeNormals[p.slot] : &IdentityNormal));
 
         // set modified state
-        bgfx::setState(state, stateRGBA);
+        bgfx::setState(settings.state | p.state, 0);
 
-        // submit
-        bgfx::submit(mm.mainView, standardProgram);
-        ++submitCount;
-    } // for each primitive
+        // submit, keeping textures for the next draw if it shares them
+        uint8_t discard = BGFX_DISCARD_ALL;
+        if (i + 1 < n && RenderQueue::stateBits(items[i + 1].key) == state) {
+            discard &= ~BGFX_DISCARD_BINDINGS;
+        }
+        bgfx::submit(mm.mainView, standardProgram, 0, discard);
+    }
 
-    return submitCount;
+    return n;
 }
 
 void RenderSystem::shutdown() {
     // destroy
     for (auto node : renderList) {
+        releasePackets((Gobj *)node->ptr);
         removeHandles((Gobj *)node->ptr);
     }
     // no need to ever dealloc memMan objects TODO: is this still true?
@@ -284,6 +297,8 @@ void RenderSystem::shutdown() {
     bgfx::destroy(materialBaseColor);
     bgfx::destroy(materialPBRValues);
     bgfx::destroy(normModel);
+
+    queue.shutdown();
 }
 
 Gobj * RenderSystem::add(char const * key, Gobj * gobj) {
@@ -305,6 +320,7 @@ void RenderSystem::remove(char const * key) {
         return;
     }
     gobj->setStatus(Gobj::STATUS_LOADED);
+    releasePackets(gobj);
     removeHandles(gobj);
     renderList->remove(key);
 }
@@ -316,6 +332,7 @@ Gobj * RenderSystem::update(char const * key, Gobj * newGobj) {
         fprintf(stderr, "WARNING: did not update Gobj at key:%s. Could not find key.", key);
         return nullptr;
     }
+    releasePackets(oldGobj);
     removeHandles(oldGobj);
     newGobj = addMinReqMat(newGobj);
     renderList->update(key, newGobj);
@@ -324,6 +341,12 @@ Gobj * RenderSystem::update(char const * key, Gobj * newGobj) {
     return oldGobj;
 }
 
+void RenderSystem::refresh(Gobj * gobj) {
+    if (PacketList * list = packetListFor(gobj)) {
+        list->built = false;
+    }
+}
+
 bool RenderSystem::canAdd() const {
     return (renderList->isFull() == false);
 }
@@ -360,6 +383,10 @@ size_t RenderSystem::renderableCount() const {
 }
 
 void RenderSystem::postAdd(Gobj * gobj) {
+    // claim gobj's packet list. filled once it's ready to draw.
+    PacketList * list = packetListFor(nullptr);
+    assert(list && "Packet lists should match render list size.");
+    *list = {.gobj = gobj};
     addHandles(gobj);
     mm.camera->zoomTo(gobj);
 }
@@ -379,24 +406,11 @@ Gobj * RenderSystem::addMinReqMat(Gobj * gobj) {
         gobj = mm.memMan.updateGobj(gobj, minReqCounts);
     }
 
-    static char const * white2x2x3PNG =
-    "data:image/png;base64,"
-    // 2x2 PNG, filled with 0xffffff (r,g,b) for every 3-byte pixel:
-    "iVBORw0KGgoAAAANSUhEUgAAAAIAAAACCAIAAAD91JpzAAAAE0lEQVR4XmP8//8/AwMDEwMYAA"
-    "AkBgMBTJCz6gAAAABJRU5ErkJggg==";
-
-    static char const * metalRoughPNG =
-    "data:image/png;base64,"
-    //          (g) roughness---v v---metalic (b)
-    // 2x2 PNG, filled with 0xffffffff (r,g,b,a) for every 4-byte pixel:
-    "iVBORw0KGgoAAAANSUhEUgAAAAIAAAACCAYAAABytg0kAAAAEUlEQVR4XmP8DwQMQMDEAAUAPf"
-    "gEAHCr5OoAAAAASUVORK5CYII=";
-
     Gobj::Image * normColorImg = gobj->images + gobj->counts.images;
-    normColorImg->uri = white2x2x3PNG;
+    normColorImg->uri = gobj->copyStr(white2x2x3PNG);
     ++gobj->counts.images;
     Gobj::Image * metalRoughImg = gobj->images + gobj->counts.images;
-    metalRoughImg->uri = metalRoughPNG;
+    metalRoughImg->uri = gobj->copyStr(metalRoughPNG);
     ++gobj->counts.images;
 
     Gobj::Texture * normColorTex = gobj->textures + gobj->counts.textures;
@@ -417,20 +431,20 @@ Gobj * RenderSystem::addMinReqMat(Gobj * gobj) {
         for (uint16_t p = 0; p < mesh->nPrimitives; ++p) {
             Gobj::MeshPrimitive * prim = mesh->primitives + p;
             if (prim->material == nullptr) {
-                printl("adding default material to mesh %u (%s) primative %u", m, mesh->name, p);
+                printl("adding default material to mesh %u (%s) primative %u", m, mesh->name.get(), p);
                 prim->material = newMat;
             }
             else {
                 if (prim->material->baseColorTexture == nullptr) {
-                    printl("adding default norm/color texture to baseColorTexture of mesh %u (%s) primative %u", m, mesh->name, p);
+                    printl("adding default norm/color texture to baseColorTexture of mesh %u (%s) primative %u", m, mesh->name.get(), p);
                     prim->material->baseColorTexture = normColorTex;
                 }
                 if (prim->material->normalTexture == nullptr) {
-                    printl("adding default norm/color texture to normalTexture of mesh %u (%s) primative %u", m, mesh->name, p);
+                    printl("adding default norm/color texture to normalTexture of mesh %u (%s) primative %u", m, mesh->name.get(), p);
                     prim->material->normalTexture = normColorTex;
                 }
                 if (prim->material->metallicRoughnessTexture == nullptr) {
-                    printl("adding default metal/rough texture to metallicRoughnessTexture of mesh %u (%s) primative %u", m, mesh->name, p);
+                    printl("adding default metal/rough texture to metallicRoughnessTexture of mesh %u (%s) primative %u", m, mesh->name.get(), p);
                     prim->material->metallicRoughnessTexture = metalRoughTex;
                 }
             }
@@ -464,9 +478,10 @@ Gobj::Counts RenderSystem::countsForMinReqMat(Gobj * gobj) {
 
 Gobj::Counts RenderSystem::typicalCountsForMinReqMat() {
     return {
+        .allStrLen = sizeof(white2x2x3PNG) + sizeof(metalRoughPNG),
+        .images = 2,
         .materials = 1,
         .textures = 2,
-        .images = 2,
     };
 }
 
@@ -529,75 +544,136 @@ void RenderSystem::addHandles(Gobj * gobj) {
     }
 
     // setup textures
-    for (uint16_t texIndex = 0; texIndex < gobj->counts.textures; ++texIndex) {
-        Gobj::Texture * tex = gobj->textures + texIndex;
-        // skip if texture already created
-        if (Gobj::isValid(tex->renderHandle)) {
+    // one job per image, so textures sharing a source read and decode it once
+    JobCounter * textureGroup = mm.createWorkerGroup();
+    for (uint16_t imgIndex = 0; imgIndex < gobj->counts.images; ++imgIndex) {
+        Gobj::Image * img = gobj->images + imgIndex;
+        // skip if every texture using it is already created
+        bool needed = false;
+        for (uint16_t texIndex = 0; texIndex < gobj->counts.textures; ++texIndex) {
+            Gobj::Texture const & tex = gobj->textures[texIndex];
+            if (tex.source == img && !Gobj::isValid(tex.renderHandle)) {
+                needed = true;
+                break;
+            }
+        }
+        if (!needed) {
             continue;
         }
-        mm.createWorker([this, tex, gobj]{
-            bimg::ImageContainer * imgc = decodeImage(tex->source, gobj->loadedDirName);
+        // image files are all queued up front, so reads overlap decoding
+        IOHandle read;
+        File * file = readImageFile(img, gobj->loadedDirName, &read);
+        mm.createWorker([this, img, gobj, file, read]{
+            bool readOk = (file == nullptr || mm.io.wait(read));
+            bimg::ImageContainer * imgc = (readOk) ?
+                decodeImage(img, gobj->loadedDirName, file) :
+                nullptr;
+            if (file) {
+                mm.memMan.request({.ptr = file});
+            }
             if (imgc == nullptr) {
                 return;
             }
-            tex->renderHandle = bgfx::createTexture2D(
-                (uint16_t)imgc->m_width,
-                (uint16_t)imgc->m_height,
-                false,
-                1,
-                (bgfx::TextureFormat::Enum)imgc->m_format,
-                BGFX_TEXTURE_NONE|BGFX_SAMPLER_NONE,
-                bgfx::makeRef(imgc->m_data, imgc->m_size)
-            ).idx;
+            for (uint16_t texIndex = 0; texIndex < gobj->counts.textures; ++texIndex) {
+                Gobj::Texture * tex = gobj->textures + texIndex;
+                if (tex->source != img || Gobj::isValid(tex->renderHandle)) {
+                    continue;
+                }
+                tex->renderHandle = bgfx::createTexture2D(
+                    (uint16_t)imgc->m_width,
+                    (uint16_t)imgc->m_height,
+                    false,
+                    1,
+                    (bgfx::TextureFormat::Enum)imgc->m_format,
+                    BGFX_TEXTURE_NONE|BGFX_SAMPLER_NONE,
+                    bgfx::makeRef(imgc->m_data, imgc->m_size)
+                ).idx;
+            }
         },
-        gobj // group
+        textureGroup
         );
     }
 
-    // no workers in group! set status right away
-    if (mm.numberOfWorkersInGroup(gobj) == 0) {
+    // when all in group are done (or right away if none were added)
+    mm.setWorkerGroupOnComplete(textureGroup, [this, gobj]{
+        // removed or swapped out while textures were decoding
+        PacketList * list = packetListFor(gobj);
+        if (list == nullptr) {
+            return;
+        }
         gobj->setStatus(Gobj::STATUS_READY_TO_DRAW);
+        buildPackets(*list);
+    });
+}
+
+File * RenderSystem::readImageFile(Gobj::Image * img, char const * loadedDirName, IOHandle * read) {
+    // already in memory, or a data URI
+    if (img->data || img->bufferView || img->uri == nullptr) {
+        return nullptr;
     }
-    // when all in group are done
-    else {
-        mm.setWorkerGroupOnComplete(gobj, [gobj]{
-            gobj->setStatus(Gobj::STATUS_READY_TO_DRAW);
-        });
+    size_t b64Len = strlen(img->uri);
+    if (base64DataURI(img->uri, &b64Len)) {
+        return nullptr;
+    }
+
+    char const * fullPath = mm.frameFormatStr("%s%s", loadedDirName, img->uri.get());
+    if (fullPath == nullptr) {
+        return nullptr;
     }
+    File * f = mm.memMan.createFileHandle(fullPath, false, {.high=true});
+    if (f == nullptr) {
+        return nullptr;
+    }
+    *read = mm.io.load(f);
+    return f;
 }
 
-bimg::ImageContainer * RenderSystem::decodeImage(Gobj::Image * img, char const * loadedDirName) {
+bimg::ImageContainer * RenderSystem::decodeImage(Gobj::Image * img, char const * loadedDirName, File * file) {
     if (!img) return nullptr;
     if (img->decoded) return (bimg::ImageContainer *)img->decoded;
 
     byte_t * data = nullptr;
     uint32_t dataSize = 0;
+    // data URI already decoded at load
+    if (img->data) {
+        data = img->data;
+        dataSize = img->dataSize;
+    }
     // encoded image data is in gobj buffer
-    if (img->bufferView) {
+    else if (img->bufferView) {
         Gobj::BufferView & bv = *img->bufferView;
         data = bv.buffer->data + bv.byteOffset;
         dataSize = bv.byteLength;
     }
     // encoded image data is in external file
     else if (img->uri) {
-        // data encoded image
-        if (strlen(img->uri) >= 8 && strEqu(img->uri, "data:ima", 8)) {
-            static char const * isDataStr = "data:image/png;base64,";
-            static size_t isDataLen = strlen(isDataStr);
-            assert(strEqu(img->uri, isDataStr, isDataLen) && "Unexpected data string header.");
-
-            size_t b64StrLen = strlen(img->uri) - isDataLen;
-            dataSize = modp_b64_decode_len(b64StrLen);
+        // data encoded image (not from a loaded gobj)
+        size_t b64Len = strlen(img->uri);
+        char const * b64 = base64DataURI(img->uri, &b64Len);
+        if (b64) {
+            dataSize = (uint32_t)base64DecodedSize(b64, b64Len);
             data = (byte_t *)mm.memMan.request({.size=dataSize, .high=true, .lifetime=0});
-            modp_b64_decode((char *)data, (char *)img->uri + isDataLen, b64StrLen);
-
-            // fprintf(stderr, "data-encoded image URIs not supported.\n");
-            // return nullptr;
+            if (base64Decode(data, b64, b64Len) != dataSize) {
+                fprintf(stderr, "Error decoding image data URI.\n");
+                return nullptr;
+            }
+        }
+        // image file, read ahead
+        else if (file) {
+            data = file->data();
+            dataSize = file->size();
         }
         // image file
         else {
-            char const * fullPath = mm.frameFormatStr("%s%s", loadedDirName, img->uri);
+            char const * fullPath = mm.frameFormatStr("%s%s", loadedDirName, img->uri.get());
+            if (fullPath == nullptr) {
+                fprintf(stderr, "Error formatting image path.\n");
+                return nullptr;
+            }
             File * f = mm.memMan.createFileHandle(fullPath, true, {.high=true, .lifetime=0});
+            if (f == nullptr) {
+                return nullptr;
+            }
             data = f->data();
             dataSize = f->size();
         }
@@ -618,7 +694,7 @@ bimg::ImageContainer * RenderSystem::decodeImage(Gobj::Image * img, char const *
     );
     if (imgc && err.isOk()) {
         printl("loaded image %s, data at: %p, w: %u, h: %u, d: %u",
-            img->name, imgc->m_data, imgc->m_width, imgc->m_height, imgc->m_depth);
+            img->name.get(), imgc->m_data, imgc->m_width, imgc->m_height, imgc->m_depth);
     }
     else {
         fprintf(stderr, "error loading image: %s (%p, %u)\n", err.getMessage().getPtr(), data, dataSize);
@@ -659,3 +735,125 @@ void RenderSystem::removeHandles(Gobj * gobj) {
     }
 }
 
+// -------------------------------------------------------------------------- //
+// DRAW PACKETS
+// -------------------------------------------------------------------------- //
+
+RenderSystem::PacketList * RenderSystem::packetListFor(Gobj const * gobj) {
+    for (PacketList & list : packetLists) {
+        if (list.gobj == gobj) {
+            return &list;
+        }
+    }
+    return nullptr;
+}
+
+/*
+Packets come from the scene's nodes, or every mesh at identity if there's no
+scene, and are sorted by slot so drawing walks the transform arrays forward.
+*/
+void RenderSystem::buildPackets(PacketList & list) {
+    Gobj * gobj = list.gobj;
+    if (list.packets) {
+        mm.memMan.request({.ptr = list.packets});
+        list.packets = nullptr;
+    }
+    list.nPackets = 0;
+    list.built = true;
+    list.scene = gobj->scene;
+
+    // slots have to be settled before packets point at them
+    gobj->updateWorldMatrices();
+    list.flattenCount = gobj->flattenCount;
+
+    uint32_t nPackets = 0;
+    gobj->traverse({
+        .eachNode = [&nPackets](Gobj::Node * node, glm::mat4 const &) {
+            if (node->mesh) nPackets += node->mesh->nPrimitives;
+        },
+    });
+    if (gobj->scene == nullptr) {
+        for (uint16_t meshIndex = 0; meshIndex < gobj->counts.meshes; ++meshIndex) {
+            nPackets += gobj->meshes[meshIndex].nPrimitives;
+        }
+    }
+    if (nPackets == 0) {
+        return;
+    }
+    list.packets = (DrawPacket *)mm.memMan.request({.size = sizeof(DrawPacket) * nPackets, .align = alignof(DrawPacket)});
+    if (list.packets == nullptr) {
+        fprintf(stderr, "Not enough memory for %u draw packets.\n", nPackets);
+        return;
+    }
+
+    auto addMesh = [gobj, &list](Gobj::Mesh const & mesh, uint16_t slot) {
+        for (int primIndex = 0; primIndex < mesh.nPrimitives; ++primIndex) {
+            Gobj::MeshPrimitive const * prim = mesh.primitives + primIndex;
+            Gobj::Material const * mat = prim->material;
+
+            // require material
+            assert(mat                           && "Set minimum material during setup if not in Gobj.");
+            assert(mat->baseColorTexture         && "Set minimum material baseColorTexture during setup if not in Gobj.");
+            assert(mat->normalTexture            && "Set minimum material normalTexture during setup if not in Gobj.");
+            assert(mat->metallicRoughnessTexture && "Set minimum material metallicRoughnessTexture during setup if not in Gobj.");
+            assert(prim->nAttributes <= DrawPacket::MaxStreams && "More attributes than bgfx vertex streams.");
+
+            DrawPacket & p = list.packets[list.nPackets++];
+            p = {};
+            p.nVertexBuffers = (uint8_t)min(prim->nAttributes, DrawPacket::MaxStreams);
+            for (uint8_t stream = 0; stream < p.nVertexBuffers; ++stream) {
+                p.vertexBuffers[stream] = {prim->attributes[stream].accessor->renderHandle};
+            }
+            p.indexBuffer = {prim->indices->renderHandle};
+            p.color = {mat->baseColorTexture->renderHandle};
+            p.normal = {mat->normalTexture->renderHandle};
+            p.metallicRoughness = {mat->metallicRoughnessTexture->renderHandle};
+            p.baseColor = glm::vec4{
+                mat->baseColorFactor[0],
+                mat->baseColorFactor[1],
+                mat->baseColorFactor[2],
+                mat->baseColorFactor[3],
+            };
+            p.pbrValues = glm::vec4{
+                mat->roughnessFactor,
+                mat->metallicFactor,
+                0.2f, // unused
+                1.0f, // unused
+            };
+            p.state = bgfxPrimitiveType(prim->mode);
+            if (mat->alphaMode == Gobj::Material::ALPHA_BLEND ||
+                mat->baseColorFactor[3] < 1.f) {
+                p.state |= BGFX_STATE_BLEND_ALPHA;
+            }
+            p.slot = slot;
+            p.material = (uint16_t)(mat - gobj->materials);
+        }
+    };
+
+    if (gobj->scene) {
+        gobj->traverse({
+            .eachNode = [gobj, &addMesh](Gobj::Node * node, glm::mat4 const &) {
+                if (node->mesh) addMesh(*node->mesh, gobj->nodeSlot(node));
+            },
+        });
+        std::stable_sort(list.packets, list.packets + list.nPackets,
+            [](DrawPacket const & a, DrawPacket const & b) { return a.slot < b.slot; }
+        );
+    }
+    else {
+        for (uint16_t meshIndex = 0; meshIndex < gobj->counts.meshes; ++meshIndex) {
+            addMesh(gobj->meshes[meshIndex], DrawPacket::NoSlot);
+        }
+    }
+}
+
+void RenderSystem::releasePackets(Gobj const * gobj) {
+    PacketList * list = packetListFor(gobj);
+    if (list == nullptr) {
+        return;
+    }
+    if (list->packets) {
+        mm.memMan.request({.ptr = list->packets});
+    }
+    *list = {};
+}
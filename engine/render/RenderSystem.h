@@ -2,15 +2,64 @@
 #include <bimg/bimg.h>
 #include "Colors.h"
 #include "Fog.h"
+#include "Frustum.h"
 #include "Lights.h"
+#include "RenderQueue.h"
 #include "RenderSettings.h"
 #include "../common/debug_defines.h"
 #include "../memory/MemMan.h"
 #include "../memory/Gobj.h"
+#include "../worker/FileIO.h"
+
+/*
+
+Renderables are compiled into draw packets, one per mesh primitive reached
+from the Gobj's scene: everything bgfx needs for the draw except the
+transform, which is read from the primitive's node slot (see Gobj node
+transforms). Each frame is then a linear scan over the packets, in slot order,
+queueing the ones whose slot wasn't culled with a sort key (see RenderQueue).
+The queue is sorted and submitted in order, so draws sharing a material run
+together and only the first sets its textures and uniforms, and blended draws
+come last, back to front.
+
+Packets are built once a Gobj is ready to draw (its textures decode on
+workers), and again only if it is swapped with update(), its scene or node
+slots change, or refresh() is called after editing it in place.
+
+*/
 
 class RenderSystem {
 public:
     static constexpr uint16_t RenderListMax = 8;
+
+    // one mesh primitive's draw
+    struct DrawPacket {
+        // bgfx's default BGFX_CONFIG_MAX_VERTEX_STREAMS
+        static constexpr int MaxStreams = 4;
+        static constexpr uint16_t NoSlot = UINT16_MAX;
+        uint64_t state = 0; // primitive type and blend, added to settings.state
+        glm::vec4 baseColor;
+        glm::vec4 pbrValues;
+        bgfx::VertexBufferHandle vertexBuffers[MaxStreams];
+        bgfx::IndexBufferHandle indexBuffer;
+        bgfx::TextureHandle color;
+        bgfx::TextureHandle normal;
+        bgfx::TextureHandle metallicRoughness;
+        uint16_t slot = NoSlot; // node transform slot, NoSlot draws at identity
+        uint16_t material = 0;  // index in gobj's materials
+        uint8_t nVertexBuffers = 0;
+    };
+
+    // a renderable's packets, sorted by slot
+    struct PacketList {
+        Gobj * gobj = nullptr;
+        DrawPacket * packets = nullptr;
+        uint32_t nPackets = 0;
+        bool built = false;
+        // gobj state packets were built from
+        Gobj::Scene const * scene = nullptr;
+        uint16_t flattenCount = 0;
+    };
 public:
     bgfx::ProgramHandle unlitProgram;
     bgfx::ProgramHandle standardProgram;
@@ -19,12 +68,16 @@ public:
     Colors colors;
     RenderSettings settings;
 
+    // last frame's submits, mesh primitives culled, and material switches
+    struct Stats {
+        uint32_t submitted = 0;
+        uint32_t culled = 0;
+        uint32_t materialChanges = 0;
+    };
+    Stats stats;
+
     void init();
     void draw();
-    // returns aggregate submit count
-    uint16_t drawNode(Gobj * gobj, Gobj::Node * node, glm::mat4 const & parentTransform = Identity);
-    // returns submit count
-    uint16_t drawMesh(Gobj * gobj, Gobj::Mesh const & mesh, glm::mat4 const & transform = Identity);
     void shutdown();
 
     // adds gobj. if adds generic materials or other, might return different gobj
@@ -32,6 +85,9 @@ public:
     void remove(char const * key);
     // returns gobj at key before update, nullptr if not found
     Gobj * update(char const * key, Gobj * newGobj);
+    // rebuild gobj's draw packets before next draw, after changing its
+    // materials or meshes in place. nothing if gobj isn't added.
+    void refresh(Gobj * gobj);
 
     bool canAdd() const;
     bool keyExists(char const * key);
@@ -42,6 +98,10 @@ public:
     void showMoreStatus(char const * prefix = "");
     #endif // DEBUG || DEV_INTERFACE
 
+    #if DEV_INTERFACE
+    void editor();
+    #endif // DEV_INTERFACE
+
     size_t renderableCount() const;
 
     static Gobj::Counts typicalCountsForMinReqMat();
@@ -56,20 +116,44 @@ private:
     BXAllocator bxAllocator;
 
     CharKeys * renderList = nullptr;
+    PacketList packetLists[RenderListMax];
+    RenderQueue queue;
+    // queue values are packet list index, then packet index
+    static constexpr uint32_t QueuePacketBits = 29;
+    static_assert(RenderListMax <= (1u << (32 - QueuePacketBits)), "Packet list index must fit in queue value.");
+    // program field of queue keys
+    enum QueueProgram : uint8_t {
+        PROGRAM_STANDARD,
+    };
     
     void postAdd(Gobj * gobj);
     Gobj * addMinReqMat(Gobj * gobj);
     bool needsMinReqMat(Gobj * gobj);
     Gobj::Counts countsForMinReqMat(Gobj * gobj);
     void addHandles(Gobj * gobj);
-    bimg::ImageContainer * decodeImage(Gobj::Image * img, char const * loadedDirName);
+    // queue read of img's file, if it has one. nullptr if there's nothing to
+    // read. release file once decoded.
+    File * readImageFile(Gobj::Image * img, char const * loadedDirName, IOHandle * read);
+    // file (optional) is img's, already read
+    bimg::ImageContainer * decodeImage(Gobj::Image * img, char const * loadedDirName, File * file = nullptr);
     void removeHandles(Gobj * gobj);
 
+    // nullptr if gobj isn't added
+    PacketList * packetListFor(Gobj const * gobj);
+    void buildPackets(PacketList & list);
+    void releasePackets(Gobj const * gobj);
+    // queue list's packets that weren't culled. uses world bounds and cull
+    // results as of the last Gobj::updateWorldMatrices and frustum cull.
+    void queuePackets(PacketList const & list);
+    // submit sorted queue. returns submit count.
+    uint32_t drawQueue();
+
     #if DEV_INTERFACE
     friend class Editor;
     #endif // DEV_INTERFACE
 
     static constexpr glm::mat4 const Identity = glm::mat4{1.f};
+    static constexpr glm::mat3 const IdentityNormal = glm::mat3{1.f};
 };
 
     // bool destroy(char const * key);
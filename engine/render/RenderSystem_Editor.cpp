@@ -0,0 +1,302 @@
+#include "RenderSystem.h"
+#include <chrono>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "../common/imgui_bgfx_glfw/imgui_bgfx_glfw.h"
+#include "../MrManager.h"
+
+#if DEV_INTERFACE
+
+using namespace ImGui;
+
+// synthetic Gobj for the benchmark. a full binary tree of depth levels, each
+// node slightly rotated and offset from its parent, all sharing one mesh.
+static Gobj * createHierarchyGobj(int depth) {
+    uint32_t nNodes = (1u << depth) - 1;
+    Gobj * g = mm.memMan.createGobj({
+        .allStrLen = 64,
+        .accessors = 1,
+        .buffers = 1,
+        .bufferViews = 1,
+        .meshes = 1,
+        .meshAttributes = 1,
+        .meshPrimitives = 1,
+        .nodes = (uint16_t)nNodes,
+        .nodeChildren = (uint16_t)nNodes,
+        .scenes = 1,
+        .rawDataLen = 3 * (uint32_t)sizeof(float) * 3,
+    });
+    if (g == nullptr) {
+        return nullptr;
+    }
+
+    Gobj::Mesh * mesh = g->makeMesh({
+        .attributes = {Gobj::ATTR_POSITION},
+        .nAttributes = 1,
+        .nVertices = 3,
+        .name = "bench",
+    });
+
+    g->addScene("bench", true);
+    for (uint32_t parentIndex = 0; g->counts.nodes < nNodes; ++parentIndex) {
+        Gobj::Node * parent = g->nodes + parentIndex;
+        parent->children = g->addNodeChildren(2);
+        parent->nChildren = 2;
+    }
+    for (uint32_t nodeIndex = 0; nodeIndex < nNodes; ++nodeIndex) {
+        Gobj::Node * node = g->nodes + nodeIndex;
+        node->mesh = mesh;
+        *node->translation = glm::vec3{(nodeIndex & 1) ? .5f : -.5f, .5f, 0.f};
+        *node->rotation = glm::angleAxis(.1f, glm::vec3{0.f, 0.f, 1.f});
+        node->setTRSToMatrix(false);
+    }
+    return g;
+}
+
+// synthetic Gobj for the cull benchmark. one root with nNodes - 1 children,
+// randomly placed and rotated in a cube of side 2 * extent, all sharing one
+// unit-sized mesh.
+static Gobj * createScatteredGobj(uint16_t nNodes, float extent) {
+    Gobj * g = mm.memMan.createGobj({
+        .allStrLen = 64,
+        .accessors = 1,
+        .buffers = 1,
+        .bufferViews = 1,
+        .meshes = 1,
+        .meshAttributes = 1,
+        .meshPrimitives = 1,
+        .nodes = nNodes,
+        .nodeChildren = nNodes,
+        .scenes = 1,
+        .rawDataLen = 3 * (uint32_t)sizeof(float) * 3,
+    });
+    if (g == nullptr) {
+        return nullptr;
+    }
+
+    Gobj::Mesh * mesh = g->makeMesh({
+        .attributes = {Gobj::ATTR_POSITION},
+        .nAttributes = 1,
+        .nVertices = 3,
+        .name = "bench",
+    });
+    Gobj::Accessor * position = mesh->primitives[0].attributes[0].accessor;
+    for (int c = 0; c < 3; ++c) {
+        position->min[c] = -.5f;
+        position->max[c] = +.5f;
+    }
+    g->updateMeshBounds();
+
+    g->addScene("bench", true);
+    Gobj::Node * root = g->scene->nodes[0];
+    root->children = g->addNodeChildren(nNodes - 1);
+    root->nChildren = nNodes - 1;
+    srand(1);
+    for (uint16_t nodeIndex = 1; nodeIndex < nNodes; ++nodeIndex) {
+        Gobj::Node * node = g->nodes + nodeIndex;
+        node->mesh = mesh;
+        *node->translation = glm::vec3{randFloat(), randFloat(), randFloat()} * (2.f * extent) - extent;
+        *node->rotation = glm::angleAxis(randFloat() * 6.283f, glm::normalize(glm::vec3{randFloat(), randFloat(), randFloat()} + .01f));
+        node->setTRSToMatrix(false);
+    }
+    return g;
+}
+
+// what drawing did before world matrices were cached
+static float recomputeNode(Gobj::Node * node, glm::mat4 const & parentTransform) {
+    glm::mat4 global = parentTransform * *node->matrix;
+    float sum = 0.f;
+    if (node->mesh) {
+        for (int i = 0; i < node->mesh->nPrimitives; ++i) {
+            glm::mat3 nm = glm::transpose(glm::inverse(glm::mat3{global}));
+            sum += global[3][0] + nm[0][0];
+        }
+    }
+    for (uint16_t i = 0; i < node->nChildren; ++i) {
+        sum += recomputeNode(node->children[i], global);
+    }
+    return sum;
+}
+
+// same walk, reading the cached matrices, minus submitting
+static float cachedNode(Gobj::Node * node) {
+    float sum = 0.f;
+    if (node->mesh) {
+        for (int i = 0; i < node->mesh->nPrimitives; ++i) {
+            sum += (*node->world)[3][0] + (*node->normalMatrix)[0][0];
+        }
+    }
+    for (uint16_t i = 0; i < node->nChildren; ++i) {
+        sum += cachedNode(node->children[i]);
+    }
+    return sum;
+}
+
+/*
+Last frame's draw stats, and two benchmarks.
+
+Times the per-frame transform work of drawing a static hierarchy, walking
+it the way draw() did before draw packets, without submitting to bgfx.
+"recompute" multiplies down the tree and inverts a normal matrix per
+primitive every frame. "cached" runs the world matrix pass, which finds nothing dirty, and reuses each node's
+matrices. "root moved" is the worst case, with the root marked dirty every
+frame so the pass updates every slot.
+
+The cull benchmark scatters nodes through a large volume, in front of and
+behind a synthetic 60 degree camera at the center, and times the world bounds
+update (every slot dirty) and then culling every slot with each implementation
+the CPU supports. Nothing is submitted, so it runs the same without a window.
+*/
+void RenderSystem::editor() {
+    if (!CollapsingHeader("Render Stats")) {
+        return;
+    }
+
+    Text("Last frame: %u submitted, %u culled, %u material changes", stats.submitted, stats.culled, stats.materialChanges);
+    Text("Render queue: %u draws, %u sort passes", queue.size(), queue.lastPasses());
+    Text("Cull impl: %s", settings.user.frustumCull ? Frustum::implStr(Frustum::bestImpl()) : "off");
+    uint32_t nPackets = 0;
+    for (PacketList const & list : packetLists) {
+        nPackets += list.nPackets;
+    }
+    Text("Draw packets: %u (%s)", nPackets, mm.frameByteSizeStr(sizeof(DrawPacket) * nPackets));
+
+    static constexpr int NDepths = 2;
+    static constexpr int Depths[NDepths] = {10, 15};
+    static constexpr int Iterations = 20;
+    // best milliseconds, [0] recompute, [1] cached, [2] root moved
+    static double transformMs[NDepths][3] = {};
+    static bool didRun = false;
+    static bool failed = false;
+    static volatile float sink = 0.f;
+
+    auto bestMs = [](auto const & fn) {
+        double best = 0.0;
+        for (int i = 0; i < Iterations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+            if (i == 0 || ms.count() < best) best = ms.count();
+        }
+        return best;
+    };
+
+    TextUnformatted("Transform Benchmark:");
+    SameLine();
+    if (Button("Run##TransformBenchmark")) {
+        failed = false;
+        for (int d = 0; d < NDepths && !failed; ++d) {
+            Gobj * g = createHierarchyGobj(Depths[d]);
+            if (g == nullptr) {
+                failed = true;
+                break;
+            }
+            Gobj::Node * root = g->scene->nodes[0];
+            transformMs[d][0] = bestMs([&]{
+                sink = sink + recomputeNode(root, Identity);
+            });
+            transformMs[d][1] = bestMs([&]{
+                g->updateWorldMatrices();
+                sink = sink + cachedNode(root);
+            });
+            transformMs[d][2] = bestMs([&]{
+                root->markDirty();
+                g->updateWorldMatrices();
+                sink = sink + cachedNode(root);
+            });
+            mm.memMan.request({.ptr = g});
+        }
+        didRun = true;
+    }
+
+    if (failed) {
+        TextUnformatted("Not enough memory for benchmark Gobj.");
+    }
+    else if (didRun) {
+        for (int d = 0; d < NDepths; ++d) {
+            Text("depth %2d (%5u nodes): recompute %7.3f ms, cached %7.3f ms (%.1fx), root moved %7.3f ms",
+                Depths[d],
+                (1u << Depths[d]) - 1,
+                transformMs[d][0],
+                transformMs[d][1],
+                transformMs[d][0] / transformMs[d][1],
+                transformMs[d][2]
+            );
+        }
+    }
+
+    static constexpr int NScenes = 2;
+    static constexpr uint16_t SceneNodes[NScenes] = {10000, 60000};
+    static constexpr float SceneExtent = 500.f;
+    static constexpr int NImpls = 3;
+    // best milliseconds, [0] bounds update, [1 + impl] cull
+    static double cullMs[NScenes][1 + NImpls] = {};
+    static uint32_t cullVisible[NScenes][NImpls] = {};
+    static bool didRunCull = false;
+    static bool failedCull = false;
+
+    TextUnformatted("Cull Benchmark:");
+    SameLine();
+    if (Button("Run##CullBenchmark")) {
+        failedCull = false;
+        Frustum frustum;
+        frustum.setFromViewProj(
+            glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, SceneExtent * 2.f) *
+            glm::lookAt(glm::vec3{0.f}, glm::vec3{0.f, 0.f, -1.f}, glm::vec3{0.f, 1.f, 0.f})
+        );
+        for (int s = 0; s < NScenes && !failedCull; ++s) {
+            Gobj * g = createScatteredGobj(SceneNodes[s], SceneExtent);
+            if (g == nullptr) {
+                failedCull = true;
+                break;
+            }
+            Gobj::Node * root = g->scene->nodes[0];
+            cullMs[s][0] = bestMs([&]{
+                root->markDirty();
+                g->updateWorldMatrices();
+            });
+            for (int i = 0; i < NImpls; ++i) {
+                Frustum::Impl impl = (Frustum::Impl)i;
+                if (!Frustum::supports(impl)) {
+                    cullMs[s][1 + i] = 0.0;
+                    continue;
+                }
+                cullMs[s][1 + i] = bestMs([&]{
+                    cullVisible[s][i] = frustum.cull(impl, g->nodeBounds, g->nodeLaneStride(), g->nFlatNodes, g->nodeVisible);
+                });
+            }
+            mm.memMan.request({.ptr = g});
+        }
+        didRunCull = true;
+    }
+
+    if (failedCull) {
+        TextUnformatted("Not enough memory for benchmark Gobj.");
+    }
+    else if (didRunCull) {
+        for (int s = 0; s < NScenes; ++s) {
+            Text("%5u nodes: bounds update %7.3f ms, %5u visible",
+                SceneNodes[s],
+                cullMs[s][0],
+                cullVisible[s][Frustum::IMPL_SCALAR]
+            );
+            for (int i = 0; i < NImpls; ++i) {
+                if (!Frustum::supports((Frustum::Impl)i)) {
+                    Text("    %-6s unsupported", Frustum::implStr((Frustum::Impl)i));
+                    continue;
+                }
+                Text("    %-6s %7.3f ms (%.1fx)%s",
+                    Frustum::implStr((Frustum::Impl)i),
+                    cullMs[s][1 + i],
+                    cullMs[s][1 + Frustum::IMPL_SCALAR] / cullMs[s][1 + i],
+                    (cullVisible[s][i] != cullVisible[s][Frustum::IMPL_SCALAR]) ? ", MISMATCH" : ""
+                );
+            }
+        }
+    }
+
+    Dummy(ImVec2(0.0f, 20.0f));
+}
+
+#endif // DEV_INTERFACE
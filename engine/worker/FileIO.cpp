@@ -0,0 +1,488 @@
+#include "FileIO.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../MrManager.h"
+#include "../memory/File.h"
+#if FILEIO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif // FILEIO_URING
+
+// reads are split so each fits an sqe's 32-bit length
+static constexpr size_t MaxChunk = (size_t)1 << 30;
+
+// -------------------------------------------------------------------------- //
+// RING
+// -------------------------------------------------------------------------- //
+#if FILEIO_URING
+bool FileIO::Ring::init(uint32_t entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return false;
+    }
+    _fd = fd;
+    _entries = params.sq_entries;
+
+    // newer kernels map both rings at once
+    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP);
+    if (singleMap) {
+        if (_cqRingSize > _sqRingSize) _sqRingSize = _cqRingSize;
+        _cqRingSize = _sqRingSize;
+    }
+
+    _sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (_sqRing == MAP_FAILED) {
+        _sqRing = nullptr;
+        shutdown();
+        return false;
+    }
+    if (singleMap) {
+        _cqRing = _sqRing;
+    }
+    else {
+        _cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (_cqRing == MAP_FAILED) {
+            _cqRing = nullptr;
+            shutdown();
+            return false;
+        }
+    }
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (_sqes == MAP_FAILED) {
+        _sqes = nullptr;
+        shutdown();
+        return false;
+    }
+
+    byte_t * sq = (byte_t *)_sqRing;
+    _sqHead  = (uint32_t *)(sq + params.sq_off.head);
+    _sqTail  = (uint32_t *)(sq + params.sq_off.tail);
+    _sqMask  = (uint32_t *)(sq + params.sq_off.ring_mask);
+    _sqArray = (uint32_t *)(sq + params.sq_off.array);
+    byte_t * cq = (byte_t *)_cqRing;
+    _cqHead  = (uint32_t *)(cq + params.cq_off.head);
+    _cqTail  = (uint32_t *)(cq + params.cq_off.tail);
+    _cqMask  = (uint32_t *)(cq + params.cq_off.ring_mask);
+    _cqes    = cq + params.cq_off.cqes;
+    return true;
+}
+
+void FileIO::Ring::shutdown() {
+    if (_sqes) munmap(_sqes, _sqesSize);
+    if (_cqRing && _cqRing != _sqRing) munmap(_cqRing, _cqRingSize);
+    if (_sqRing) munmap(_sqRing, _sqRingSize);
+    if (_fd >= 0) close(_fd);
+    *this = Ring{};
+}
+
+bool FileIO::Ring::submitRead(int fd, void * dst, uint32_t size, uint64_t offset, uint64_t userData) {
+    // only this thread moves tail. kernel moves head as it consumes.
+    uint32_t tail = *_sqTail;
+    uint32_t head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+    if (tail - head >= _entries) {
+        return false;
+    }
+    uint32_t index = tail & *_sqMask;
+    io_uring_sqe * sqe = (io_uring_sqe *)_sqes + index;
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)dst;
+    sqe->len = size;
+    sqe->off = offset;
+    sqe->user_data = userData;
+    _sqArray[index] = index;
+    __atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++_toSubmit;
+    return true;
+}
+
+bool FileIO::Ring::enter(uint32_t minComplete) {
+    for (;;) {
+        int submitted = (int)syscall(__NR_io_uring_enter,
+            _fd,
+            _toSubmit,
+            minComplete,
+            (minComplete) ? IORING_ENTER_GETEVENTS : 0,
+            nullptr,
+            0
+        );
+        if (submitted >= 0) {
+            _toSubmit -= (uint32_t)submitted;
+            return true;
+        }
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+template <typename Fn>
+void FileIO::Ring::reap(Fn const & fn) {
+    uint32_t head = *_cqHead;
+    uint32_t tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        io_uring_cqe const & cqe = ((io_uring_cqe const *)_cqes)[head & *_cqMask];
+        fn(cqe.user_data, cqe.res);
+    }
+    __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+}
+#endif // FILEIO_URING
+
+// -------------------------------------------------------------------------- //
+// INIT
+// -------------------------------------------------------------------------- //
+void FileIO::init(size_t nThreads, size_t capacity) {
+    // no slots, every read is inline
+    if (capacity == 0) return;
+
+    _capacity = (uint32_t)capacity;
+    uint32_t queueCapacity = 1;
+    while (queueCapacity < _capacity) queueCapacity <<= 1;
+    _queueMask = queueCapacity - 1;
+
+    _requests = (Request *)mm.memMan.request({.size = sizeof(Request) * _capacity, .align = alignof(Request)});
+    _queue = (uint32_t *)mm.memMan.request({.size = sizeof(uint32_t) * queueCapacity});
+    assert(_requests && _queue && "Could not allocate file I/O.");
+    for (uint32_t i = 0; i < _capacity; ++i) {
+        new (_requests + i) Request{};
+    }
+
+    // one thread drives the ring
+    #if FILEIO_URING
+    uint32_t ringEntries = (RingEntries < _capacity) ? RingEntries : _capacity;
+    if (_ring.init(ringEntries)) {
+        _backend = BACKEND_URING;
+        nThreads = 1;
+    }
+    #endif // FILEIO_URING
+    if (_backend == BACKEND_NONE) {
+        _backend = BACKEND_THREADS;
+        if (nThreads == 0) nThreads = 1;
+        if (nThreads > MaxThreads) nThreads = MaxThreads;
+    }
+
+    _nThreads = (uint16_t)nThreads;
+    _threads = (std::thread *)mm.memMan.request({.size = sizeof(std::thread) * _nThreads, .align = alignof(std::thread)});
+    assert(_threads && "Could not allocate file I/O threads.");
+    for (uint16_t i = 0; i < _nThreads; ++i) {
+        #if FILEIO_URING
+        if (_backend == BACKEND_URING) {
+            new (_threads + i) std::thread{[this]{ uringLoop(); }};
+            continue;
+        }
+        #endif // FILEIO_URING
+        new (_threads + i) std::thread{[this]{ threadLoop(); }};
+    }
+}
+
+void FileIO::shutdown() {
+    if (_requests == nullptr) return;
+
+    {
+        std::lock_guard<std::mutex> lock{_queueMutex};
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (uint16_t i = 0; i < _nThreads; ++i) {
+        _threads[i].join();
+        _threads[i].~thread();
+    }
+    #if FILEIO_URING
+    if (_backend == BACKEND_URING) {
+        _ring.shutdown();
+    }
+    #endif // FILEIO_URING
+
+    for (uint32_t i = 0; i < _capacity; ++i) {
+        _requests[i].~Request();
+    }
+    mm.memMan.request({.ptr = _threads});
+    mm.memMan.request({.ptr = _queue});
+    mm.memMan.request({.ptr = _requests});
+    _threads = nullptr;
+    _queue = nullptr;
+    _requests = nullptr;
+    _nThreads = 0;
+    _backend = BACKEND_NONE;
+}
+
+// -------------------------------------------------------------------------- //
+// INTERFACE
+// -------------------------------------------------------------------------- //
+IOHandle FileIO::read(char const * path, void * dst, size_t size, size_t offset) {
+    return submit(path, dst, size, offset, nullptr);
+}
+
+IOHandle FileIO::load(File * file) {
+    if (file->mapped()) {
+        fprintf(stderr, "File \"%s\" is mapped, not loading.\n", file->path().full);
+        return {IOHandle::Inline, false};
+    }
+    return submit(file->path().full, file->data(), file->fileSize(), 0, file);
+}
+
+bool FileIO::isComplete(IOHandle handle) const {
+    if (handle.index == IOHandle::Inline || !handle.isValid()) return true;
+    Request const & req = _requests[handle.index];
+    return (
+        req.generation.load(std::memory_order_acquire) != handle.generation ||
+        req.state.load(std::memory_order_acquire) >= STATE_DONE
+    );
+}
+
+bool FileIO::wait(IOHandle handle) {
+    if (handle.index == IOHandle::Inline) return (handle.generation != 0);
+    if (!handle.isValid()) return false;
+
+    Request & req = _requests[handle.index];
+    assert(req.generation.load(std::memory_order_relaxed) == handle.generation &&
+        "File read handle already waited on.");
+
+    uint32_t state;
+    {
+        std::unique_lock<std::mutex> lock{_doneMutex};
+        _done.wait(lock, [&req, &state]{
+            state = req.state.load(std::memory_order_acquire);
+            return (state >= STATE_DONE);
+        });
+    }
+    req.generation.fetch_add(1, std::memory_order_relaxed);
+    req.state.store(STATE_FREE, std::memory_order_release);
+    return (state == STATE_DONE);
+}
+
+char const * FileIO::backendStr(Backend backend) {
+    switch (backend) {
+    case BACKEND_NONE:      return "inline";
+    case BACKEND_THREADS:   return "threads";
+    case BACKEND_URING:     return "io_uring";
+    }
+    return "";
+}
+
+// -------------------------------------------------------------------------- //
+// INTERNALS
+// -------------------------------------------------------------------------- //
+uint32_t FileIO::claimRequest() {
+    if (_requests == nullptr) return IOHandle::Invalid;
+    for (uint32_t tries = 0; tries < _capacity; ++tries) {
+        uint32_t index = _nextRequest.fetch_add(1, std::memory_order_relaxed) % _capacity;
+        uint32_t expected = STATE_FREE;
+        if (_requests[index].state.compare_exchange_strong(expected, STATE_CLAIMED, std::memory_order_acquire)) {
+            return index;
+        }
+    }
+    return IOHandle::Invalid;
+}
+
+IOHandle FileIO::submit(char const * path, void * dst, size_t size, size_t offset, File * file) {
+    uint32_t index = claimRequest();
+
+    Request inlineReq;
+    Request & req = (index == IOHandle::Invalid) ? inlineReq : _requests[index];
+    snprintf(req.path, PathMax, "%s", path);
+    req.dst = (byte_t *)dst;
+    req.size = size;
+    req.offset = offset;
+    req.head = 0;
+    req.file = file;
+    req.fd = -1;
+
+    // no slot free, read inline
+    if (index == IOHandle::Invalid) {
+        bool success = readNow(req);
+        finishFile(req, success);
+        _nInline.fetch_add(1, std::memory_order_relaxed);
+        if (success) _bytesRead.fetch_add(size, std::memory_order_relaxed);
+        else _nFailed.fetch_add(1, std::memory_order_relaxed);
+        return {IOHandle::Inline, success};
+    }
+
+    IOHandle handle{index, req.generation.load(std::memory_order_relaxed)};
+    enqueue(index);
+    return handle;
+}
+
+void FileIO::enqueue(uint32_t index) {
+    {
+        std::lock_guard<std::mutex> lock{_queueMutex};
+        _requests[index].state.store(STATE_QUEUED, std::memory_order_relaxed);
+        _queue[_queueTail++ & _queueMask] = index;
+    }
+    _wake.notify_one();
+}
+
+uint32_t FileIO::dequeue(uint32_t * indices, uint32_t max, bool dontBlock) {
+    std::unique_lock<std::mutex> lock{_queueMutex};
+    if (!dontBlock) {
+        _wake.wait(lock, [this]{ return (_queueHead != _queueTail || _quit); });
+    }
+    uint32_t n = 0;
+    while (n < max && _queueHead != _queueTail) {
+        indices[n++] = _queue[_queueHead++ & _queueMask];
+    }
+    return n;
+}
+
+bool FileIO::readNow(Request & req) {
+    errno = 0;
+    int fd = open(req.path, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Error opening file \"%s\" for reading: %d\n", req.path, errno);
+        return false;
+    }
+    while (req.head < req.size) {
+        ssize_t n = pread(fd, req.dst + req.head, req.size - req.head, (off_t)(req.offset + req.head));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            fprintf(stderr, "Error reading file \"%s\" contents: read %zu, expecting %zu\n",
+                req.path, req.head, req.size);
+            close(fd);
+            return false;
+        }
+        req.head += (size_t)n;
+    }
+    close(fd);
+    return true;
+}
+
+void FileIO::finishFile(Request & req, bool success) {
+    if (req.file == nullptr || !success) return;
+    // 0x00 byte written after file contents, same as File::load
+    req.file->data()[req.file->size() - 1] = '\0';
+    req.file->_loaded = true;
+}
+
+void FileIO::complete(uint32_t index, bool success) {
+    Request & req = _requests[index];
+    finishFile(req, success);
+    _nReads.fetch_add(1, std::memory_order_relaxed);
+    if (success) _bytesRead.fetch_add(req.size, std::memory_order_relaxed);
+    else _nFailed.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock{_doneMutex};
+        req.state.store((success) ? STATE_DONE : STATE_FAILED, std::memory_order_release);
+    }
+    _done.notify_all();
+}
+
+void FileIO::threadLoop() {
+    uint32_t index;
+    while (dequeue(&index, 1, false)) {
+        complete(index, readNow(_requests[index]));
+    }
+}
+
+#if FILEIO_URING
+/*
+Files are opened here (opens are cheap next to reads), then reads go to the
+ring. Waits in the kernel for a completion while anything is in flight, so new
+requests are picked up as reads finish. Kernels without IORING_OP_READ (before
+5.6) fail it with -EINVAL, and those reads finish with a blocking read instead.
+If entering the ring fails, the ring is dropped: reads in flight finish
+blocking, and this thread carries on as a blocking worker.
+*/
+void FileIO::uringLoop() {
+    uint32_t inFlight = 0;
+    // request indices with a read in the ring, first inFlight are valid
+    uint32_t flying[RingEntries];
+    uint32_t indices[RingEntries];
+
+    auto submitNext = [this](uint32_t index) {
+        Request & req = _requests[index];
+        size_t left = req.size - req.head;
+        uint32_t chunk = (uint32_t)((left < MaxChunk) ? left : MaxChunk);
+        bool submitted = _ring.submitRead(req.fd, req.dst + req.head, chunk, req.offset + req.head, index);
+        assert(submitted && "Ring full with fewer reads in flight than entries.");
+        (void)submitted;
+    };
+    auto finish = [this, &inFlight, &flying](uint32_t index, bool success) {
+        Request & req = _requests[index];
+        close(req.fd);
+        req.fd = -1;
+        complete(index, success);
+        for (uint32_t i = 0; i < inFlight; ++i) {
+            if (flying[i] == index) {
+                flying[i] = flying[--inFlight];
+                break;
+            }
+        }
+    };
+
+    for (;;) {
+        uint32_t room = _ring.entries() - inFlight;
+        if (room > RingEntries) room = RingEntries;
+        uint32_t n = (room) ? dequeue(indices, room, inFlight > 0) : 0;
+        // quitting, and nothing left
+        if (n == 0 && inFlight == 0) {
+            break;
+        }
+
+        for (uint32_t i = 0; i < n; ++i) {
+            Request & req = _requests[indices[i]];
+            errno = 0;
+            req.fd = open(req.path, O_RDONLY);
+            if (req.fd == -1) {
+                fprintf(stderr, "Error opening file \"%s\" for reading: %d\n", req.path, errno);
+                complete(indices[i], false);
+                continue;
+            }
+            flying[inFlight++] = indices[i];
+            if (req.size == 0) {
+                finish(indices[i], true);
+                continue;
+            }
+            submitNext(indices[i]);
+        }
+        if (inFlight == 0) {
+            continue;
+        }
+
+        // enter already retries EINTR
+        if (!_ring.enter(1)) {
+            fprintf(stderr, "Error entering io_uring, using blocking reads: %d\n", errno);
+            _ring.shutdown();
+            while (inFlight) {
+                finish(flying[0], readNow(_requests[flying[0]]));
+            }
+            _backend = BACKEND_THREADS;
+            threadLoop();
+            return;
+        }
+        _ring.reap([&](uint64_t userData, int32_t result) {
+            uint32_t index = (uint32_t)userData;
+            Request & req = _requests[index];
+            if (result == -EINTR || result == -EAGAIN) {
+                submitNext(index);
+                return;
+            }
+            if (result == -EINVAL) {
+                finish(index, readNow(req));
+                return;
+            }
+            if (result <= 0) {
+                fprintf(stderr, "Error reading file \"%s\" contents: read %zu, expecting %zu (%d)\n",
+                    req.path, req.head, req.size, result);
+                finish(index, false);
+                return;
+            }
+            req.head += (size_t)result;
+            if (req.head < req.size) {
+                submitNext(index);
+                return;
+            }
+            finish(index, true);
+        });
+    }
+}
+#endif // FILEIO_URING
@@ -0,0 +1,195 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "../common/debug_defines.h"
+#include "../common/types.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define FILEIO_URING 1
+#else
+#define FILEIO_URING 0
+#endif
+
+/*
+
+Asynchronous file reads, into memory the caller already has (usually a MemMan
+block). read() queues a read and returns a handle right away, so loaders can
+keep parsing or decoding while the disk catches up.
+
+On Linux, reads go through io_uring: one I/O thread opens files, submits reads
+to the ring and reaps their completions. Elsewhere, or if the ring can't be set
+up (old kernel, seccomp), a few I/O threads each do blocking reads. Either way,
+the calling thread only blocks if it waits on a read that isn't done yet.
+
+Requests live in a fixed pool of setup.ioCapacity slots. A handle must be
+waited on exactly once, which collects its result and frees its slot. If every
+slot is taken, or before init, the read is done inline on the calling thread.
+
+*/
+
+class File;
+
+class IOHandle {
+public:
+    static constexpr uint32_t Invalid = UINT32_MAX;
+    // read was done inline. generation holds result.
+    static constexpr uint32_t Inline = UINT32_MAX - 1;
+    uint32_t index = Invalid;
+    uint32_t generation = 0;
+    bool isValid() const { return (index != Invalid); }
+};
+
+class FileIO {
+// TYPES AND STATICS
+public:
+    enum Backend {
+        BACKEND_NONE,
+        BACKEND_THREADS,
+        BACKEND_URING,
+    };
+    static constexpr size_t PathMax = 256;
+    static constexpr uint16_t MaxThreads = 16;
+    static constexpr uint32_t RingEntries = 64;
+
+// INTERFACE
+public:
+    // queue read of size bytes from offset in path into dst, which must stay
+    // valid until waited on. path is copied. short reads fail.
+    IOHandle read(char const * path, void * dst, size_t size, size_t offset = 0);
+    // queue load of file's contents into its block (see File::load). file
+    // counts as loaded once complete.
+    IOHandle load(File * file);
+    bool isComplete(IOHandle handle) const;
+    // block until complete, then release handle. true if read succeeded.
+    bool wait(IOHandle handle);
+
+    Backend backend() const { return _backend; }
+    static char const * backendStr(Backend backend);
+
+    #if DEV_INTERFACE
+    void editor();
+    #endif // DEV_INTERFACE
+
+// PRIVATE TYPES
+private:
+    enum State : uint32_t {
+        STATE_FREE,
+        STATE_CLAIMED,
+        STATE_QUEUED,
+        STATE_DONE,
+        STATE_FAILED,
+    };
+
+    class Request {
+    public:
+        char path[PathMax];
+        byte_t * dst = nullptr;
+        size_t size = 0;
+        size_t offset = 0;
+        // bytes read so far. io_uring may return partial reads.
+        size_t head = 0;
+        File * file = nullptr;
+        int fd = -1;
+        std::atomic<uint32_t> state{STATE_FREE};
+        std::atomic<uint32_t> generation{0};
+    };
+
+    #if FILEIO_URING
+    // mapped io_uring submission/completion queues
+    class Ring {
+    public:
+        bool init(uint32_t entries);
+        void shutdown();
+        // false if submission queue is full
+        bool submitRead(int fd, void * dst, uint32_t size, uint64_t offset, uint64_t userData);
+        // enter ring, submitting everything queued since last enter, and wait
+        // for at least minComplete completions
+        bool enter(uint32_t minComplete);
+        // call fn(userData, result) on each completion ready
+        template <typename Fn>
+        void reap(Fn const & fn);
+        uint32_t entries() const { return _entries; }
+    private:
+        int _fd = -1;
+        uint32_t _entries = 0;
+        uint32_t _toSubmit = 0;
+        void * _sqRing = nullptr;
+        void * _cqRing = nullptr;
+        size_t _sqRingSize = 0;
+        size_t _cqRingSize = 0;
+        void * _sqes = nullptr;
+        size_t _sqesSize = 0;
+        uint32_t * _sqHead = nullptr;
+        uint32_t * _sqTail = nullptr;
+        uint32_t * _sqMask = nullptr;
+        uint32_t * _sqArray = nullptr;
+        uint32_t * _cqHead = nullptr;
+        uint32_t * _cqTail = nullptr;
+        uint32_t * _cqMask = nullptr;
+        void * _cqes = nullptr;
+    };
+    #endif // FILEIO_URING
+
+// INIT
+private:
+    friend class MrManager;
+    // call from main thread. nThreads is for the blocking fallback.
+    void init(size_t nThreads, size_t capacity);
+    // finishes queued reads, then joins I/O threads
+    void shutdown();
+
+// STORAGE
+private:
+    // uring thread switches to BACKEND_THREADS if the ring fails
+    std::atomic<Backend> _backend{BACKEND_NONE};
+    uint32_t _capacity = 0;
+    Request * _requests = nullptr;
+    std::atomic<uint32_t> _nextRequest{0};
+
+    // queued request indices, waiting for an I/O thread
+    uint32_t * _queue = nullptr;
+    uint32_t _queueMask = 0;
+    uint32_t _queueHead = 0;
+    uint32_t _queueTail = 0;
+    std::mutex _queueMutex;
+    std::condition_variable _wake;
+    bool _quit = false;
+
+    // completions, for wait()
+    std::mutex _doneMutex;
+    std::condition_variable _done;
+
+    uint16_t _nThreads = 0;
+    std::thread * _threads = nullptr;
+    #if FILEIO_URING
+    Ring _ring;
+    #endif // FILEIO_URING
+
+    // stats
+    std::atomic<uint64_t> _nReads{0};
+    std::atomic<uint64_t> _nFailed{0};
+    std::atomic<uint64_t> _nInline{0};
+    std::atomic<uint64_t> _bytesRead{0};
+
+// INTERNALS
+private:
+    uint32_t claimRequest();
+    void enqueue(uint32_t index);
+    // pop up to max queued indices. blocks for at least one unless
+    // dontBlock. returns 0 once quitting and queue is empty.
+    uint32_t dequeue(uint32_t * indices, uint32_t max, bool dontBlock);
+    // fill a claimed request and queue it. inline if none is free.
+    IOHandle submit(char const * path, void * dst, size_t size, size_t offset, File * file);
+    // open, read and close, blocking
+    static bool readNow(Request & req);
+    // terminate and mark loaded, if request was a File load
+    static void finishFile(Request & req, bool success);
+    // mark request done or failed, and wake waiters
+    void complete(uint32_t index, bool success);
+    void threadLoop();
+    #if FILEIO_URING
+    void uringLoop();
+    #endif // FILEIO_URING
+};
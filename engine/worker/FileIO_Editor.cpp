@@ -0,0 +1,32 @@
+#include "FileIO.h"
+#include "../common/imgui_bgfx_glfw/imgui_bgfx_glfw.h"
+#include "../MrManager.h"
+
+#if DEV_INTERFACE
+
+using namespace ImGui;
+
+void FileIO::editor() {
+    if (!CollapsingHeader("File I/O")) {
+        return;
+    }
+
+    Text("Backend: %s", backendStr(_backend));
+    Text("%u threads, %u slots", _nThreads, _capacity);
+
+    uint32_t nBusy = 0;
+    for (uint32_t i = 0; i < _capacity; ++i) {
+        if (_requests[i].state.load(std::memory_order_relaxed) != STATE_FREE) ++nBusy;
+    }
+    Text("Busy slots: %u", nBusy);
+    Text("Reads: %llu (%llu inline, %llu failed)",
+        (unsigned long long)_nReads.load(std::memory_order_relaxed),
+        (unsigned long long)_nInline.load(std::memory_order_relaxed),
+        (unsigned long long)_nFailed.load(std::memory_order_relaxed)
+    );
+    Text("Read: %s", mm.frameByteSizeStr(_bytesRead.load(std::memory_order_relaxed)));
+
+    Dummy(ImVec2(0.0f, 20.0f));
+}
+
+#endif // DEV_INTERFACE
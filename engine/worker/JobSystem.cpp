@@ -0,0 +1,385 @@
+#include "JobSystem.h"
+#include "../MrManager.h"
+
+thread_local int JobSystem::_threadIndex = -1;
+
+// -------------------------------------------------------------------------- //
+// DEQUE
+// -------------------------------------------------------------------------- //
+void JobSystem::Deque::init(std::atomic<uint32_t> * buffer, uint32_t capacity) {
+    assert(capacity && (capacity & (capacity - 1)) == 0 && "Capacity must be power of 2.");
+    _buffer = buffer;
+    _mask = capacity - 1;
+}
+
+bool JobSystem::Deque::push(uint32_t jobIndex) {
+    int64_t b = _bottom.load(std::memory_order_relaxed);
+    int64_t t = _top.load(std::memory_order_acquire);
+    if (b - t > (int64_t)_mask) {
+        return false;
+    }
+    _buffer[b & _mask].store(jobIndex, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+uint32_t JobSystem::Deque::pop() {
+    int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+    _bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = _top.load(std::memory_order_relaxed);
+
+    // empty
+    if (t > b) {
+        _bottom.store(b + 1, std::memory_order_relaxed);
+        return JobHandle::Invalid;
+    }
+
+    uint32_t jobIndex = _buffer[b & _mask].load(std::memory_order_relaxed);
+    // last one, race thieves for it
+    if (t == b) {
+        if (!_top.compare_exchange_strong(t, t + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            jobIndex = JobHandle::Invalid;
+        }
+        _bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return jobIndex;
+}
+
+uint32_t JobSystem::Deque::steal() {
+    int64_t t = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = _bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return JobHandle::Invalid;
+    }
+    uint32_t jobIndex = _buffer[t & _mask].load(std::memory_order_relaxed);
+    if (!_top.compare_exchange_strong(t, t + 1,
+        std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return JobHandle::Invalid;
+    }
+    return jobIndex;
+}
+
+// -------------------------------------------------------------------------- //
+// INIT
+// -------------------------------------------------------------------------- //
+void JobSystem::init(size_t nWorkers, size_t jobCapacity) {
+    if (nWorkers == 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        nWorkers = (hw > 1) ? hw - 1 : 1;
+    }
+    if (nWorkers > MaxThreads - 1) {
+        nWorkers = MaxThreads - 1;
+    }
+    _nThreads = (uint16_t)(nWorkers + 1);
+    _jobCapacity = (uint32_t)jobCapacity;
+
+    uint32_t dequeCapacity = 1;
+    while (dequeCapacity < _jobCapacity) dequeCapacity <<= 1;
+
+    _jobs = (Job *)mm.memMan.request({.size = sizeof(Job) * _jobCapacity, .align = alignof(Job)});
+    _deques = (Deque *)mm.memMan.request({.size = sizeof(Deque) * (_nThreads + 1), .align = alignof(Deque)});
+    _dequeBuffers = (std::atomic<uint32_t> *)mm.memMan.request({
+        .size = sizeof(std::atomic<uint32_t>) * dequeCapacity * (_nThreads + 1)
+    });
+    _workers = (std::thread *)mm.memMan.request({.size = sizeof(std::thread) * nWorkers, .align = alignof(std::thread)});
+    assert(_jobs && _deques && _dequeBuffers && _workers && "Could not allocate job system.");
+
+    for (uint32_t i = 0; i < _jobCapacity; ++i) {
+        new (_jobs + i) Job{};
+    }
+    for (uint16_t i = 0; i <= _nThreads; ++i) {
+        new (_deques + i) Deque{};
+        _deques[i].init(_dequeBuffers + i * dequeCapacity, dequeCapacity);
+    }
+
+    _threadIndex = 0;
+    for (uint16_t i = 1; i < _nThreads; ++i) {
+        new (_workers + i - 1) std::thread{[this, i]{
+            workerLoop(i);
+        }};
+    }
+}
+
+void JobSystem::shutdown() {
+    if (_workers == nullptr) return;
+
+    {
+        std::lock_guard<std::mutex> lock{_sleepMutex};
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (uint16_t i = 1; i < _nThreads; ++i) {
+        _workers[i - 1].join();
+        _workers[i - 1].~thread();
+    }
+
+    // groups completed since last tick are dropped without onComplete
+    while (_completedGroups) {
+        JobCounter * group = _completedGroups;
+        _completedGroups = group->_nextCompleted;
+        group->~JobCounter();
+        mm.memMan.request({.ptr = group});
+    }
+
+    for (uint32_t i = 0; i < _jobCapacity; ++i) {
+        _jobs[i].~Job();
+    }
+    mm.memMan.request({.ptr = _workers});
+    mm.memMan.request({.ptr = _dequeBuffers});
+    mm.memMan.request({.ptr = _deques});
+    mm.memMan.request({.ptr = _jobs});
+    _workers = nullptr;
+    _threadIndex = -1;
+}
+
+// -------------------------------------------------------------------------- //
+// INTERFACE
+// -------------------------------------------------------------------------- //
+JobHandle JobSystem::run(Fn const & task, JobCounter * counter, JobCounter * after) {
+    if (counter) {
+        counter->_state.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t jobIndex = claimJob();
+    // pool full. a job waiting on a counter can't run inline (its counter may
+    // only reach zero after we return), so help out until a slot frees.
+    while (jobIndex == JobHandle::Invalid && after) {
+        if (!runOne()) std::this_thread::yield();
+        jobIndex = claimJob();
+    }
+    // pool full, run inline
+    if (jobIndex == JobHandle::Invalid) {
+        task();
+        decrement(counter);
+        return {};
+    }
+
+    Job & job = _jobs[jobIndex];
+    job._task = task;
+    job._counter = counter;
+    JobHandle handle{jobIndex, job._generation.load(std::memory_order_relaxed)};
+
+    // push onto after's waiting list, unless it's already at zero
+    if (after) {
+        uint64_t state = after->_state.load(std::memory_order_acquire);
+        while ((uint32_t)state != 0) {
+            job._nextWaiting = (uint32_t)(state >> 32);
+            uint64_t waiting = (state & 0xffffffff) | ((uint64_t)jobIndex << 32);
+            if (after->_state.compare_exchange_weak(state, waiting,
+                std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return handle;
+            }
+        }
+        job._nextWaiting = JobHandle::Invalid;
+    }
+    enqueue(jobIndex);
+    return handle;
+}
+
+bool JobSystem::isComplete(JobHandle handle) const {
+    if (!handle.isValid()) return true;
+    return (_jobs[handle.index]._generation.load(std::memory_order_acquire) != handle.generation);
+}
+
+void JobSystem::wait(JobHandle handle) {
+    while (!isComplete(handle)) {
+        if (!runOne()) std::this_thread::yield();
+    }
+}
+
+void JobSystem::wait(JobCounter const & counter) {
+    while (!counter.isComplete()) {
+        if (!runOne()) std::this_thread::yield();
+    }
+}
+
+void JobSystem::release(JobCounter * counter) {
+    decrement(counter);
+}
+
+void JobSystem::parallelFor(uint32_t begin, uint32_t end, uint32_t grain, RangeFn const & fn) {
+    if (end <= begin) return;
+    if (grain == 0) grain = 1;
+
+    uint32_t firstEnd = (end - begin > grain) ? begin + grain : end;
+    // nothing to split
+    if (firstEnd == end || _nThreads <= 1) {
+        fn(begin, end);
+        return;
+    }
+
+    JobCounter counter;
+    for (uint32_t chunkBegin = firstEnd; chunkBegin < end; ) {
+        uint32_t chunkEnd = (end - chunkBegin > grain) ? chunkBegin + grain : end;
+        run([&fn, chunkBegin, chunkEnd]{ fn(chunkBegin, chunkEnd); }, &counter);
+        chunkBegin = chunkEnd;
+    }
+    fn(begin, firstEnd);
+    wait(counter);
+}
+
+JobCounter * JobSystem::createGroup() {
+    JobCounter * group = mm.memMan.create<JobCounter>(1u);
+    assert(group && "Could not create job group.");
+    group->_isGroup = true;
+    return group;
+}
+
+void JobSystem::closeGroup(JobCounter * group, Fn const & onComplete) {
+    group->_onComplete = onComplete;
+    release(group);
+}
+
+void JobSystem::runCompletedGroups() {
+    JobCounter * group;
+    {
+        std::lock_guard<std::mutex> lock{_completedMutex};
+        group = _completedGroups;
+        _completedGroups = nullptr;
+    }
+    while (group) {
+        JobCounter * next = group->_nextCompleted;
+        if (group->_onComplete) {
+            group->_onComplete();
+        }
+        group->~JobCounter();
+        mm.memMan.request({.ptr = group});
+        group = next;
+    }
+}
+
+// -------------------------------------------------------------------------- //
+// INTERNALS
+// -------------------------------------------------------------------------- //
+uint32_t JobSystem::claimJob() {
+    for (uint32_t tries = 0; tries < _jobCapacity; ++tries) {
+        uint32_t jobIndex = _nextJob.fetch_add(1, std::memory_order_relaxed) % _jobCapacity;
+        bool expected = false;
+        if (_jobs[jobIndex]._inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return jobIndex;
+        }
+    }
+    return JobHandle::Invalid;
+}
+
+void JobSystem::enqueue(uint32_t jobIndex) {
+    _nQueued.fetch_add(1);
+
+    int t = _threadIndex;
+    bool pushed = (t >= 0 && _deques[t].push(jobIndex));
+    if (!pushed) {
+        std::lock_guard<std::mutex> lock{_sharedMutex};
+        pushed = _deques[_nThreads].push(jobIndex);
+    }
+    // can't happen while deques hold every job, but just in case
+    if (!pushed) {
+        _nQueued.fetch_sub(1);
+        execute(jobIndex);
+        return;
+    }
+
+    if (_nSleeping.load() > 0) {
+        // take lock so a worker between checking _nQueued and sleeping
+        // doesn't miss the notify
+        { std::lock_guard<std::mutex> lock{_sleepMutex}; }
+        _wake.notify_one();
+    }
+}
+
+void JobSystem::execute(uint32_t jobIndex) {
+    Job & job = _jobs[jobIndex];
+    job._task();
+    job._task = nullptr;
+    JobCounter * counter = job._counter;
+    job._counter = nullptr;
+    job._nextWaiting = JobHandle::Invalid;
+    job._generation.fetch_add(1, std::memory_order_release);
+    job._inUse.store(false, std::memory_order_release);
+    decrement(counter);
+}
+
+void JobSystem::decrement(JobCounter * counter) {
+    if (counter == nullptr) return;
+    // read before counter can reach zero. groups outlive that, but not
+    // necessarily counters on the stack.
+    bool isGroup = counter->_isGroup;
+
+    uint64_t state = counter->_state.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        assert((uint32_t)state != 0 && "Job counter decremented below zero.");
+        next = ((uint32_t)state == 1) ?
+            ((uint64_t)JobHandle::Invalid << 32) :
+            state - 1;
+    } while (!counter->_state.compare_exchange_weak(state, next,
+        std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    if ((uint32_t)state != 1) return;
+
+    // reached zero. queue jobs that were waiting on it.
+    uint32_t jobIndex = (uint32_t)(state >> 32);
+    while (jobIndex != JobHandle::Invalid) {
+        uint32_t nextIndex = _jobs[jobIndex]._nextWaiting;
+        _jobs[jobIndex]._nextWaiting = JobHandle::Invalid;
+        enqueue(jobIndex);
+        jobIndex = nextIndex;
+    }
+
+    if (isGroup) {
+        std::lock_guard<std::mutex> lock{_completedMutex};
+        counter->_nextCompleted = _completedGroups;
+        _completedGroups = counter;
+    }
+}
+
+bool JobSystem::runOne() {
+    int t = _threadIndex;
+    uint32_t jobIndex = (t >= 0) ? _deques[t].pop() : JobHandle::Invalid;
+
+    // steal, starting from next thread over
+    int nDeques = _nThreads + 1;
+    int start = (t >= 0) ? t + 1 : 0;
+    for (int i = 0; i < nDeques && jobIndex == JobHandle::Invalid; ++i) {
+        int victim = (start + i) % nDeques;
+        if (victim == t) continue;
+        jobIndex = _deques[victim].steal();
+    }
+
+    if (jobIndex == JobHandle::Invalid) {
+        return false;
+    }
+    _nQueued.fetch_sub(1);
+    execute(jobIndex);
+    return true;
+}
+
+void JobSystem::workerLoop(int threadIndex) {
+    static constexpr int SpinCount = 64;
+
+    _threadIndex = threadIndex;
+    mm.memMan.attachThreadArena();
+
+    for (;;) {
+        bool ran = false;
+        for (int spin = 0; spin < SpinCount && !ran; ++spin) {
+            ran = runOne();
+            if (!ran) std::this_thread::yield();
+        }
+        if (ran) continue;
+
+        std::unique_lock<std::mutex> lock{_sleepMutex};
+        _nSleeping.fetch_add(1);
+        _wake.wait(lock, [this]{ return (_nQueued.load() > 0 || _quit); });
+        _nSleeping.fetch_sub(1);
+        if (_quit && _nQueued.load() <= 0) {
+            break;
+        }
+    }
+
+    mm.memMan.detachThreadArena();
+    _threadIndex = -1;
+}
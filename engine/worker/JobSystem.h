@@ -0,0 +1,183 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "../common/debug_defines.h"
+#include "../common/types.h"
+
+/*
+
+Fixed pool of worker threads, started once at init and sized to the hardware.
+
+Every pool thread (workers, and the main thread) owns a work-stealing deque of
+job indices. Jobs created on a pool thread are pushed to the bottom of its own
+deque and popped from there, newest first. Idle threads steal the oldest job
+from the top of any other deque. Jobs created on other threads go to a shared
+deque that is only ever stolen from. Workers sleep when there's nothing queued.
+
+Jobs live in a fixed pool of setup.jobCapacity slots. A JobHandle is a slot
+index plus the slot's generation at creation, so it reports complete after the
+slot has been reused. If every slot is taken, the job runs inline, unless it
+waits on a counter. Then the caller runs other jobs until a slot frees, so
+capacity must be more than the number of jobs waiting on counters at once.
+
+A JobCounter counts unfinished jobs. A job can add itself to one counter on
+creation, and can also wait for another counter to reach zero before it is
+queued.
+
+*/
+
+class JobHandle {
+public:
+    static constexpr uint32_t Invalid = UINT32_MAX;
+    uint32_t index = Invalid;
+    uint32_t generation = 0;
+    bool isValid() const { return (index != Invalid); }
+};
+
+class JobCounter {
+// TYPES
+public:
+    using Fn = std::function<void(void)>;
+
+// INTERFACE
+public:
+    // a counter used as a group starts at 1 (held by its creator), so it can't
+    // complete while jobs are still being added.
+    JobCounter(uint32_t count = 0) :
+        _state(count | ((uint64_t)JobHandle::Invalid << 32))
+    {
+    }
+    uint32_t count() const { return (uint32_t)_state.load(std::memory_order_acquire); }
+    bool isComplete() const { return (count() == 0); }
+    // only while no jobs count in, or wait on, this counter
+    void reset(uint32_t count) {
+        _state.store(count | ((uint64_t)JobHandle::Invalid << 32), std::memory_order_relaxed);
+    }
+
+// STORAGE
+private:
+    friend class JobSystem;
+    // count of unfinished jobs in low 32 bits, first job waiting for zero in
+    // high 32 (linked through Job::_nextWaiting). kept in one word so whoever
+    // takes count to zero takes the waiting list with it, and never touches
+    // the counter again (it may be on the stack of a thread in wait()).
+    std::atomic<uint64_t> _state;
+    // group only. run on main thread in JobSystem::runCompletedGroups.
+    Fn _onComplete = nullptr;
+    bool _isGroup = false;
+    JobCounter * _nextCompleted = nullptr;
+};
+
+class JobSystem {
+// TYPES AND STATICS
+public:
+    using Fn = std::function<void(void)>;
+    using RangeFn = std::function<void(uint32_t begin, uint32_t end)>;
+    static constexpr uint16_t MaxThreads = 64; // including main
+
+// INTERFACE
+public:
+    // queue task. counter (optional) is incremented now and decremented once
+    // task has run. task isn't queued until after (optional) reaches zero.
+    JobHandle run(Fn const & task, JobCounter * counter = nullptr, JobCounter * after = nullptr);
+    bool isComplete(JobHandle handle) const;
+    // run other jobs until complete
+    void wait(JobHandle handle);
+    void wait(JobCounter const & counter);
+    // decrement counter, like a job counted in it finishing. eg. to drop the
+    // hold of a counter constructed with a count.
+    void release(JobCounter * counter);
+
+    // call fn on chunks of [begin, end), grain items each (last may be less),
+    // spread across pool. chunks start at begin + a multiple of grain. calling
+    // thread takes part, and returns once all chunks are done.
+    void parallelFor(uint32_t begin, uint32_t end, uint32_t grain, RangeFn const & fn);
+
+    // groups are counters created here, that are released once complete.
+    // onComplete runs on main thread from runCompletedGroups().
+    JobCounter * createGroup();
+    // drops creator's hold on group. group must not be used by caller after.
+    void closeGroup(JobCounter * group, Fn const & onComplete);
+    // call on main thread (once per tick)
+    void runCompletedGroups();
+
+    uint16_t threadCount() const { return _nThreads; }
+    // calling thread's index: 0 main thread, workers from 1. -1 not in pool.
+    static int threadIndex() { return _threadIndex; }
+
+    #if DEV_INTERFACE
+    void editor();
+    #endif // DEV_INTERFACE
+
+// PRIVATE TYPES
+private:
+    class Job {
+    public:
+        Fn _task = nullptr;
+        JobCounter * _counter = nullptr;
+        uint32_t _nextWaiting = JobHandle::Invalid;
+        std::atomic<uint32_t> _generation{0};
+        std::atomic<bool> _inUse{false};
+    };
+
+    // Chase-Lev deque of job indices. Owner pushes/pops at bottom, any thread
+    // steals from top. Capacity is fixed at a power of 2 >= job capacity, so
+    // it can hold every job at once.
+    class Deque {
+    public:
+        void init(std::atomic<uint32_t> * buffer, uint32_t capacity);
+        bool push(uint32_t jobIndex);
+        uint32_t pop();
+        uint32_t steal();
+    private:
+        alignas(64) std::atomic<int64_t> _top{0};
+        alignas(64) std::atomic<int64_t> _bottom{0};
+        std::atomic<uint32_t> * _buffer = nullptr;
+        uint32_t _mask = 0;
+    };
+
+// INIT
+private:
+    friend class MrManager;
+    // call from main thread
+    void init(size_t nWorkers, size_t jobCapacity);
+    // waits for queued jobs, then joins workers
+    void shutdown();
+
+// STORAGE
+private:
+    uint16_t _nThreads = 0; // including main
+    uint32_t _jobCapacity = 0;
+    Job * _jobs = nullptr;
+    std::atomic<uint32_t> _nextJob{0};
+    // one per pool thread, plus shared at [_nThreads]
+    Deque * _deques = nullptr;
+    std::atomic<uint32_t> * _dequeBuffers = nullptr;
+    std::mutex _sharedMutex;
+    std::thread * _workers = nullptr;
+
+    // sleeping
+    std::atomic<int32_t> _nQueued{0};
+    std::atomic<int32_t> _nSleeping{0};
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    bool _quit = false;
+
+    // groups that reached zero, waiting for main thread
+    JobCounter * _completedGroups = nullptr;
+    std::mutex _completedMutex;
+
+    static thread_local int _threadIndex;
+
+// INTERNALS
+private:
+    uint32_t claimJob();
+    void enqueue(uint32_t jobIndex);
+    void execute(uint32_t jobIndex);
+    void decrement(JobCounter * counter);
+    bool runOne();
+    void workerLoop(int threadIndex);
+};
@@ -0,0 +1,164 @@
+#include "JobSystem.h"
+#include <chrono>
+#include "../common/imgui_bgfx_glfw/imgui_bgfx_glfw.h"
+#include "../MrManager.h"
+
+#if DEV_INTERFACE
+
+using namespace ImGui;
+
+// synthetic Gobj for the benchmark. nNodes in a 4-wide tree under one root,
+// each with a small translation and the same mesh of nVertices positions.
+static Gobj * createBenchmarkGobj(uint32_t nNodes, uint32_t nVertices) {
+    Gobj * g = mm.memMan.createGobj({
+        .allStrLen = 64,
+        .accessors = 1,
+        .buffers = 1,
+        .bufferViews = 1,
+        .meshes = 1,
+        .meshAttributes = 1,
+        .meshPrimitives = 1,
+        .nodes = (uint16_t)nNodes,
+        .nodeChildren = (uint16_t)nNodes,
+        .scenes = 1,
+        .rawDataLen = nVertices * (uint32_t)sizeof(float) * 3,
+    });
+    if (g == nullptr) {
+        return nullptr;
+    }
+
+    Gobj::Buffer * buffer = nullptr;
+    Gobj::Mesh * mesh = g->makeMesh({
+        .attributes = {Gobj::ATTR_POSITION},
+        .nAttributes = 1,
+        .nVertices = nVertices,
+        .name = "bench",
+    }, &buffer);
+    float * positions = (float *)buffer->data;
+    for (uint32_t i = 0; i < nVertices * 3; ++i) {
+        positions[i] = (float)((i * 2654435761u) % 2000) / 1000.f - 1.f;
+    }
+    Gobj::Accessor * accessor = mesh->primitives->attributes->accessor;
+    accessor->updateMinMax(false);
+
+    g->addScene("bench", true);
+    for (uint32_t parentIndex = 0; g->counts.nodes < nNodes; ++parentIndex) {
+        Gobj::Node * parent = g->nodes + parentIndex;
+        uint16_t nChildren = (uint16_t)((nNodes - g->counts.nodes < 4) ? nNodes - g->counts.nodes : 4);
+        parent->children = g->addNodeChildren(nChildren);
+        parent->nChildren = nChildren;
+    }
+    for (uint32_t nodeIndex = 0; nodeIndex < nNodes; ++nodeIndex) {
+        Gobj::Node * node = g->nodes + nodeIndex;
+        node->mesh = mesh;
+        (*node->matrix)[3] = glm::vec4{(float)(nodeIndex % 7) * .1f, (float)(nodeIndex % 5) * .1f, 0.f, 1.f};
+    }
+    return g;
+}
+
+/*
+Compares serial and parallel versions of per-frame Gobj work. Bounds are
+updated over synthetic scenes of 10k to 1M nodes. Gobj counts are 16-bit, so
+larger scenes are split over several Gobjs, as separate models would be.
+Min/max is found over a single accessor.
+*/
+void JobSystem::editor() {
+    if (!CollapsingHeader("Jobs")) {
+        return;
+    }
+
+    Text("%u threads (including main)", _nThreads);
+
+    static constexpr int NNodeCounts = 3;
+    static constexpr uint32_t NodeCounts[NNodeCounts] = {10000, 100000, 1000000};
+    static constexpr uint32_t NodesPerGobj = 50000;
+    static constexpr uint32_t MaxGobjs = NodeCounts[NNodeCounts-1] / NodesPerGobj;
+    static constexpr uint32_t MinMaxVertices = 1000000;
+    static constexpr int Iterations = 5;
+    // best milliseconds, [0] serial, [1] parallel
+    static double boundsMs[NNodeCounts][2] = {};
+    static double minMaxMs[2] = {};
+    static bool didRun = false;
+    static bool failed = false;
+
+    auto bestMs = [](auto const & fn) {
+        double best = 0.0;
+        for (int i = 0; i < Iterations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+            if (i == 0 || ms.count() < best) best = ms.count();
+        }
+        return best;
+    };
+
+    TextUnformatted("Parallel Benchmark:");
+    SameLine();
+    if (Button("Run##JobsBenchmark")) {
+        failed = false;
+        for (int n = 0; n < NNodeCounts && !failed; ++n) {
+            Gobj * gobjs[MaxGobjs] = {nullptr};
+            uint32_t nGobjs = 0;
+            for (uint32_t remaining = NodeCounts[n]; remaining; ++nGobjs) {
+                uint32_t nNodes = (remaining > NodesPerGobj) ? NodesPerGobj : remaining;
+                gobjs[nGobjs] = createBenchmarkGobj(nNodes, 64);
+                if (gobjs[nGobjs] == nullptr) {
+                    failed = true;
+                    break;
+                }
+                remaining -= nNodes;
+            }
+            if (!failed) {
+                for (int parallel = 0; parallel < 2; ++parallel) {
+                    boundsMs[n][parallel] = bestMs([&]{
+                        for (uint32_t i = 0; i < nGobjs; ++i) {
+                            gobjs[i]->updateBoundsForCurrentScene(parallel);
+                        }
+                    });
+                }
+            }
+            for (uint32_t i = 0; i < MaxGobjs; ++i) {
+                if (gobjs[i]) mm.memMan.request({.ptr = gobjs[i]});
+            }
+        }
+
+        Gobj * g = failed ? nullptr : createBenchmarkGobj(1, MinMaxVertices);
+        if (g) {
+            Gobj::Accessor * accessor = g->accessors;
+            for (int parallel = 0; parallel < 2; ++parallel) {
+                minMaxMs[parallel] = bestMs([&]{
+                    accessor->updateMinMax(parallel);
+                });
+            }
+            mm.memMan.request({.ptr = g});
+        }
+        else {
+            failed = true;
+        }
+        didRun = true;
+    }
+
+    if (failed) {
+        TextUnformatted("Not enough memory for benchmark Gobjs.");
+    }
+    else if (didRun) {
+        for (int n = 0; n < NNodeCounts; ++n) {
+            Text("bounds, %7u nodes: serial %8.3f ms, parallel %8.3f ms (%.1fx)",
+                NodeCounts[n],
+                boundsMs[n][0],
+                boundsMs[n][1],
+                boundsMs[n][0] / boundsMs[n][1]
+            );
+        }
+        Text("min/max, %u vertices: serial %8.3f ms, parallel %8.3f ms (%.1fx)",
+            MinMaxVertices,
+            minMaxMs[0],
+            minMaxMs[1],
+            minMaxMs[0] / minMaxMs[1]
+        );
+    }
+
+    Dummy(ImVec2(0.0f, 20.0f));
+}
+
+#endif // DEV_INTERFACE
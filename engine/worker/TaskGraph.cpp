@@ -0,0 +1,56 @@
+#include "TaskGraph.h"
+#include <stdio.h>
+#include <assert.h>
+
+uint16_t TaskGraph::add(Fn const & fn, std::initializer_list<uint16_t> predecessors) {
+    if (_nTasks >= MaxTasks) {
+        fprintf(stderr, "Could not add task. TaskGraph full.\n");
+        return InvalidTask;
+    }
+    uint16_t id = _nTasks;
+    for (uint16_t pred : predecessors) {
+        assert(pred < id && "Predecessor must be added first.");
+        Task & p = _tasks[pred];
+        if (p.nSuccessors >= MaxSuccessors) {
+            fprintf(stderr, "Could not add task. Task %u has too many successors.\n", pred);
+            return InvalidTask;
+        }
+    }
+
+    Task & task = _tasks[id];
+    task.fn = fn;
+    task.nPredecessors = 0;
+    task.nSuccessors = 0;
+    for (uint16_t pred : predecessors) {
+        Task & p = _tasks[pred];
+        p.successors[p.nSuccessors++] = id;
+        ++task.nPredecessors;
+    }
+    ++_nTasks;
+    return id;
+}
+
+void TaskGraph::run(JobSystem & jobs) {
+    for (uint16_t i = 0; i < _nTasks; ++i) {
+        _tasks[i].gate.reset(_tasks[i].nPredecessors);
+    }
+
+    JobCounter all;
+    for (uint16_t i = 0; i < _nTasks; ++i) {
+        jobs.run([this, &jobs, i]{
+            Task & task = _tasks[i];
+            task.fn();
+            for (uint16_t s = 0; s < task.nSuccessors; ++s) {
+                jobs.release(&_tasks[task.successors[s]].gate);
+            }
+        }, &all, &_tasks[i].gate);
+    }
+    jobs.wait(all);
+}
+
+void TaskGraph::clear() {
+    for (uint16_t i = 0; i < _nTasks; ++i) {
+        _tasks[i].fn = nullptr;
+    }
+    _nTasks = 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <initializer_list>
+#include "JobSystem.h"
+
+/*
+
+Small, reusable graph of tasks, run on the job system.
+
+Add tasks with the ids of tasks that must finish first (ids are returned by
+add, so predecessors are always added earlier, and the graph can't have
+cycles). run() queues every task on the pool, each waiting on a counter of its
+unfinished predecessors, and returns when all are done. A graph can be built
+once and run every frame.
+
+Example:
+    TaskGraph graph;
+    uint16_t anim   = graph.add([]{ ... });
+    uint16_t xforms = graph.add([]{ ... }, {anim});
+    uint16_t bounds = graph.add([]{ ... }, {xforms});
+    uint16_t audio  = graph.add([]{ ... });
+    graph.add([]{ ... }, {bounds, audio});
+    mm.runTaskGraph(graph);
+
+*/
+
+class TaskGraph {
+// TYPES AND STATICS
+public:
+    using Fn = JobSystem::Fn;
+    static constexpr uint16_t MaxTasks = 64;
+    static constexpr uint16_t MaxSuccessors = 16;
+    static constexpr uint16_t InvalidTask = UINT16_MAX;
+
+// INTERFACE
+public:
+    // returns task id, or InvalidTask if graph is full
+    uint16_t add(Fn const & fn, std::initializer_list<uint16_t> predecessors = {});
+    // blocks until every task has run. calling thread takes part.
+    void run(JobSystem & jobs);
+    uint16_t taskCount() const { return _nTasks; }
+    void clear();
+
+// PRIVATE TYPES
+private:
+    class Task {
+    public:
+        Fn fn = nullptr;
+        uint16_t nPredecessors = 0;
+        uint16_t nSuccessors = 0;
+        uint16_t successors[MaxSuccessors];
+        // unfinished predecessors, while running
+        JobCounter gate;
+    };
+
+// STORAGE
+private:
+    Task _tasks[MaxTasks];
+    uint16_t _nTasks = 0;
+};